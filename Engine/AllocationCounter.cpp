@@ -0,0 +1,80 @@
+#include "AllocationCounter.h"
+#include "Profiler.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<uint64_t> allocations{ 0u };
+}
+
+uint64_t AllocationCounter::GetCount()
+{
+	return allocations.load(std::memory_order_relaxed);
+}
+
+#if CHILI_PROFILER
+namespace
+{
+	void* CountedAlloc(std::size_t size)
+	{
+		allocations.fetch_add(1u, std::memory_order_relaxed);
+		return std::malloc(size ? size : 1u);
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	if (void* p = CountedAlloc(size))
+	{
+		return p;
+	}
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAlloc(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAlloc(size);
+}
+
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+	std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+	std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+	std::free(p);
+}
+#endif
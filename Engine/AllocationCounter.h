@@ -0,0 +1,10 @@
+#pragma once
+#include <cstdint>
+
+// Counts heap allocations made through the global operator new. The counting
+// operators are only compiled in together with the profiler (CHILI_PROFILER).
+class AllocationCounter
+{
+public:
+	static uint64_t GetCount();
+};
@@ -0,0 +1,411 @@
+#include "Arena.h"
+#include <algorithm>
+#include <stdexcept>
+
+constexpr int Arena::Empty;
+
+Arena::Arena(const ArenaSettings& settings)
+	:
+	level(settings.level),
+	width(settings.level ? settings.level->GetWidth() : settings.width),
+	height(settings.level ? settings.level->GetHeight() : settings.height),
+	layout(width, height, settings.order),
+	nFood(settings.food),
+	bodies(settings.snakes),
+	foodCell(settings.food < 0 ? 0 : settings.food)
+{
+	const size_t cells = size_t(width) * height;
+	if (width < 1 || height < 1 || settings.snakes < 0 || nFood < 0 || size_t(settings.snakes) + nFood > cells / 2)
+	{
+		throw std::runtime_error("Arena needs a board at least twice as large as its snakes and food");
+	}
+	occupant.resize(layout.GetCellCount());
+	foodSlot.resize(layout.GetCellCount());
+	claimStep.resize(layout.GetCellCount());
+	claimBy.resize(layout.GetCellCount());
+	next.resize(bodies.size());
+	grows.resize(bodies.size());
+	dies.resize(bodies.size());
+	Reset(1u);
+}
+
+void Arena::Reset(uint64_t seed)
+{
+	rng.Seed(seed);
+	tick = 0;
+	std::fill(occupant.begin(), occupant.end(), Empty);
+	std::fill(foodSlot.begin(), foodSlot.end(), Empty);
+	std::fill(foodCell.begin(), foodCell.end(), Empty);
+	std::fill(claimStep.begin(), claimStep.end(), 0);
+	stepCount = 0;
+	for (Body& body : bodies)
+	{
+		const int snake = int(&body - bodies.data());
+		body.ring.assign(4, 0);
+		body.head = 0;
+		body.length = 0;
+		body.alive = true;
+		int cell;
+		if (level && snake < level->GetSpawnCount() &&
+			occupant[layout.Index({ level->GetSpawn(snake).x,level->GetSpawn(snake).y })] == Empty)
+		{
+			const Level::Spawn& spawn = level->GetSpawn(snake);
+			body.dir = Direction(spawn.dir);
+			cell = layout.Index({ spawn.x,spawn.y });
+		}
+		else
+		{
+			body.dir = Direction(rng.Range(0, DirectionCount - 1));
+			cell = RandomFreeCell(width * height, false);
+		}
+		PushHead(body, cell);
+		body.at = layout.ToLocation(cell);
+		occupant[cell] = snake;
+	}
+	aliveCount = int(bodies.size());
+	pendingFood.clear();
+	for (int slot = 0; slot < nFood; ++slot)
+	{
+		if (!PlaceFood(slot))
+		{
+			pendingFood.push_back(slot);
+		}
+	}
+}
+
+void Arena::Step(const Direction* inputs)
+{
+	++tick;
+	++stepCount;
+	const int nSnakes = int(bodies.size());
+
+	// where every head goes and whether it eats there
+	for (int i = 0; i < nSnakes; ++i)
+	{
+		Body& body = bodies[i];
+		if (!body.alive)
+		{
+			continue;
+		}
+		if (inputs[i] != Opposite(body.dir))
+		{
+			body.dir = inputs[i];
+		}
+		// a wall is as deadly as the edge of the board; short of both, the
+		// layout steps to the next cell without going through its square
+		const Location to = body.at.Add(ToDelta(body.dir));
+		next[i] = !IsInside(to) || (level && level->IsWall(to)) ? Empty : layout.Neighbour(body.ring[body.head], body.dir);
+		grows[i] = next[i] != Empty && foodSlot[next[i]] != Empty;
+		dies[i] = next[i] == Empty;
+	}
+
+	// every verdict below reads the board from before the step, so the order of the snakes does not matter
+	for (int i = 0; i < nSnakes; ++i)
+	{
+		if (!bodies[i].alive || next[i] == Empty)
+		{
+			continue;
+		}
+		const int cell = next[i];
+		if (claimStep[cell] == stepCount)
+		{
+			dies[i] = 1;
+			dies[claimBy[cell]] = 1;
+		}
+		else
+		{
+			claimStep[cell] = stepCount;
+			claimBy[cell] = i;
+		}
+		const int other = occupant[cell];
+		if (other == Empty)
+		{
+			continue;
+		}
+		const Body& body = bodies[other];
+		if (cell != GetTail(body) || grows[other])
+		{
+			dies[i] = 1;
+		}
+		else if (cell == body.ring[body.head] && next[other] == bodies[i].ring[bodies[i].head] && other != i)
+		{
+			// two heads, each the other's vacating tail, would pass through each
+			// other; a longer snake moving into the cell i leaves is just a rotation
+			dies[i] = 1;
+			dies[other] = 1;
+		}
+	}
+
+	// the dead leave first and the tails move off, so the heads find their cells free
+	for (int i = 0; i < nSnakes; ++i)
+	{
+		Body& body = bodies[i];
+		if (!body.alive)
+		{
+			continue;
+		}
+		if (dies[i])
+		{
+			for (int s = 0; s < body.length; ++s)
+			{
+				occupant[body.ring[(body.head - s) & (int(body.ring.size()) - 1)]] = Empty;
+			}
+			body.alive = false;
+			--aliveCount;
+		}
+		else if (!grows[i])
+		{
+			occupant[GetTail(body)] = Empty;
+			--body.length;
+		}
+	}
+	for (int i = 0; i < nSnakes; ++i)
+	{
+		Body& body = bodies[i];
+		if (!body.alive)
+		{
+			continue;
+		}
+		const int cell = next[i];
+		PushHead(body, cell);
+		body.at = body.at.Add(ToDelta(body.dir));
+		occupant[cell] = i;
+		if (grows[i])
+		{
+			pendingFood.push_back(foodSlot[cell]);
+			foodCell[foodSlot[cell]] = Empty;
+			foodSlot[cell] = Empty;
+		}
+	}
+
+	// slot order keeps the respawns deterministic
+	std::sort(pendingFood.begin(), pendingFood.end());
+	size_t waiting = 0;
+	for (const int slot : pendingFood)
+	{
+		if (!PlaceFood(slot))
+		{
+			pendingFood[waiting++] = slot;
+		}
+	}
+	pendingFood.resize(waiting);
+}
+
+int Arena::GetWidth() const
+{
+	return width;
+}
+
+int Arena::GetHeight() const
+{
+	return height;
+}
+
+int Arena::GetSnakeCount() const
+{
+	return int(bodies.size());
+}
+
+int Arena::GetAliveCount() const
+{
+	return aliveCount;
+}
+
+int Arena::GetTick() const
+{
+	return tick;
+}
+
+bool Arena::IsAlive(int snake) const
+{
+	return bodies[snake].alive;
+}
+
+int Arena::GetLength(int snake) const
+{
+	return bodies[snake].length;
+}
+
+Location Arena::GetSegment(int snake, int index) const
+{
+	const Body& body = bodies[snake];
+	return layout.ToLocation(body.ring[(body.head - index) & (int(body.ring.size()) - 1)]);
+}
+
+Direction Arena::GetDirection(int snake) const
+{
+	return bodies[snake].dir;
+}
+
+int Arena::GetOccupant(Location loc) const
+{
+	const int cell = GetCell(loc);
+	return cell == Empty ? Empty : occupant[cell];
+}
+
+bool Arena::HasFood(Location loc) const
+{
+	const int cell = GetCell(loc);
+	return cell != Empty && foodSlot[cell] != Empty;
+}
+
+int Arena::GetFoodCount() const
+{
+	return nFood;
+}
+
+bool Arena::GetFood(int slot, Location& loc) const
+{
+	const int cell = foodCell[slot];
+	if (cell == Empty)
+	{
+		return false;
+	}
+	loc = layout.ToLocation(cell);
+	return true;
+}
+
+uint32_t Arena::GetHash() const
+{
+	uint32_t hash = 2166136261u;
+	const auto mix = [&hash](uint32_t value)
+	{
+		for (int b = 0; b < 4; ++b)
+		{
+			hash = (hash ^ ((value >> (8 * b)) & 0xFF)) * 16777619u;
+		}
+	};
+	mix(uint32_t(tick));
+	for (const Body& body : bodies)
+	{
+		mix(body.alive ? uint32_t(body.length) : 0u);
+		mix(uint32_t(body.dir));
+		for (int s = 0; body.alive && s < body.length; ++s)
+		{
+			mix(uint32_t(GetRowMajor(body.ring[(body.head - s) & (int(body.ring.size()) - 1)])));
+		}
+	}
+	for (const int cell : foodCell)
+	{
+		mix(uint32_t(cell == Empty ? Empty : GetRowMajor(cell)));
+	}
+	return hash;
+}
+
+void Arena::Save(Snapshot& snapshot) const
+{
+	snapshot.bodies = bodies;
+	snapshot.occupant = occupant;
+	snapshot.foodSlot = foodSlot;
+	snapshot.foodCell = foodCell;
+	snapshot.pendingFood = pendingFood;
+	snapshot.rng = rng;
+	snapshot.tick = tick;
+	snapshot.aliveCount = aliveCount;
+}
+
+void Arena::Load(const Snapshot& snapshot)
+{
+	if (snapshot.occupant.size() != occupant.size() || snapshot.bodies.size() != bodies.size())
+	{
+		throw std::runtime_error("Arena snapshot is of a different arena");
+	}
+	bodies = snapshot.bodies;
+	occupant = snapshot.occupant;
+	foodSlot = snapshot.foodSlot;
+	foodCell = snapshot.foodCell;
+	pendingFood = snapshot.pendingFood;
+	rng = snapshot.rng;
+	tick = snapshot.tick;
+	aliveCount = snapshot.aliveCount;
+}
+
+bool Arena::IsInside(Location loc) const
+{
+	return loc.x >= 0 && loc.y >= 0 && loc.x < width && loc.y < height;
+}
+
+bool Arena::IsWall(Location loc) const
+{
+	return level && level->IsWall(loc);
+}
+
+int Arena::GetCell(Location loc) const
+{
+	return IsInside(loc) ? layout.Index(loc) : Empty;
+}
+
+int Arena::GetRowMajor(int cell) const
+{
+	const Location loc = layout.ToLocation(cell);
+	return loc.y * width + loc.x;
+}
+
+int Arena::GetTail(const Body& body) const
+{
+	return body.ring[(body.head - body.length + 1) & (int(body.ring.size()) - 1)];
+}
+
+void Arena::PushHead(Body& body, int cell)
+{
+	const int capacity = int(body.ring.size());
+	if (body.length == capacity)
+	{
+		// unroll the ring into twice the room, tail first
+		std::vector<int> grown(size_t(capacity) * 2);
+		for (int s = 0; s < body.length; ++s)
+		{
+			grown[s] = body.ring[(body.head - body.length + 1 + s) & (capacity - 1)];
+		}
+		body.ring.swap(grown);
+		body.head = body.length - 1;
+	}
+	body.head = (body.head + 1) & (int(body.ring.size()) - 1);
+	body.ring[body.head] = cell;
+	++body.length;
+}
+
+bool Arena::PlaceFood(int slot)
+{
+	const int cell = RandomFreeCell(FoodTries, true);
+	if (cell == Empty)
+	{
+		return false;
+	}
+	foodSlot[cell] = slot;
+	foodCell[slot] = cell;
+	return true;
+}
+
+int Arena::RandomFreeCell(int tries, bool forFood)
+{
+	for (int t = 0; t < tries; ++t)
+	{
+		int cell;
+		if (level)
+		{
+			const Location loc = forFood ? level->RandomFoodCell(rng) :
+				Location{ rng.Range(0, width - 1),rng.Range(0, height - 1) };
+			if (level->IsWall(loc))
+			{
+				continue;
+			}
+			cell = layout.Index(loc);
+		}
+		else
+		{
+			// drawn in row major order, so every layout draws the same cells
+			const int n = rng.Range(0, width * height - 1);
+			cell = layout.Index({ n % width,n / width });
+		}
+		if (occupant[cell] == Empty && foodSlot[cell] == Empty)
+		{
+			return cell;
+		}
+	}
+	if (tries >= width * height)
+	{
+		throw std::runtime_error("Arena found no free cell to spawn a snake on");
+	}
+	return Empty;
+}
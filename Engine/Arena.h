@@ -0,0 +1,136 @@
+#pragma once
+#include "CellLayout.h"
+#include "Direction.h"
+#include "Level.h"
+#include "Location.h"
+#include "Rng.h"
+#include <cstdint>
+#include <vector>
+
+struct ArenaSettings
+{
+	int width = 256;
+	int height = 256;
+	int snakes = 200;
+	// food items on the board at any time; an eaten one reappears elsewhere
+	int food = 400;
+	// walls, spawn points and food regions; the board then takes the level's
+	// size. Snakes without a spawn point of their own start on random cells
+	const Level* level = nullptr;
+	// how the per cell arrays are laid out; games play out the same either way
+	CellLayout::Order order = CellLayout::Order::RowMajor;
+};
+
+// Many snakes on one board, for battle royale games. Every snake moves once per
+// Step, all at the same time. One occupancy grid holds which snake is on each
+// cell, so a collision test is a single lookup, and a body is a ring of cell
+// indices, so a move touches the new head and the old tail only. A step costs
+// O(snakes) plus the bodies of the snakes that die in it, which is every
+// cell at most once per game.
+// Collisions are judged against the board as it is after the move, all snakes
+// at once, so the outcome does not depend on the order of the snakes:
+// - two or more heads entering the same cell all die, as do two heads swapping cells
+// - a head entering any body cell dies, own body included; a tail moving away
+//   this step has left its cell, unless its snake eats and grows
+// - a head leaving the board or entering a wall of the level dies
+// Dead snakes leave the board at once. Eaten food respawns on a random free
+// cell, within the level's food regions if there is a level.
+class Arena
+{
+public:
+	class Snapshot;
+public:
+	Arena(const ArenaSettings& settings = ArenaSettings());
+	void Reset(uint64_t seed);
+	// one move for every living snake; inputs holds a direction per snake, turns
+	// back into the body are ignored like Snake::Steer does, dead snakes' are unused
+	void Step(const Direction* inputs);
+	int GetWidth() const;
+	int GetHeight() const;
+	int GetSnakeCount() const;
+	int GetAliveCount() const;
+	int GetTick() const;
+	bool IsAlive(int snake) const;
+	int GetLength(int snake) const;
+	// index 0 is the head
+	Location GetSegment(int snake, int index) const;
+	Direction GetDirection(int snake) const;
+	// the snake on the cell or -1; outside the board counts as -1 too
+	int GetOccupant(Location loc) const;
+	bool HasFood(Location loc) const;
+	int GetFoodCount() const;
+	// false while the food slot waits for a free cell
+	bool GetFood(int slot, Location& loc) const;
+	bool IsInside(Location loc) const;
+	bool IsWall(Location loc) const;
+	// FNV-1a over the tick, the snakes and the food; equal on every machine that played the same inputs
+	uint32_t GetHash() const;
+	// saving into a snapshot that held an arena of the same size reuses its memory
+	void Save(Snapshot& snapshot) const;
+	void Load(const Snapshot& snapshot);
+private:
+	struct Body
+	{
+		// cell indices in the layout, capacity a power of two, head at ring[head]
+		std::vector<int> ring;
+		int head = 0;
+		int length = 0;
+		// the head's square, so a step tests the edge without decoding its cell index
+		Location at;
+		Direction dir = Direction::Right;
+		bool alive = false;
+	};
+	static constexpr int Empty = -1;
+	// random cells tried for an eaten food before it waits for the next step
+	static constexpr int FoodTries = 8;
+private:
+	int GetCell(Location loc) const;
+	// the cell's number in row major order, the same for every layout
+	int GetRowMajor(int cell) const;
+	int GetTail(const Body& body) const;
+	void PushHead(Body& body, int cell);
+	bool PlaceFood(int slot);
+	// a cell with no snake, food or wall on it, or Empty after tries misses
+	int RandomFreeCell(int tries, bool forFood);
+private:
+	const Level* level;
+	int width;
+	int height;
+	CellLayout layout;
+	int nFood;
+	std::vector<Body> bodies;
+	// per cell: the snake on it or Empty, and the food slot on it or Empty
+	std::vector<int> occupant;
+	std::vector<int> foodSlot;
+	// per food slot: its cell or Empty
+	std::vector<int> foodCell;
+	// per cell: the last step a head moved in and which snake that was; steps
+	// are counted apart from the tick, which repeats after a Load
+	std::vector<int> claimStep;
+	std::vector<int> claimBy;
+	int stepCount = 0;
+	// per snake, rebuilt every step
+	std::vector<int> next;
+	std::vector<uint8_t> grows;
+	std::vector<uint8_t> dies;
+	// food slots waiting for a free cell
+	std::vector<int> pendingFood;
+	Rng rng;
+	int tick = 0;
+	int aliveCount = 0;
+};
+
+// What Step changes, without the per step scratch data
+class Arena::Snapshot
+{
+private:
+	friend class Arena;
+	std::vector<Body> bodies;
+	std::vector<int> occupant;
+	std::vector<int> foodSlot;
+	std::vector<int> foodCell;
+	std::vector<int> pendingFood;
+	Rng rng;
+	int tick = 0;
+	int aliveCount = 0;
+};
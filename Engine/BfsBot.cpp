@@ -0,0 +1,162 @@
+#include "BfsBot.h"
+#include <algorithm>
+
+BfsBot::BfsBot(const Board& brd)
+	:
+	field(brd.GetWidth(), brd.GetHeight(), brd.IsWrapping()),
+	occupancy(size_t(brd.GetWidth()) * brd.GetHeight()),
+	open(brd.GetWidth(), brd.GetHeight()),
+	reached(brd.GetWidth(), brd.GetHeight())
+{
+	for (int y = 0; y < brd.GetHeight(); ++y)
+	{
+		for (int x = 0; x < brd.GetWidth(); ++x)
+		{
+			if (brd.IsWall({ x,y }))
+			{
+				walls.push_back({ x,y });
+			}
+		}
+	}
+}
+
+Direction BfsBot::Decide(const GameState& state, const Board& brd)
+{
+	const Snake& snake = state.snake;
+	Sync(snake, state.food.GetLocation(), brd);
+
+	const Location head = snake.GetSegment(0);
+	const Location tail = snake.GetSegment(snake.GetLength() - 1);
+	const Direction current = ToDirection(snake.GetDirection());
+	Direction best = current;
+	bool found = false;
+	bool bestRoomy = false;
+	int bestRoom = 0;
+	int bestDist = DistanceField::Unreachable;
+	// straight on first, so it wins ties
+	for (int i = 0; i < DirectionCount; ++i)
+	{
+		const Direction dir = Direction((int(current) + i) % DirectionCount);
+		// Snake::Steer never reverses, not even a snake of length one
+		if (dir == Opposite(current))
+		{
+			continue;
+		}
+		const Location next = brd.Wrap(head.Add(ToDelta(dir)));
+		// the tail moves out of the way on the same move, unless it is doubled up after growing
+		const bool safe = !brd.isOutsideBoard(next) &&
+			(!field.IsBlocked(next) || (next == tail && occupancy[next.y * field.GetWidth() + next.x] == 1));
+		if (!safe)
+		{
+			continue;
+		}
+		// a region smaller than the snake is a trap, however close the food
+		const int room = reached.FloodFill(open, next, field.IsWrapping());
+		const bool roomy = room >= snake.GetLength();
+		const int dist = field.GetDistance(next);
+		bool better;
+		if (!found || roomy != bestRoomy)
+		{
+			better = !found || roomy;
+		}
+		else if (!roomy && room != bestRoom)
+		{
+			better = room > bestRoom;
+		}
+		else
+		{
+			better = dist < bestDist;
+		}
+		if (better)
+		{
+			best = dir;
+			found = true;
+			bestRoomy = roomy;
+			bestRoom = room;
+			bestDist = dist;
+		}
+	}
+	return best;
+}
+
+const char* BfsBot::GetName() const
+{
+	return "bfs";
+}
+
+const DistanceField& BfsBot::GetField() const
+{
+	return field;
+}
+
+void BfsBot::Sync(const Snake& snake, Location food, const Board& brd)
+{
+	const int length = snake.GetLength();
+	const Location head = snake.GetSegment(0);
+	if (!synced || !field.HasTarget() || !(field.GetTarget() == food))
+	{
+		Resync(snake, food);
+		return;
+	}
+	if (head == lastHead && length == lastLength)
+	{
+		return;
+	}
+	// exactly one move since the last call, maybe followed or preceded by growing one segment
+	const Location behindHead = length > 1 ? snake.GetSegment(1) : lastHead;
+	const bool oneMove = behindHead == lastHead && brd.GetDistance(head, lastHead) == 1;
+	if (!oneMove || (length != lastLength && length != lastLength + 1))
+	{
+		Resync(snake, food);
+		return;
+	}
+
+	const Location tail = snake.GetSegment(length - 1);
+	Occupy(head);
+	if (length != lastLength)
+	{
+		Occupy(tail);
+	}
+	Vacate(lastTail);
+	lastHead = head;
+	lastTail = tail;
+	lastLength = length;
+}
+
+void BfsBot::Resync(const Snake& snake, Location food)
+{
+	field.Clear();
+	open.Fill();
+	std::fill(occupancy.begin(), occupancy.end(), 0);
+	for (const Location wall : walls)
+	{
+		Occupy(wall);
+	}
+	for (int i = 0; i < snake.GetLength(); ++i)
+	{
+		Occupy(snake.GetSegment(i));
+	}
+	field.Rebuild(food);
+	synced = true;
+	lastHead = snake.GetSegment(0);
+	lastTail = snake.GetSegment(snake.GetLength() - 1);
+	lastLength = snake.GetLength();
+}
+
+void BfsBot::Occupy(Location loc)
+{
+	if (++occupancy[loc.y * field.GetWidth() + loc.x] == 1)
+	{
+		field.Block(loc);
+		open.Reset(loc);
+	}
+}
+
+void BfsBot::Vacate(Location loc)
+{
+	if (--occupancy[loc.y * field.GetWidth() + loc.x] == 0)
+	{
+		field.Unblock(loc);
+		open.Set(loc);
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "Bitboard.h"
+#include "Bot.h"
+#include "DistanceField.h"
+#include <vector>
+
+// Follows the shortest path to the food around the snake's body, avoiding
+// moves into a region too small to hold the snake. The distance field towards
+// the food is carried over from one move to the next: each move only blocks
+// the new head cell and frees the old tail cell. It is rebuilt in full when
+// the food moves or the snake does not match the last move seen.
+class BfsBot : public Bot
+{
+public:
+	BfsBot(const Board& brd);
+	Direction Decide(const GameState& state, const Board& brd) override;
+	const char* GetName() const override;
+	const DistanceField& GetField() const;
+private:
+	void Sync(const Snake& snake, Location food, const Board& brd);
+	void Resync(const Snake& snake, Location food);
+	void Occupy(Location loc);
+	void Vacate(Location loc);
+private:
+	DistanceField field;
+	// body segments on each cell; segments overlap right after the snake grows
+	std::vector<int> occupancy;
+	// cells free of the body, for measuring the room behind each move
+	Bitboard open;
+	Bitboard reached;
+	// blocked for good, never part of the body
+	std::vector<Location> walls;
+	bool synced = false;
+	Location lastHead;
+	Location lastTail;
+	int lastLength = 0;
+};
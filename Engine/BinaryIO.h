@@ -0,0 +1,17 @@
+#pragma once
+#include <istream>
+#include <ostream>
+
+template<typename T>
+void WriteRaw(std::ostream& out, const T& value)
+{
+	out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+T ReadRaw(std::istream& in)
+{
+	T value = {};
+	in.read(reinterpret_cast<char*>(&value), sizeof(T));
+	return value;
+}
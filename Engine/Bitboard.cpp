@@ -0,0 +1,253 @@
+#include "Bitboard.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <emmintrin.h>
+
+namespace
+{
+	// spreads seed along the runs of open bits it touches, in both directions,
+	// in each 64-bit lane
+	inline __m128i Spread(__m128i seed, __m128i open)
+	{
+		// towards higher bits: the carry of open + seed ripples from each seed
+		// bit to the top of its run
+		const __m128i up = _mm_and_si128(_mm_or_si128(_mm_xor_si128(_mm_add_epi64(open, seed), open), seed), open);
+		// towards lower bits: occluded fill in doubling steps
+		__m128i gen = seed;
+		__m128i pro = open;
+		gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_srli_epi64(gen, 1)));
+		pro = _mm_and_si128(pro, _mm_srli_epi64(pro, 1));
+		gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_srli_epi64(gen, 2)));
+		pro = _mm_and_si128(pro, _mm_srli_epi64(pro, 2));
+		gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_srli_epi64(gen, 4)));
+		pro = _mm_and_si128(pro, _mm_srli_epi64(pro, 4));
+		gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_srli_epi64(gen, 8)));
+		pro = _mm_and_si128(pro, _mm_srli_epi64(pro, 8));
+		gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_srli_epi64(gen, 16)));
+		pro = _mm_and_si128(pro, _mm_srli_epi64(pro, 16));
+		gen = _mm_or_si128(gen, _mm_and_si128(pro, _mm_srli_epi64(gen, 32)));
+		return _mm_or_si128(up, gen);
+	}
+
+	// a word from each half of the board
+	inline __m128i LoadLanes(const uint64_t* p, ptrdiff_t laneOffset)
+	{
+		return _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)),
+			_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p + laneOffset)));
+	}
+
+	inline void StoreLanes(uint64_t* p, ptrdiff_t laneOffset, __m128i v)
+	{
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(p), v);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(p + laneOffset), _mm_unpackhi_epi64(v, v));
+	}
+
+	inline int PopCount(uint64_t v)
+	{
+		v = v - ((v >> 1) & 0x5555555555555555ull);
+		v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+		v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+		return int((v * 0x0101010101010101ull) >> 56);
+	}
+}
+
+Bitboard::Bitboard(int width, int height)
+	:
+	width(width),
+	height(height),
+	wordsPerRow((width + 63) / 64),
+	stride((width + 63) / 64 + 2),
+	words(size_t((width + 63) / 64 + 2) * (height + 3))
+{
+	assert(width > 0 && height > 0);
+}
+
+int Bitboard::GetWidth() const
+{
+	return width;
+}
+
+int Bitboard::GetHeight() const
+{
+	return height;
+}
+
+void Bitboard::Clear()
+{
+	std::fill(words.begin(), words.end(), 0u);
+}
+
+void Bitboard::Fill()
+{
+	Clear();
+	for (int y = 0; y < height; ++y)
+	{
+		uint64_t* const row = &words[(y + 1) * stride + 1];
+		std::fill_n(row, wordsPerRow, ~uint64_t(0));
+		if (width % 64 != 0)
+		{
+			row[wordsPerRow - 1] = (uint64_t(1) << (width % 64)) - 1u;
+		}
+	}
+}
+
+void Bitboard::Set(Location loc)
+{
+	assert(loc.x >= 0 && loc.y >= 0 && loc.x < width && loc.y < height);
+	words[Index(loc)] |= uint64_t(1) << (loc.x & 63);
+}
+
+void Bitboard::Reset(Location loc)
+{
+	assert(loc.x >= 0 && loc.y >= 0 && loc.x < width && loc.y < height);
+	words[Index(loc)] &= ~(uint64_t(1) << (loc.x & 63));
+}
+
+bool Bitboard::Test(Location loc) const
+{
+	if (loc.x < 0 || loc.y < 0 || loc.x >= width || loc.y >= height)
+	{
+		return false;
+	}
+	return (words[Index(loc)] >> (loc.x & 63)) & 1u;
+}
+
+int Bitboard::Count() const
+{
+	int count = 0;
+	for (int y = 0; y < height; ++y)
+	{
+		const uint64_t* const row = &words[(y + 1) * stride + 1];
+		for (int w = 0; w < wordsPerRow; ++w)
+		{
+			count += PopCount(row[w]);
+		}
+	}
+	return count;
+}
+
+int Bitboard::FloodFill(const Bitboard& open, Location start, bool wrap)
+{
+	assert(open.width == width && open.height == height);
+	Clear();
+	Set(start);
+	// alternating directions, so a path bending back on itself costs one sweep
+	// per bend; a sweep that adds nothing means every cell is final, unless it
+	// can still go on round the edges
+	bool inward = true;
+	bool changed = true;
+	while (changed)
+	{
+		changed = Sweep(open, inward);
+		changed = (wrap && WrapEdges(open)) || changed;
+		inward = !inward;
+	}
+	return Count();
+}
+
+bool Bitboard::WrapEdges(const Bitboard& open)
+{
+	// only the edge cells themselves, the next sweep spreads them from there
+	uint64_t added = 0u;
+	const int lastWord = (width - 1) >> 6;
+	const int lastBit = (width - 1) & 63;
+	for (int y = 0; y < height; ++y)
+	{
+		uint64_t* const row = &words[(y + 1) * stride + 1];
+		const uint64_t* const openRow = &open.words[(y + 1) * stride + 1];
+		const uint64_t toFirst = (row[lastWord] >> lastBit) & openRow[0] & ~row[0] & 1u;
+		const uint64_t toLast = (row[0] & 1u) & (openRow[lastWord] >> lastBit) & ~(row[lastWord] >> lastBit);
+		row[0] |= toFirst;
+		row[lastWord] |= (toLast & 1u) << lastBit;
+		added |= toFirst | toLast;
+	}
+	uint64_t* const top = &words[stride + 1];
+	uint64_t* const bottom = &words[height * stride + 1];
+	const uint64_t* const openTop = &open.words[stride + 1];
+	const uint64_t* const openBottom = &open.words[height * stride + 1];
+	for (int w = 0; w < wordsPerRow; ++w)
+	{
+		const uint64_t toTop = bottom[w] & openTop[w] & ~top[w];
+		const uint64_t toBottom = top[w] & openBottom[w] & ~bottom[w];
+		top[w] |= toTop;
+		bottom[w] |= toBottom;
+		added |= toTop | toBottom;
+	}
+	return added != 0u;
+}
+
+int Bitboard::Index(Location loc) const
+{
+	return (loc.y + 1) * stride + 1 + (loc.x >> 6);
+}
+
+bool Bitboard::Sweep(const Bitboard& open, bool inward)
+{
+	// The two halves of the board are swept side by side, one in each SIMD
+	// lane, so there are two independent chains of work instead of one long
+	// one. Both lanes run towards the middle row or both away from it, so what
+	// one half reaches at the end of a sweep crosses into the other half at the
+	// start of the next. Within a half, rows and words already visited in this
+	// sweep are read back straight away, so a path running in the sweep
+	// direction is filled in a single pass.
+	const int half = (height + 1) / 2;
+	const int wordStep = inward ? 1 : -1;
+	const int firstWord = inward ? 0 : wordsPerRow - 1;
+	__m128i changed = _mm_setzero_si128();
+	if (wordsPerRow == 1)
+	{
+		// boards up to 64 wide, the game board among them: there are no words to
+		// the sides, and the row just filled stays in a register for the next one
+		__m128i prev = _mm_setzero_si128();
+		for (int i = 0; i < half; ++i)
+		{
+			const int top = inward ? i : half - 1 - i;
+			const int bottom = inward ? 2 * half - 1 - i : half + i;
+			const ptrdiff_t laneOffset = ptrdiff_t(bottom - top) * stride;
+			uint64_t* const row = &words[(top + 1) * stride + 1];
+			// the row ahead in each lane: below the top lane going inward, above it going outward
+			const ptrdiff_t ahead = inward ? stride : -stride;
+			const __m128i old = LoadLanes(row, laneOffset);
+			const __m128i next = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + ahead)),
+				_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + laneOffset - ahead)));
+			if (i == 0)
+			{
+				prev = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row - ahead)),
+					_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + laneOffset + ahead)));
+			}
+			__m128i seed = _mm_or_si128(_mm_slli_epi64(old, 1), _mm_srli_epi64(old, 1));
+			seed = _mm_or_si128(seed, _mm_or_si128(prev, next));
+			const __m128i o = LoadLanes(&open.words[(top + 1) * stride + 1], laneOffset);
+			prev = _mm_or_si128(old, Spread(_mm_and_si128(seed, o), o));
+			StoreLanes(row, laneOffset, prev);
+			changed = _mm_or_si128(changed, _mm_xor_si128(prev, old));
+		}
+		return _mm_movemask_epi8(_mm_cmpeq_epi32(changed, _mm_setzero_si128())) != 0xFFFF;
+	}
+
+	for (int i = 0; i < half; ++i)
+	{
+		// with an odd height the lower half is one row short and runs over the extra padding row
+		const int top = inward ? i : half - 1 - i;
+		const int bottom = inward ? 2 * half - 1 - i : half + i;
+		const ptrdiff_t laneOffset = ptrdiff_t(bottom - top) * stride;
+		uint64_t* row = &words[(top + 1) * stride + 1 + firstWord];
+		const uint64_t* openRow = &open.words[(top + 1) * stride + 1 + firstWord];
+		for (int w = 0; w < wordsPerRow; ++w, row += wordStep, openRow += wordStep)
+		{
+			const __m128i old = LoadLanes(row, laneOffset);
+			__m128i seed = _mm_or_si128(_mm_slli_epi64(old, 1), _mm_srli_epi64(old, 1));
+			seed = _mm_or_si128(seed, LoadLanes(row - stride, laneOffset));
+			seed = _mm_or_si128(seed, LoadLanes(row + stride, laneOffset));
+			// the edge bits of the words to the left and right
+			seed = _mm_or_si128(seed, _mm_srli_epi64(LoadLanes(row - 1, laneOffset), 63));
+			seed = _mm_or_si128(seed, _mm_slli_epi64(LoadLanes(row + 1, laneOffset), 63));
+			const __m128i o = LoadLanes(openRow, laneOffset);
+			const __m128i filled = _mm_or_si128(old, Spread(_mm_and_si128(seed, o), o));
+			StoreLanes(row, laneOffset, filled);
+			changed = _mm_or_si128(changed, _mm_xor_si128(filled, old));
+		}
+	}
+	return _mm_movemask_epi8(_mm_cmpeq_epi32(changed, _mm_setzero_si128())) != 0xFFFF;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "Location.h"
+#include <cstdint>
+#include <vector>
+
+// One bit per cell of a width x height grid, each row packed into 64-bit
+// words (x = 0 is bit 0 of the first word). Flood fills run on whole words:
+// a row's bits spread along runs of open cells with a handful of word
+// operations, and rows are swept up and down until nothing changes, instead
+// of visiting the cells one by one from a queue.
+class Bitboard
+{
+public:
+	Bitboard(int width, int height);
+	int GetWidth() const;
+	int GetHeight() const;
+	void Clear();
+	// sets every cell of the grid
+	void Fill();
+	void Set(Location loc);
+	void Reset(Location loc);
+	// cells outside the grid read as clear
+	bool Test(Location loc) const;
+	int Count() const;
+	// replaces the contents with start plus every cell of open connected to it
+	// through the four neighbours; start itself does not have to be open. With
+	// wrap, cells on opposite edges are neighbours too.
+	// Returns the number of cells reached.
+	int FloodFill(const Bitboard& open, Location start, bool wrap = false);
+private:
+	int Index(Location loc) const;
+	// one pass over the rows, either from the top and bottom edges towards the
+	// middle and left to right, or the other way round; returns whether any
+	// cell was added
+	bool Sweep(const Bitboard& open, bool inward);
+	// carries what reached an edge over to the opposite edge; returns whether
+	// any cell was added
+	bool WrapEdges(const Bitboard& open);
+private:
+	int width;
+	int height;
+	int wordsPerRow;
+	// a row is wordsPerRow words between two empty padding words, and there are
+	// empty padding rows above and below (two below, for the lower half of an
+	// odd height in Sweep), so neighbours never need bounds checks
+	int stride;
+	std::vector<uint64_t> words;
+};
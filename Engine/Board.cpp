@@ -1,8 +1,19 @@
 #include "Board.h"
+#include "ChunkedWorld.h"
+#include "Direction.h"
+#include "Graphics.h"
+#include "Level.h"
+#include <cassert>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+const int Board::x_offset = (Graphics::ScreenWidth - dimension*width) / 2;
+const int Board::y_offset = (Graphics::ScreenHeight - dimension*height) / 2;
 
 Board::Board(Graphics& gfx)
 	:
-	gfx(gfx)
+	pGfx(&gfx)
 {}
 
 int Board::GetWidth() const
@@ -22,20 +33,89 @@ int Board::GetDim() const
 
 void Board::DrawSegment(Color& c, Location& loc)
 {	
-	gfx.DrawRectPadded(loc.x*dimension + x_offset, loc.y*dimension + y_offset, dimension, dimension, c);
+	assert(pGfx);
+	const int x = loc.x - origin.x;
+	const int y = loc.y - origin.y;
+	// only an endless board has cells out of view
+	if (x < 0 || y < 0 || x >= width || y >= height)
+	{
+		return;
+	}
+	pGfx->DrawRectPadded(x*dimension + x_offset, y*dimension + y_offset, dimension, dimension, c);
 }
 
 void Board::DrawBorder(Color c)
 {
-	gfx.DrawHollowRect(x_offset, y_offset, dimension*width, dimension*height, c);
+	assert(pGfx);
+	pGfx->DrawHollowRect(x_offset, y_offset, dimension*width, dimension*height, c);
 }
 
-bool Board::isOutsideBoard(Location loc)
+void Board::DrawWalls(Color c)
 {
+	assert(pGfx);
+	if (pWorld)
+	{
+		for (int y = 0; y < height; ++y)
+		{
+			int x = 0;
+			while (x < width)
+			{
+				const int start = x;
+				while (x < width && pWorld->IsWall(origin.Add({ x,y })))
+				{
+					++x;
+				}
+				if (x > start)
+				{
+					pGfx->DrawRectDim(start*dimension + x_offset, y*dimension + y_offset, (x - start)*dimension, dimension, c);
+				}
+				++x;
+			}
+		}
+		return;
+	}
+	if (!pLevel)
+	{
+		return;
+	}
+	for (int y = 0; y < height; ++y)
+	{
+		const uint64_t* const row = pLevel->GetWallRow(y);
+		int x = 0;
+		while (x < width)
+		{
+			const uint64_t word = row[x >> 6] >> (x & 63);
+			if (word == 0u)
+			{
+				// nothing left in this word
+				x = (x | 63) + 1;
+				continue;
+			}
+			if ((word & 1u) == 0u)
+			{
+				++x;
+				continue;
+			}
+			const int start = x;
+			while (x < width && pLevel->IsWall({ x,y }))
+			{
+				++x;
+			}
+			pGfx->DrawRectDim(start*dimension + x_offset, y*dimension + y_offset, (x - start)*dimension, dimension, c);
+		}
+	}
+}
+
+bool Board::isOutsideBoard(Location loc) const
+{
+	if (pWorld || wrap)
+	{
+		return false;
+	}
 	if (loc.x < 0 ||
 		loc.y < 0 ||
-		loc.x > width ||
-		loc.y > height)
+		loc.x >= width ||
+		loc.y >= height)
 	{
 		return true;
 	}
@@ -43,3 +123,87 @@ bool Board::isOutsideBoard(Location loc)
 		return false;
 }
 
+
+
+void Board::SetLevel(const Level* level)
+{
+	if (level && (level->GetWidth() != width || level->GetHeight() != height))
+	{
+		throw std::runtime_error("Level does not fit the board, which is " + std::to_string(width) + "x" +
+			std::to_string(height));
+	}
+	pLevel = level;
+}
+
+void Board::SetWorld(const ChunkedWorld* world)
+{
+	pWorld = world;
+	origin = {};
+}
+
+void Board::SetOrigin(Location origin_in)
+{
+	origin = origin_in;
+}
+
+Location Board::GetOrigin() const
+{
+	return origin;
+}
+
+void Board::SetWrap(bool on)
+{
+	wrap = on;
+}
+
+bool Board::IsWrapping() const
+{
+	return wrap && !pWorld;
+}
+
+int Board::GetDistance(Location a, Location b) const
+{
+	if (IsWrapping())
+	{
+		return RingDistance(a.x, b.x, width) + RingDistance(a.y, b.y, height);
+	}
+	return abs(a.x - b.x) + abs(a.y - b.y);
+}
+
+bool Board::IsWall(Location loc) const
+{
+	if (pWorld)
+	{
+		return pWorld->IsWall(loc);
+	}
+	return pLevel && pLevel->IsWall(loc);
+}
+
+Location Board::GetStart() const
+{
+	if (pLevel && pLevel->GetSpawnCount() > 0)
+	{
+		return { pLevel->GetSpawn(0).x,pLevel->GetSpawn(0).y };
+	}
+	return { 10,10 };
+}
+
+Location Board::GetStartDirection() const
+{
+	if (pLevel && pLevel->GetSpawnCount() > 0)
+	{
+		return ToDelta(Direction(pLevel->GetSpawn(0).dir));
+	}
+	return { 1,0 };
+}
+
+Location Board::RandomFoodCell(Rng& rng) const
+{
+	if (pLevel && !pWorld)
+	{
+		return pLevel->RandomFoodCell(rng);
+	}
+	// away from the border
+	const Location loc = { rng.Range(1, width - 1),rng.Range(1, height - 1) };
+	return origin.Add(loc);
+}
\ No newline at end of file
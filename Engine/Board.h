@@ -1,10 +1,18 @@
 #pragma once
-#include "Graphics.h"
+#include "Colors.h"
 #include "Location.h"
+#include "Rng.h"
+#include "Topology.h"
+
+class ChunkedWorld;
+class Graphics;
+class Level;
 
 class Board
 {
 public:
+	// a board without graphics is enough for running the rules headless
+	Board() = default;
 	Board(Graphics& gfx);
 	int GetWidth() const;
 	int GetHeight() const;
@@ -12,12 +20,43 @@ public:
 
 	void DrawSegment(Color& c, Location& loc);
 	void DrawBorder(Color c);
-	bool isOutsideBoard(Location loc);
+	// one rectangle per horizontal run of wall cells
+	void DrawWalls(Color c);
+	bool isOutsideBoard(Location loc) const;
+	// the level has to be of the board's size and outlive the board; nullptr removes it
+	void SetLevel(const Level* level);
+	// endless mode: nothing is outside the board, the walls come from the world
+	// and the board shows the width x height cells from the origin on
+	void SetWorld(const ChunkedWorld* world);
+	void SetOrigin(Location origin_in);
+	Location GetOrigin() const;
+	// toroidal board: moving off one edge comes back in at the opposite one, so
+	// nothing is outside the board either; ignored on an endless board
+	void SetWrap(bool on);
+	bool IsWrapping() const;
+	// where a step that may have left the board lands; loc itself on a bounded board
+	Location Wrap(Location loc) const
+	{
+		return wrap && !pWorld ? WrapLocation<width, height>(loc) : loc;
+	}
+	// moves between two cells, not counting walls or the snake
+	int GetDistance(Location a, Location b) const;
+	bool IsWall(Location loc) const;
+	// the level's first spawn point, or the middle-left start of the open board
+	Location GetStart() const;
+	Location GetStartDirection() const;
+	// where food may appear, a wall or not; on an endless board that is in view
+	Location RandomFoodCell(Rng& rng) const;
 private:
 	static constexpr int dimension = 20;
 	static constexpr int width = 30;
 	static constexpr int height = 25;
-	static constexpr int x_offset = (Graphics::ScreenWidth - dimension*width) / 2;
-	static constexpr int y_offset = (Graphics::ScreenHeight - dimension*height) / 2;
-	Graphics& gfx;
+	// defined in Board.cpp, where the screen size is known
+	static const int x_offset;
+	static const int y_offset;
+	Graphics* pGfx = nullptr;
+	const Level* pLevel = nullptr;
+	const ChunkedWorld* pWorld = nullptr;
+	Location origin;
+	bool wrap = false;
 };
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+#include "Board.h"
+#include "Direction.h"
+#include "GameState.h"
+
+// An autopilot for the snake. Decide is asked once per move, right before the
+// tick that moves the snake, and its answer goes through Snake::Steer like a
+// key press would. Bots may keep state between calls to avoid recomputing
+// everything each move, but must cope with the game jumping (rollback, reset).
+class Bot
+{
+public:
+	virtual ~Bot() = default;
+	virtual Direction Decide(const GameState& state, const Board& brd) = 0;
+	virtual const char* GetName() const = 0;
+};
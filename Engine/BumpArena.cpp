@@ -0,0 +1,38 @@
+#include "BumpArena.h"
+#include <algorithm>
+#include <cstdint>
+
+BumpArena::BumpArena(size_t capacity)
+	:
+	memory(new unsigned char[capacity]),
+	capacity(capacity),
+	used(0u)
+{}
+
+void* BumpArena::Allocate(size_t size, size_t alignment)
+{
+	// reserve enough for the worst case padding, then align inside the reservation
+	const size_t start = used.fetch_add(size + alignment - 1u, std::memory_order_relaxed);
+	if (start + size + alignment - 1u > capacity)
+	{
+		return nullptr;
+	}
+	const uintptr_t address = reinterpret_cast<uintptr_t>(memory.get() + start);
+	const uintptr_t aligned = (address + alignment - 1u) & ~uintptr_t(alignment - 1u);
+	return reinterpret_cast<void*>(aligned);
+}
+
+void BumpArena::Reset()
+{
+	used.store(0u, std::memory_order_relaxed);
+}
+
+size_t BumpArena::GetUsed() const
+{
+	return std::min(used.load(std::memory_order_relaxed), capacity);
+}
+
+size_t BumpArena::GetCapacity() const
+{
+	return capacity;
+}
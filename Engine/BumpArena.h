@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Fixed block of memory handed out by bumping an offset, from any number of
+// threads at once. Nothing is freed on its own: Reset drops everything in one
+// go, so only trivially destructible objects belong here.
+class BumpArena
+{
+public:
+	BumpArena(size_t capacity);
+	// nullptr once the arena is full
+	void* Allocate(size_t size, size_t alignment);
+	template<typename T, typename... Args>
+	T* New(Args&&... args)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+		void* p = Allocate(sizeof(T), alignof(T));
+		return p ? new(p) T(std::forward<Args>(args)...) : nullptr;
+	}
+	template<typename T>
+	T* NewArray(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+		T* p = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+		if (p)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				new(p + i) T();
+			}
+		}
+		return p;
+	}
+	// not safe while other threads are allocating
+	void Reset();
+	size_t GetUsed() const;
+	size_t GetCapacity() const;
+private:
+	std::unique_ptr<unsigned char[]> memory;
+	size_t capacity;
+	std::atomic<size_t> used;
+};
@@ -0,0 +1,44 @@
+#include "CellLayout.h"
+#include <stdexcept>
+
+constexpr uint32_t CellLayout::XBits;
+constexpr uint32_t CellLayout::YBits;
+
+CellLayout::CellLayout(int width_in, int height_in, Order order_in)
+	:
+	width(width_in),
+	height(height_in),
+	order(order_in)
+{
+	// Morton indices of sides up to 32768 still fit an int
+	if (width < 1 || height < 1 || width > 32768 || height > 32768)
+	{
+		throw std::runtime_error("Cell layout sides have to be between 1 and 32768");
+	}
+	// interleaving keeps the order along x and along y, so the last cell has the highest index
+	cellCount = order == Order::Morton ? Index({ width - 1,height - 1 }) + 1 : width * height;
+	rowSteps[int(Direction::Up)] = -width;
+	rowSteps[int(Direction::Down)] = width;
+	rowSteps[int(Direction::Left)] = -1;
+	rowSteps[int(Direction::Right)] = 1;
+}
+
+int CellLayout::GetWidth() const
+{
+	return width;
+}
+
+int CellLayout::GetHeight() const
+{
+	return height;
+}
+
+CellLayout::Order CellLayout::GetOrder() const
+{
+	return order;
+}
+
+int CellLayout::GetCellCount() const
+{
+	return cellCount;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "Direction.h"
+#include "Location.h"
+#include <cstdint>
+
+// Where cell (x, y) of a width x height grid lives in a flat array. Row major
+// puts each row after the previous one, so a step up or down lands a whole
+// row away. Morton (Z) order interleaves the bits of x and y, so cells that
+// are close on the board in any direction are mostly close in memory too,
+// which keeps vertical moves and square neighbourhoods on large boards in
+// cache. Neighbour steps in Morton order work on the interleaved index
+// directly, without decoding it.
+class CellLayout
+{
+public:
+	enum class Order
+	{
+		RowMajor,
+		Morton
+	};
+public:
+	CellLayout(int width, int height, Order order);
+	int GetWidth() const;
+	int GetHeight() const;
+	Order GetOrder() const;
+	// array length for a grid; Morton order leaves gaps unless both sides are powers of two
+	int GetCellCount() const;
+	int Index(Location loc) const
+	{
+		return order == Order::Morton ? int(Spread(uint32_t(loc.x)) | Spread(uint32_t(loc.y)) << 1) :
+			loc.y * width + loc.x;
+	}
+	Location ToLocation(int cell) const
+	{
+		if (order == Order::Morton)
+		{
+			return { int(Compact(uint32_t(cell))),int(Compact(uint32_t(cell) >> 1)) };
+		}
+		return { cell % width,cell / width };
+	}
+	// the cell one step away in dir, which has to be on the grid
+	int Neighbour(int cell, Direction dir) const
+	{
+		if (order == Order::RowMajor)
+		{
+			return cell + rowSteps[int(dir)];
+		}
+		// add or subtract 1 in one set of interleaved bits, carrying across the bits of the other
+		const uint32_t m = uint32_t(cell);
+		switch (dir)
+		{
+		case Direction::Up:
+			return int((((m & YBits) - 1u) & YBits) | (m & XBits));
+		case Direction::Down:
+			return int((((m | XBits) + 1u) & YBits) | (m & XBits));
+		case Direction::Left:
+			return int((((m & XBits) - 1u) & XBits) | (m & YBits));
+		default:
+			return int((((m | YBits) + 1u) & XBits) | (m & YBits));
+		}
+	}
+	// the bits of v at every other position, v < 65536
+	static uint32_t Spread(uint32_t v)
+	{
+		v &= 0x0000FFFFu;
+		v = (v | (v << 8)) & 0x00FF00FFu;
+		v = (v | (v << 4)) & 0x0F0F0F0Fu;
+		v = (v | (v << 2)) & 0x33333333u;
+		v = (v | (v << 1)) & 0x55555555u;
+		return v;
+	}
+	// the reverse of Spread, reading the even bits of v
+	static uint32_t Compact(uint32_t v)
+	{
+		v &= 0x55555555u;
+		v = (v | (v >> 1)) & 0x33333333u;
+		v = (v | (v >> 2)) & 0x0F0F0F0Fu;
+		v = (v | (v >> 4)) & 0x00FF00FFu;
+		v = (v | (v >> 8)) & 0x0000FFFFu;
+		return v;
+	}
+private:
+	static constexpr uint32_t XBits = 0x55555555u;
+	static constexpr uint32_t YBits = 0xAAAAAAAAu;
+private:
+	int width;
+	int height;
+	Order order;
+	int cellCount;
+	// row major index steps, in Direction order
+	int rowSteps[DirectionCount];
+};
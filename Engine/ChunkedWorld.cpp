@@ -0,0 +1,310 @@
+#include "ChunkedWorld.h"
+#include "Rng.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+constexpr int ChunkedWorld::ChunkBits;
+constexpr int ChunkedWorld::ChunkSize;
+constexpr int ChunkedWorld::None;
+
+static_assert(ChunkedWorld::ChunkSize == 32, "a chunk row is one uint32_t");
+
+ChunkedWorld::ChunkedWorld(const ChunkedWorldSettings& settings_in)
+	:
+	settings(settings_in)
+{
+	const int side = 2 * settings.radius + 1;
+	const int wanted = side * side + (settings.radius + settings.lookahead) * side;
+	if (settings.radius < 0 || settings.lookahead < 0 || settings.workers < 1 || settings.maxChunks < 2 * wanted)
+	{
+		throw std::runtime_error("Chunked world needs at least twice the chunks it keeps ready around the snake");
+	}
+	chunks.resize(settings.maxChunks);
+	for (int c = settings.maxChunks - 1; c >= 0; --c)
+	{
+		freeChunks.push_back(c);
+	}
+	int slots = 1;
+	while (slots < 2 * settings.maxChunks)
+	{
+		slots *= 2;
+	}
+	table.assign(slots, None);
+	tableMask = slots - 1;
+	for (int w = 0; w < settings.workers; ++w)
+	{
+		workers.emplace_back(&ChunkedWorld::WorkerLoop, this);
+	}
+}
+
+ChunkedWorld::~ChunkedWorld()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+void ChunkedWorld::Update(Location head, Location dir)
+{
+	for (const Job& job : inbox)
+	{
+		const int c = Find(Key(job.cx, job.cy));
+		// chunks dropped while they were being generated are not wanted any more
+		if (c != None && chunks[c].state == State::Pending)
+		{
+			std::memcpy(chunks[c].rows, job.rows, sizeof(job.rows));
+			chunks[c].state = State::Ready;
+			--pending;
+			++resident;
+			++generated;
+		}
+	}
+	inbox.clear();
+
+	// nearest first, so those are generated first
+	const int cx = head.x >> ChunkBits;
+	const int cy = head.y >> ChunkBits;
+	const int r = settings.radius;
+	Want(cx, cy);
+	for (int k = 1; k <= r + settings.lookahead; ++k)
+	{
+		for (int s = 0; s <= r; ++s)
+		{
+			// sideways from the direction of travel
+			Want(cx + k * dir.x + s * dir.y, cy + k * dir.y + s * dir.x);
+			Want(cx + k * dir.x - s * dir.y, cy + k * dir.y - s * dir.x);
+		}
+	}
+	for (int dy = -r; dy <= r; ++dy)
+	{
+		for (int dx = -r; dx <= r; ++dx)
+		{
+			Want(cx + dx, cy + dy);
+		}
+	}
+	Exchange();
+}
+
+bool ChunkedWorld::IsWall(Location loc) const
+{
+	const int c = Find(Key(loc.x >> ChunkBits, loc.y >> ChunkBits));
+	return c != None && chunks[c].state == State::Ready &&
+		(chunks[c].rows[loc.y & (ChunkSize - 1)] >> (loc.x & (ChunkSize - 1)) & 1u) != 0u;
+}
+
+bool ChunkedWorld::IsReady(Location loc) const
+{
+	const int c = Find(Key(loc.x >> ChunkBits, loc.y >> ChunkBits));
+	return c != None && chunks[c].state == State::Ready;
+}
+
+int ChunkedWorld::GetResidentCount() const
+{
+	return resident;
+}
+
+int ChunkedWorld::GetPendingCount() const
+{
+	return pending;
+}
+
+int ChunkedWorld::GetGeneratedCount() const
+{
+	return generated;
+}
+
+int ChunkedWorld::GetEvictedCount() const
+{
+	return evicted;
+}
+
+void ChunkedWorld::Generate(uint64_t seed, int obstacles, int cx, int cy, uint32_t* rows)
+{
+	std::fill(rows, rows + ChunkSize, 0u);
+	if (cx == 0 && cy == 0)
+	{
+		return;
+	}
+	Rng rng(seed ^ (Key(cx, cy) * 0x9E3779B97F4A7C15ull));
+	const int count = rng.Range(0, obstacles);
+	for (int o = 0; o < count; ++o)
+	{
+		// the outer ring of every chunk stays open, so chunks always join up
+		const int w = rng.Range(2, 8);
+		const int h = rng.Range(2, 8);
+		const int x = rng.Range(1, ChunkSize - 1 - w);
+		const int y = rng.Range(1, ChunkSize - 1 - h);
+		for (int row = y; row < y + h; ++row)
+		{
+			rows[row] |= ((1u << w) - 1u) << x;
+		}
+	}
+}
+
+uint64_t ChunkedWorld::Key(int cx, int cy)
+{
+	return (uint64_t(uint32_t(cx)) << 32) | uint32_t(cy);
+}
+
+int ChunkedWorld::Find(uint64_t key) const
+{
+	// the same chunk again, as for most cells along the snake
+	if (lastHit != None && chunks[lastHit].key == key)
+	{
+		return lastHit;
+	}
+	for (int slot = int((key * 0x9E3779B97F4A7C15ull) >> 32) & tableMask; table[slot] != None;
+		slot = (slot + 1) & tableMask)
+	{
+		if (chunks[table[slot]].key == key)
+		{
+			lastHit = table[slot];
+			return lastHit;
+		}
+	}
+	return None;
+}
+
+void ChunkedWorld::Want(int cx, int cy)
+{
+	const uint64_t key = Key(cx, cy);
+	int c = Find(key);
+	if (c != None)
+	{
+		Unlink(c);
+		PushFront(c);
+		return;
+	}
+	c = Allocate();
+	chunks[c].key = key;
+	chunks[c].state = State::Pending;
+	++pending;
+	int slot = int((key * 0x9E3779B97F4A7C15ull) >> 32) & tableMask;
+	while (table[slot] != None)
+	{
+		slot = (slot + 1) & tableMask;
+	}
+	table[slot] = c;
+	PushFront(c);
+	outbox.emplace_back();
+	outbox.back().cx = cx;
+	outbox.back().cy = cy;
+}
+
+int ChunkedWorld::Allocate()
+{
+	if (freeChunks.empty())
+	{
+		// the back of the list was wanted longest ago; everything wanted this update is in front
+		const int oldest = back;
+		Evict(oldest);
+		return oldest;
+	}
+	const int c = freeChunks.back();
+	freeChunks.pop_back();
+	return c;
+}
+
+void ChunkedWorld::Evict(int chunk)
+{
+	Unlink(chunk);
+	int slot = int((chunks[chunk].key * 0x9E3779B97F4A7C15ull) >> 32) & tableMask;
+	while (table[slot] != chunk)
+	{
+		slot = (slot + 1) & tableMask;
+	}
+	// shift later entries of the probe run back, so no lookup runs into the gap
+	table[slot] = None;
+	for (int next = (slot + 1) & tableMask; table[next] != None; next = (next + 1) & tableMask)
+	{
+		const int home = int((chunks[table[next]].key * 0x9E3779B97F4A7C15ull) >> 32) & tableMask;
+		if (((next - home) & tableMask) >= ((next - slot) & tableMask))
+		{
+			table[slot] = table[next];
+			table[next] = None;
+			slot = next;
+		}
+	}
+	if (chunks[chunk].state == State::Pending)
+	{
+		--pending;
+	}
+	else
+	{
+		--resident;
+	}
+	chunks[chunk].state = State::Free;
+	if (lastHit == chunk)
+	{
+		lastHit = None;
+	}
+	++evicted;
+}
+
+void ChunkedWorld::Unlink(int chunk)
+{
+	Chunk& c = chunks[chunk];
+	(c.prev != None ? chunks[c.prev].next : front) = c.next;
+	(c.next != None ? chunks[c.next].prev : back) = c.prev;
+	c.prev = None;
+	c.next = None;
+}
+
+void ChunkedWorld::PushFront(int chunk)
+{
+	chunks[chunk].next = front;
+	(front != None ? chunks[front].prev : back) = chunk;
+	front = chunk;
+}
+
+void ChunkedWorld::Exchange()
+{
+	std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+	if (!lock.owns_lock())
+	{
+		return;
+	}
+	// the newest requests go first, they are for where the snake is now
+	for (auto job = outbox.rbegin(); job != outbox.rend(); ++job)
+	{
+		jobs.push_front(*job);
+	}
+	const bool added = !outbox.empty();
+	outbox.clear();
+	inbox.insert(inbox.end(), results.begin(), results.end());
+	results.clear();
+	lock.unlock();
+	if (added)
+	{
+		wake.notify_all();
+	}
+}
+
+void ChunkedWorld::WorkerLoop()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		wake.wait(lock, [this]()
+		{
+			return stopping || !jobs.empty();
+		});
+		if (stopping)
+		{
+			return;
+		}
+		Job job = jobs.front();
+		jobs.pop_front();
+		lock.unlock();
+		Generate(settings.seed, settings.obstacles, job.cx, job.cy, job.rows);
+		lock.lock();
+		results.push_back(job);
+	}
+}
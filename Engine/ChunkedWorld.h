@@ -0,0 +1,113 @@
+#pragma once
+#include "Location.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct ChunkedWorldSettings
+{
+	uint64_t seed = 1u;
+	// chunks kept in memory; beyond that the least recently wanted one is dropped
+	int maxChunks = 256;
+	// chunks kept ready all around the snake, and further ones straight ahead of it
+	int radius = 1;
+	int lookahead = 3;
+	int workers = 2;
+	// wall blocks per chunk, at most
+	int obstacles = 3;
+};
+
+// Endless board for the snake: a sparse map of ChunkSize x ChunkSize chunks,
+// generated from the seed on worker threads as the snake approaches and
+// dropped once it has left them far behind. A dropped chunk comes back the
+// same when it is generated again.
+// Only one thread, the game loop, calls Update and the lookups. Lookups are
+// O(1): a check of the last chunk hit, then an open addressing hash table of
+// the chunks in memory. The game loop never waits for the workers: it hands
+// over requests and takes finished chunks with try_lock, and a chunk that is
+// not ready yet reads as open, so the caller checks IsReady before moving in.
+class ChunkedWorld
+{
+public:
+	static constexpr int ChunkBits = 5;
+	static constexpr int ChunkSize = 1 << ChunkBits;
+public:
+	ChunkedWorld(const ChunkedWorldSettings& settings = ChunkedWorldSettings());
+	~ChunkedWorld();
+	ChunkedWorld(const ChunkedWorld&) = delete;
+	ChunkedWorld& operator=(const ChunkedWorld&) = delete;
+	// once per tick: takes in finished chunks and asks for the ones around head
+	// and ahead of it in direction dir
+	void Update(Location head, Location dir);
+	bool IsWall(Location loc) const;
+	bool IsReady(Location loc) const;
+	int GetResidentCount() const;
+	// chunks asked for and not yet taken in
+	int GetPendingCount() const;
+	int GetGeneratedCount() const;
+	int GetEvictedCount() const;
+	// the walls of one chunk, a bit per cell, row y in rows[y]; the chunk with
+	// the start cell in it is left open
+	static void Generate(uint64_t seed, int obstacles, int cx, int cy, uint32_t* rows);
+private:
+	enum class State : uint8_t
+	{
+		Free,
+		Pending,
+		Ready
+	};
+	struct Chunk
+	{
+		uint64_t key = 0u;
+		State state = State::Free;
+		// neighbours in the recently wanted list, most recent first
+		int prev = -1;
+		int next = -1;
+		uint32_t rows[ChunkSize];
+	};
+	struct Job
+	{
+		int cx;
+		int cy;
+		uint32_t rows[ChunkSize];
+	};
+	static constexpr int None = -1;
+private:
+	static uint64_t Key(int cx, int cy);
+	int Find(uint64_t key) const;
+	void Want(int cx, int cy);
+	int Allocate();
+	void Evict(int chunk);
+	void Unlink(int chunk);
+	void PushFront(int chunk);
+	// swaps requests for finished chunks with the workers, unless they hold the lock right now
+	void Exchange();
+	void WorkerLoop();
+private:
+	ChunkedWorldSettings settings;
+	std::vector<Chunk> chunks;
+	// chunk index per slot or None, a power of two at least twice the chunk count
+	std::vector<int> table;
+	int tableMask;
+	int front = None;
+	int back = None;
+	std::vector<int> freeChunks;
+	mutable int lastHit = None;
+	int resident = 0;
+	int pending = 0;
+	int generated = 0;
+	int evicted = 0;
+	// game loop side of the hand over
+	std::vector<Job> outbox;
+	std::vector<Job> inbox;
+	// shared with the workers, under mutex
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::deque<Job> jobs;
+	std::vector<Job> results;
+	bool stopping = false;
+	std::vector<std::thread> workers;
+};
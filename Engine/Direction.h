@@ -0,0 +1,36 @@
+#pragma once
+#include "Location.h"
+
+// The four steering directions, numbered the same way everywhere a direction
+// is stored or exchanged: replay input, environment actions and bot decisions.
+enum class Direction : unsigned char
+{
+	Up,
+	Down,
+	Left,
+	Right
+};
+
+constexpr int DirectionCount = 4;
+
+inline Location ToDelta(Direction dir)
+{
+	static const Location deltas[DirectionCount] = { { 0,-1 },{ 0,1 },{ -1,0 },{ 1,0 } };
+	return deltas[int(dir) & 3];
+}
+
+inline Direction ToDirection(Location delta_loc)
+{
+	if (delta_loc.y < 0)
+		return Direction::Up;
+	if (delta_loc.y > 0)
+		return Direction::Down;
+	if (delta_loc.x < 0)
+		return Direction::Left;
+	return Direction::Right;
+}
+
+inline Direction Opposite(Direction dir)
+{
+	return Direction(int(dir) ^ 1);
+}
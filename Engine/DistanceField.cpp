@@ -0,0 +1,253 @@
+#include "DistanceField.h"
+#include "Direction.h"
+#include "Topology.h"
+#include <algorithm>
+#include <cassert>
+
+DistanceField::DistanceField(int width, int height, bool wrap)
+	:
+	width(width),
+	height(height),
+	wrap(wrap),
+	stride(width + 2),
+	links(size_t(width + 2) * (height + 2) * DirectionCount),
+	dist(size_t(width + 2) * (height + 2), Unreachable),
+	blocked(size_t(width + 2) * (height + 2), 1)
+{
+	assert(width > 0 && height > 0);
+	// border cells are never expanded, so only the cells of the grid need their links
+	for (int y = 0; y < height; ++y)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			int* const l = &links[size_t(Index({ x,y })) * DirectionCount];
+			for (int k = 0; k < DirectionCount; ++k)
+			{
+				const Location n = Location{ x,y }.Add(ToDelta(Direction(k)));
+				l[k] = Index(wrap ? WrapLocation(n, width, height) : n);
+			}
+		}
+	}
+	Clear();
+}
+
+int DistanceField::GetWidth() const
+{
+	return width;
+}
+
+int DistanceField::GetHeight() const
+{
+	return height;
+}
+
+bool DistanceField::IsWrapping() const
+{
+	return wrap;
+}
+
+void DistanceField::Clear()
+{
+	hasTarget = false;
+	std::fill(dist.begin(), dist.end(), Unreachable);
+	for (int y = 0; y < height; ++y)
+	{
+		std::fill_n(blocked.begin() + Index({ 0,y }), width, uint8_t(0));
+	}
+}
+
+void DistanceField::Rebuild(Location target_in)
+{
+	assert(IsInside(target_in));
+	target = target_in;
+	hasTarget = true;
+	std::fill(dist.begin(), dist.end(), Unreachable);
+	queue.clear();
+	const int t = Index(target);
+	if (!blocked[t])
+	{
+		dist[t] = 0;
+		queue.push_back({ t,0 });
+	}
+	Propagate();
+}
+
+void DistanceField::Block(Location loc)
+{
+	assert(IsInside(loc));
+	const int c = Index(loc);
+	if (blocked[c])
+	{
+		return;
+	}
+	blocked[c] = 1;
+	if (dist[c] == Unreachable)
+	{
+		return;
+	}
+
+	// find every cell whose shortest paths all ran through c. They are visited
+	// in order of their old distance, so by the time a cell is checked all of
+	// its possible supports one step closer have already been invalidated.
+	affected.clear();
+	affected.push_back({ c,dist[c] });
+	dist[c] = Unreachable;
+	for (size_t i = 0; i < affected.size(); ++i)
+	{
+		const Entry e = affected[i];
+		const int* const l = &links[size_t(e.cell) * DirectionCount];
+		for (int k = 0; k < DirectionCount; ++k)
+		{
+			const int n = l[k];
+			if (dist[n] != e.dist + 1)
+			{
+				continue;
+			}
+			bool supported = false;
+			const int* const l2 = &links[size_t(n) * DirectionCount];
+			for (int k2 = 0; k2 < DirectionCount; ++k2)
+			{
+				if (dist[l2[k2]] == e.dist)
+				{
+					supported = true;
+					break;
+				}
+			}
+			if (!supported)
+			{
+				affected.push_back({ n,dist[n] });
+				dist[n] = Unreachable;
+			}
+		}
+	}
+
+	// the invalidated cells that still touch an intact cell restart the search,
+	// closest first
+	seeds.clear();
+	for (size_t i = 1; i < affected.size(); ++i)
+	{
+		const int cell = affected[i].cell;
+		const int best = MinNeighbour(cell);
+		if (best != Unreachable)
+		{
+			dist[cell] = best + 1;
+			seeds.push_back({ cell,best + 1 });
+		}
+	}
+	std::sort(seeds.begin(), seeds.end(), [](const Entry& a, const Entry& b) { return a.dist < b.dist; });
+	queue.clear();
+	size_t nextSeed = 0;
+	size_t head = 0;
+	while (nextSeed < seeds.size() || head < queue.size())
+	{
+		// merge the sorted seeds with the breadth-first queue, which is sorted too
+		Entry e;
+		if (head == queue.size() || (nextSeed < seeds.size() && seeds[nextSeed].dist <= queue[head].dist))
+		{
+			e = seeds[nextSeed++];
+		}
+		else
+		{
+			e = queue[head++];
+		}
+		if (dist[e.cell] != e.dist)
+		{
+			continue;
+		}
+		const int* const l = &links[size_t(e.cell) * DirectionCount];
+		for (int k = 0; k < DirectionCount; ++k)
+		{
+			const int n = l[k];
+			if (!blocked[n] && dist[n] > e.dist + 1)
+			{
+				dist[n] = e.dist + 1;
+				queue.push_back({ n,e.dist + 1 });
+			}
+		}
+	}
+}
+
+void DistanceField::Unblock(Location loc)
+{
+	assert(IsInside(loc));
+	const int c = Index(loc);
+	if (!blocked[c])
+	{
+		return;
+	}
+	blocked[c] = 0;
+	if (!hasTarget)
+	{
+		return;
+	}
+
+	// freeing a cell can only shorten paths, and only through that cell
+	const int best = c == Index(target) ? -1 : MinNeighbour(c);
+	if (best == Unreachable)
+	{
+		return;
+	}
+	dist[c] = best + 1;
+	queue.clear();
+	queue.push_back({ c,best + 1 });
+	Propagate();
+}
+
+bool DistanceField::IsBlocked(Location loc) const
+{
+	return !IsInside(loc) || blocked[Index(loc)] != 0;
+}
+
+int DistanceField::GetDistance(Location loc) const
+{
+	return IsInside(loc) ? dist[Index(loc)] : Unreachable;
+}
+
+bool DistanceField::HasTarget() const
+{
+	return hasTarget;
+}
+
+Location DistanceField::GetTarget() const
+{
+	return target;
+}
+
+bool DistanceField::IsInside(Location loc) const
+{
+	return loc.x >= 0 && loc.y >= 0 && loc.x < width && loc.y < height;
+}
+
+int DistanceField::Index(Location loc) const
+{
+	return (loc.y + 1) * stride + loc.x + 1;
+}
+
+int DistanceField::MinNeighbour(int cell) const
+{
+	int best = Unreachable;
+	const int* const l = &links[size_t(cell) * DirectionCount];
+	for (int k = 0; k < DirectionCount; ++k)
+	{
+		best = std::min(best, dist[l[k]]);
+	}
+	return best;
+}
+
+void DistanceField::Propagate()
+{
+	for (size_t head = 0; head < queue.size(); ++head)
+	{
+		const Entry e = queue[head];
+		const int* const l = &links[size_t(e.cell) * DirectionCount];
+		for (int k = 0; k < DirectionCount; ++k)
+		{
+			const int n = l[k];
+			if (!blocked[n] && dist[n] > e.dist + 1)
+			{
+				dist[n] = e.dist + 1;
+				queue.push_back({ n,e.dist + 1 });
+			}
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include "Location.h"
+#include <cstdint>
+#include <vector>
+
+// Shortest path length from every cell of a width x height grid to one target
+// cell, going around blocked cells (the snake's body). Blocking or freeing a
+// single cell updates only the cells whose distance actually changes, so
+// following a moving snake does not need a search over the whole grid.
+// On a wrapping grid the cells along one edge neighbour those along the
+// opposite edge.
+class DistanceField
+{
+public:
+	static constexpr int Unreachable = 0x7FFFFFFF;
+public:
+	DistanceField(int width, int height, bool wrap = false);
+	int GetWidth() const;
+	int GetHeight() const;
+	bool IsWrapping() const;
+	// frees every cell and drops the target, leaving all cells unreachable
+	void Clear();
+	// moves the target and recomputes every distance from scratch
+	void Rebuild(Location target);
+	void Block(Location loc);
+	void Unblock(Location loc);
+	// cells outside the grid count as blocked and unreachable
+	bool IsBlocked(Location loc) const;
+	int GetDistance(Location loc) const;
+	bool HasTarget() const;
+	Location GetTarget() const;
+private:
+	struct Entry
+	{
+		int cell;
+		int dist;
+	};
+private:
+	bool IsInside(Location loc) const;
+	int Index(Location loc) const;
+	// lowest distance among the four neighbours, Unreachable if none is reachable
+	int MinNeighbour(int cell) const;
+	// breadth-first relaxation from the cells already in queue
+	void Propagate();
+private:
+	int width;
+	int height;
+	bool wrap;
+	// the grid is stored with a blocked one cell border, so neighbours never need bounds checks
+	int stride;
+	// the four neighbours of every cell, the border included: across the border
+	// on a bounded grid, round to the opposite edge on a wrapping one
+	std::vector<int> links;
+	Location target;
+	bool hasTarget = false;
+	std::vector<int> dist;
+	std::vector<uint8_t> blocked;
+	// scratch for the updates, kept to avoid allocating on every move
+	std::vector<Entry> queue;
+	std::vector<Entry> affected;
+	std::vector<Entry> seeds;
+};
@@ -0,0 +1,198 @@
+#include "ExperienceBuffer.h"
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+constexpr uint32_t ExperienceBuffer::Magic;
+constexpr uint32_t ExperienceBuffer::Version;
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t), "counters live in the file as plain 64-bit words");
+
+ExperienceBuffer::ExperienceBuffer(const std::string& filename, int width, int height, uint64_t capacity)
+	:
+	file(filename, HeaderBytes + capacity * RecordSizeFor(width * height)),
+	header(reinterpret_cast<Header*>(file.GetData())),
+	records(file.GetData() + HeaderBytes),
+	cellCount(width * height)
+{
+	if (capacity == 0u)
+	{
+		throw std::runtime_error("An experience buffer needs room for at least one record: " + filename);
+	}
+	std::memset(file.GetData(), 0, HeaderBytes);
+	header->magic = Magic;
+	header->version = Version;
+	header->width = width;
+	header->height = height;
+	header->capacity = capacity;
+	header->recordSize = RecordSizeFor(cellCount);
+	header->appended.store(0u);
+	// a resized old file may still hold complete-looking records
+	for (uint64_t n = 0; n < capacity; ++n)
+	{
+		GetRecord(n)->sequence.store(0u, std::memory_order_relaxed);
+	}
+}
+
+ExperienceBuffer::ExperienceBuffer(const std::string& filename)
+	:
+	file(filename, MappedFile::Access::ReadWrite),
+	header(reinterpret_cast<Header*>(file.GetData())),
+	records(file.GetData() + HeaderBytes)
+{
+	if (file.GetSize() < HeaderBytes || header->magic != Magic || header->version != Version)
+	{
+		throw std::runtime_error("Not a supported experience buffer: " + filename);
+	}
+	cellCount = header->width * header->height;
+	if (header->recordSize != RecordSizeFor(cellCount) ||
+		file.GetSize() < HeaderBytes + header->capacity * header->recordSize)
+	{
+		throw std::runtime_error("Experience buffer is truncated or corrupt: " + filename);
+	}
+}
+
+int ExperienceBuffer::GetCellCount() const
+{
+	return cellCount;
+}
+
+uint64_t ExperienceBuffer::GetCapacity() const
+{
+	return header->capacity;
+}
+
+uint64_t ExperienceBuffer::GetAppended() const
+{
+	return header->appended.load(std::memory_order_acquire);
+}
+
+size_t ExperienceBuffer::GetRecordSize() const
+{
+	return size_t(header->recordSize);
+}
+
+void ExperienceBuffer::Append(const uint8_t* observations, const int* actions, const float* rewards, const uint8_t* dones, int count)
+{
+	// one claim for the whole batch keeps the shared counter out of the hot loop
+	const uint64_t first = header->appended.fetch_add(uint64_t(count), std::memory_order_relaxed);
+	for (int i = 0; i < count; ++i, observations += cellCount)
+	{
+		const uint64_t n = first + i;
+		Record* record = GetRecord(n);
+		record->sequence.store(2u * n + 1u, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		record->reward = rewards[i];
+		record->flags = uint8_t((actions[i] & 3) | (dones[i] ? 4 : 0));
+		PackCells(observations, cellCount, record->cells);
+		record->sequence.store(2u * n + 2u, std::memory_order_release);
+	}
+}
+
+int ExperienceBuffer::Sample(Rng& rng, int count, uint8_t* observations, int* actions, float* rewards, uint8_t* dones) const
+{
+	int drawn = 0;
+	// a few misses are expected while writers are busy or lapping the ring
+	for (int attempts = 0; drawn < count && attempts < count * 4 + 16; ++attempts)
+	{
+		const uint64_t appended = GetAppended();
+		const uint64_t kept = appended < header->capacity ? appended : header->capacity;
+		if (kept == 0u)
+		{
+			break;
+		}
+		const uint64_t n = appended - 1u - ((uint64_t(rng.Next()) << 32 | rng.Next()) % kept);
+		if (ReadRecord(n, observations + size_t(drawn) * cellCount, actions[drawn], rewards[drawn], dones[drawn]))
+		{
+			++drawn;
+		}
+	}
+	return drawn;
+}
+
+void ExperienceBuffer::Flush()
+{
+	file.Flush();
+}
+
+size_t ExperienceBuffer::RecordSizeFor(int cells)
+{
+	// whole 8-byte words, so every record's sequence number stays aligned
+	const size_t bytes = offsetof(Record, cells) + (size_t(cells) + 3u) / 4u;
+	return (bytes + 7u) & ~size_t(7u);
+}
+
+ExperienceBuffer::Record* ExperienceBuffer::GetRecord(uint64_t n) const
+{
+	return reinterpret_cast<Record*>(records + (n % header->capacity) * header->recordSize);
+}
+
+bool ExperienceBuffer::ReadRecord(uint64_t n, uint8_t* observation, int& action, float& reward, uint8_t& done) const
+{
+	const Record* record = GetRecord(n);
+	const uint64_t complete = 2u * n + 2u;
+	if (record->sequence.load(std::memory_order_acquire) != complete)
+	{
+		return false;
+	}
+	reward = record->reward;
+	const uint8_t flags = record->flags;
+	UnpackCells(record->cells, cellCount, observation);
+	std::atomic_thread_fence(std::memory_order_acquire);
+	// a writer that started on the record meanwhile has bumped the sequence
+	if (record->sequence.load(std::memory_order_relaxed) != complete)
+	{
+		return false;
+	}
+	action = flags & 3;
+	done = (flags >> 2) & 1;
+	return true;
+}
+
+void ExperienceBuffer::PackCells(const uint8_t* cells, int count, uint8_t* packed)
+{
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		// four 2-bit values, one per byte, folded into the low byte
+		uint32_t v;
+		std::memcpy(&v, cells + i, 4);
+		v &= 0x03030303u;
+		*packed++ = uint8_t(v | v >> 6 | v >> 12 | v >> 18);
+	}
+	if (i < count)
+	{
+		uint8_t last = 0u;
+		for (int shift = 0; i < count; ++i, shift += 2)
+		{
+			last |= uint8_t((cells[i] & 3) << shift);
+		}
+		*packed = last;
+	}
+}
+
+void ExperienceBuffer::UnpackCells(const uint8_t* packed, int count, uint8_t* cells)
+{
+	// every packed byte spread to four cell bytes
+	struct Table
+	{
+		uint32_t spread[256];
+		Table()
+		{
+			for (uint32_t b = 0; b < 256u; ++b)
+			{
+				spread[b] = (b & 3u) | ((b >> 2) & 3u) << 8 | ((b >> 4) & 3u) << 16 | ((b >> 6) & 3u) << 24;
+			}
+		}
+	};
+	static const Table table;
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		std::memcpy(cells + i, &table.spread[*packed++], 4);
+	}
+	for (int shift = 0; i < count; ++i, shift += 2)
+	{
+		cells[i] = (*packed >> shift) & 3u;
+	}
+}
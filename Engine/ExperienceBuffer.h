@@ -0,0 +1,70 @@
+#pragma once
+#include "MappedFile.h"
+#include "Rng.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Ring of (observation, action, reward, done) transitions in a memory-mapped
+// file, so it can hold far more than fits in RAM. Observations are SnakeEnv
+// cell values packed at 2 bits per cell; action and done share one byte.
+// Appending is lock-free: writers claim record numbers with one atomic add on
+// a counter in the file and fill the records in place, so any number of
+// simulation threads can append at once. Each record carries a sequence
+// number, odd while it is being written, which lets a sampler skip records
+// that are unfinished or being overwritten instead of waiting for them.
+class ExperienceBuffer
+{
+public:
+	// creates a new, empty buffer of capacity records (an existing file is overwritten)
+	ExperienceBuffer(const std::string& filename, int width, int height, uint64_t capacity);
+	// reopens a buffer, appending continues after its last record
+	ExperienceBuffer(const std::string& filename);
+	int GetCellCount() const;
+	uint64_t GetCapacity() const;
+	// records appended over the buffer's lifetime; only the last GetCapacity() are kept
+	uint64_t GetAppended() const;
+	size_t GetRecordSize() const;
+	// count transitions at once, observations count x GetCellCount() cell values
+	void Append(const uint8_t* observations, const int* actions, const float* rewards, const uint8_t* dones, int count);
+	// draws count kept records uniformly, unpacking observations to one cell value per
+	// byte; returns how many were drawn, fewer only if the buffer is (nearly) empty
+	int Sample(Rng& rng, int count, uint8_t* observations, int* actions, float* rewards, uint8_t* dones) const;
+	void Flush();
+private:
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		int32_t width;
+		int32_t height;
+		uint64_t capacity;
+		uint64_t recordSize;
+		std::atomic<uint64_t> appended;
+	};
+	struct Record
+	{
+		// 2 * n + 1 while record n is written, 2 * n + 2 once it is complete
+		std::atomic<uint64_t> sequence;
+		float reward;
+		// bits 0-1 action, bit 2 done
+		uint8_t flags;
+		// 4 cells per byte, the first one in the low bits
+		uint8_t cells[1];
+	};
+	static constexpr uint32_t Magic = 0x584B4E53; // "SNKX"
+	static constexpr uint32_t Version = 1;
+	// the records start on their own page
+	static constexpr size_t HeaderBytes = 4096u;
+private:
+	static size_t RecordSizeFor(int cells);
+	Record* GetRecord(uint64_t n) const;
+	bool ReadRecord(uint64_t n, uint8_t* observation, int& action, float& reward, uint8_t& done) const;
+	static void PackCells(const uint8_t* cells, int count, uint8_t* packed);
+	static void UnpackCells(const uint8_t* packed, int count, uint8_t* cells);
+private:
+	MappedFile file;
+	Header* header;
+	uint8_t* records;
+	int cellCount;
+};
@@ -1,6 +1,6 @@
 #include "Food.h"
 
-Location Food::GetLocation()
+Location Food::GetLocation() const
 {
 	return loc;
 }
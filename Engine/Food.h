@@ -6,7 +6,7 @@
 class Food
 {
 public:
-	Location GetLocation();
+	Location GetLocation() const;
 	void DrawToBoard(Board& brd);
 	void Jump(Location new_loc);
 private:
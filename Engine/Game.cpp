@@ -20,74 +20,310 @@
  ******************************************************************************************/
 #include "MainWindow.h"
 #include "Game.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <random>
 
 Game::Game(MainWindow& wnd)
 	:
 	wnd(wnd),
 	gfx(wnd),
-	rng(rd()),
-	ColorDist(0, 2),
-	Food_x(1,brd.GetWidth()-1),
-	Food_y(1,brd.GetHeight()-1),
-	brd(gfx)
+	brd(gfx),
+	history(HistoryTicks)
 {
-	snake.InitHead();
-	food.Jump({ Food_x(rng),Food_y(rng) });
+	Profiler::SetThreadName("game loop");
+
+	// a replay file passed on the command line is played back instead of a new
+	// game, a .level file is played as the walls of a new game
+	std::wstring args = wnd.GetArgs();
+	args.erase(std::remove(args.begin(), args.end(), L'"'), args.end());
+	args.erase(0, args.find_first_not_of(L' '));
+	args.erase(args.find_last_not_of(L' ') + 1);
+	const std::wstring levelExtension = L".level";
+	if (args.size() > levelExtension.size() &&
+		args.compare(args.size() - levelExtension.size(), levelExtension.size(), levelExtension) == 0)
+	{
+		level.reset(new Level(std::string(args.begin(), args.end())));
+		brd.SetLevel(level.get());
+		args.clear();
+	}
+	if (!args.empty())
+	{
+		replay.Load(std::string(args.begin(), args.end()));
+		playback = true;
+		SeekReplay(0);
+	}
+	else
+	{
+		std::random_device rd;
+		const unsigned int seed = rd();
+		replay.Begin(seed);
+		Simulation::Reset(state, brd, seed);
+	}
 }
 
 void Game::Go()
 {
-	gfx.BeginFrame();	
-	UpdateModel();
-	ComposeFrame();
-	gfx.EndFrame();
+	{
+		PROFILE_SCOPE("Frame");
+		{
+			PROFILE_SCOPE("BeginFrame");
+			gfx.BeginFrame();
+		}
+		{
+			PROFILE_SCOPE("UpdateModel");
+			UpdateModel();
+		}
+		{
+			PROFILE_SCOPE("ComposeFrame");
+			ComposeFrame();
+		}
+		{
+			PROFILE_SCOPE("EndFrame");
+			gfx.EndFrame();
+		}
+	}
+	PROFILE_END_FRAME();
 }
 
 void Game::UpdateModel()
 {
-	if (!GameOver)
-	{
-		++counter;
+	HandleKeyEvents();
 
-		snake.CheckForInput(wnd.kbd);
+	if (playback)
+	{
+		if (state.tick < replay.GetTickCount())
+		{
+			state.snake.SetDirection(replay.GetInput(state.tick));
+			Tick();
+		}
+	}
+	else if (!state.GameOver)
+	{
+		if (world)
+		{
+			const Location head = state.snake.GetSegment(0);
+			world->Update(head, state.snake.GetDirection());
+			brd.SetOrigin({ head.x - brd.GetWidth() / 2,head.y - brd.GetHeight() / 2 });
+			// rather than wait for the workers, the snake waits until every cell it could move to is there
+			for (int i = 0; i < DirectionCount; ++i)
+			{
+				if (!world->IsReady(head.Add(ToDelta(Direction(i)))))
+				{
+					return;
+				}
+			}
+		}
+		else if (IsRecording() && replay.NeedsKeyframe())
+		{
+			replay.AddKeyframe(state);
+		}
+		history.Push(state);
+		if (autopilot)
+		{
+			// the bot steers once per move, on the tick that moves the snake
+			if (state.counter + 1 >= Simulation::Timer)
+			{
+				state.snake.Steer(ToDelta(autopilot->Decide(state, brd)));
+			}
+		}
+		else
+		{
+			state.snake.CheckForInput(wnd.kbd);
+		}
+		if (IsRecording())
+		{
+			replay.RecordInput(state.snake.GetDirection());
+		}
+		Tick();
+	}
+}
 
+void Game::Tick()
+{
+	PROFILE_SCOPE("Tick");
+	++ticksThisFrame;
+	Simulation::Tick(state, brd);
+}
 
-		if (snake.CheckFood(food))
+void Game::HandleKeyEvents()
+{
+	while (!wnd.kbd.KeyIsEmpty())
+	{
+		const Keyboard::Event e = wnd.kbd.ReadKey();
+		if (!e.IsPress())
+		{
+			continue;
+		}
+		if (e.GetCode() == VK_F3)
 		{
-			food.Jump({ Food_x(rng),Food_y(rng) });
+			overlay.Toggle();
+			continue;
 		}
-		if (counter >= Timer)
+		if (e.GetCode() == VK_F2)
 		{
-			GameOver = CheckForGameOver(snake, brd);
-			if (!GameOver)
+			// toggles a trace capture; the file is finished when the writer is destroyed
+			if (trace)
+			{
+				trace.reset();
+			}
+			else
 			{
-				snake.Move();
-				counter = 0;
+				trace = std::make_unique<TraceWriter>("trace.json");
 			}
+			continue;
+		}
+		if (!playback)
+		{
+			if (e.GetCode() == VK_F5 && IsRecording())
+			{
+				replay.Save("last.replay");
+			}
+			else if (e.GetCode() == VK_F6 && !level)
+			{
+				ToggleEndless();
+			}
+			else if (e.GetCode() == VK_F7 && !world)
+			{
+				ToggleWrap();
+			}
+			else if (e.GetCode() == VK_BACK)
+			{
+				Rollback(RollbackTicks);
+			}
+			else if (e.GetCode() == VK_F4 && !world)
+			{
+				CycleAutopilot();
+			}
+			continue;
+		}
+		switch (e.GetCode())
+		{
+		case VK_PRIOR:
+			SeekReplay(state.tick - ReplaySeekStep);
+			break;
+		case VK_NEXT:
+			SeekReplay(state.tick + ReplaySeekStep);
+			break;
+		case VK_HOME:
+			SeekReplay(0);
+			break;
+		case VK_END:
+			SeekReplay(replay.GetTickCount());
+			break;
 		}
 	}
 }
 
-bool Game::CheckForGameOver(Snake& snake, Board& brd)
+void Game::SeekReplay(int target)
 {
-	if (snake.EatsItself() || brd.isOutsideBoard(snake.GetNextHeadLocation()) )
+	target = std::max(0, std::min(target, replay.GetTickCount()));
+	state = replay.FindKeyframe(target).state;
+	while (state.tick < target)
 	{
-		return true;
+		state.snake.SetDirection(replay.GetInput(state.tick));
+		Tick();
+	}
+}
+
+void Game::Rollback(int ticksBack)
+{
+	// fall back to the oldest state we still have if the game is younger than ticksBack
+	ticksBack = std::min(ticksBack, history.GetCount() - 1);
+	if (history.Rollback(ticksBack, state))
+	{
+		replay.Truncate(state.tick);
+	}
+}
+
+void Game::ToggleEndless()
+{
+	// the bots plan on the bounded board, so switching modes switches the autopilot off
+	autopilot.reset();
+	autopilotMode = 0;
+	if (world)
+	{
+		brd.SetWorld(nullptr);
+		world.reset();
 	}
 	else
-		return false;
+	{
+		world = std::make_unique<ChunkedWorld>();
+		brd.SetWorld(world.get());
+	}
+	std::random_device rd;
+	const unsigned int seed = rd();
+	replay.Begin(seed);
+	history.Clear();
+	Simulation::Reset(state, brd, seed);
+}
+
+void Game::ToggleWrap()
+{
+	// the bots are set up for the topology they were made on
+	brd.SetWrap(!brd.IsWrapping());
+	autopilot.reset();
+	autopilotMode = 0;
+	std::random_device rd;
+	const unsigned int seed = rd();
+	replay.Begin(seed);
+	history.Clear();
+	Simulation::Reset(state, brd, seed);
+}
+
+bool Game::IsRecording() const
+{
+	// an endless, wrapping or level game depends on the board too, which a replay does not hold
+	return !world && !level && !brd.IsWrapping();
 }
 
+void Game::CycleAutopilot()
+{
+	// off -> shortest path -> Hamiltonian cycle -> tree search -> off; the
+	// cycle runs through every cell, so a level's walls leave it out
+	autopilotMode = (autopilotMode + 1) % 4;
+	if (autopilotMode == 2 && level)
+	{
+		autopilotMode = 3;
+	}
+	switch (autopilotMode)
+	{
+	case 1:
+		autopilot = std::make_unique<BfsBot>(brd);
+		break;
+	case 2:
+		autopilot = std::make_unique<HamiltonianBot>(brd);
+		break;
+	case 3:
+	{
+		// small enough to decide within a frame
+		MctsSettings settings;
+		settings.iterations = 400;
+		autopilot = std::make_unique<MctsBot>(brd, settings);
+		break;
+	}
+	default:
+		autopilot.reset();
+		break;
+	}
+}
 
 void Game::ComposeFrame()
 {
+	overlay.Update(ticksThisFrame, state.snake.GetLength());
+	ticksThisFrame = 0;
+	if (overlay.IsVisible())
+	{
+		overlay.Draw(gfx);
+	}
 	
 	brd.DrawBorder(Colors::Blue);
+	brd.DrawWalls(Colors::Gray);
 	
-	snake.DrawToBoard(brd);
-	food.DrawToBoard(brd);
+	state.snake.DrawToBoard(brd);
+	state.food.DrawToBoard(brd);
 	
-	if (GameOver)
+	if (state.GameOver)
 	{
 		gfx.DrawGameOver(Graphics::ScreenWidth / 2 - 42, Graphics::ScreenHeight / 2 - 32);
 	}
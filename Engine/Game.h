@@ -24,9 +24,20 @@
 #include "Mouse.h"
 #include "Graphics.h"
 #include "Board.h"
+#include "ChunkedWorld.h"
+#include "Level.h"
 #include "Snake.h"
 #include "Food.h"
-#include <random>
+#include "GameState.h"
+#include "StateHistory.h"
+#include "Simulation.h"
+#include "Replay.h"
+#include "TraceWriter.h"
+#include "PerfOverlay.h"
+#include "BfsBot.h"
+#include "HamiltonianBot.h"
+#include "MctsBot.h"
+#include <memory>
 
 class Game
 {
@@ -40,7 +51,14 @@ private:
 	void UpdateModel();
 	/********************************/
 	/*  User Functions              */
-	bool CheckForGameOver(Snake& snake, Board& brd);
+	void Tick();
+	void HandleKeyEvents();
+	void SeekReplay(int target);
+	void Rollback(int ticksBack);
+	void ToggleEndless();
+	void ToggleWrap();
+	void CycleAutopilot();
+	bool IsRecording() const;
 	/********************************/
 private:
 	MainWindow& wnd;
@@ -48,15 +66,21 @@ private:
 	/********************************/
 	/*  User Variables              */
 	Board brd;
-	Snake snake;
-	Food food;
-	std::random_device rd;
-	std::mt19937 rng;
-	std::uniform_int_distribution<int> ColorDist;
-	std::uniform_int_distribution<int> Food_x;
-	std::uniform_int_distribution<int> Food_y;
-	static constexpr int Timer = 20;
-	int counter = 0;
-	bool GameOver = false;
+	// walls of brd, if the game was started with a level
+	std::unique_ptr<Level> level;
+	// the endless board, while in endless mode
+	std::unique_ptr<ChunkedWorld> world;
+	GameState state;
+	Replay replay;
+	bool playback = false;
+	static constexpr int ReplaySeekStep = 600;
+	StateHistory history;
+	static constexpr int HistoryTicks = 120;
+	static constexpr int RollbackTicks = 60;
+	std::unique_ptr<TraceWriter> trace;
+	PerfOverlay overlay;
+	int ticksThisFrame = 0;
+	std::unique_ptr<Bot> autopilot;
+	int autopilotMode = 0;
 	/********************************/
 };
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+#include "Snake.h"
+#include "Food.h"
+#include "Rng.h"
+#include <type_traits>
+
+// Everything the simulation reads and writes, kept in one contiguous block
+// with no pointers or owned resources, so a snapshot or restore is a single memcpy.
+struct GameState
+{
+	Snake snake;
+	Food food;
+	Rng rng;
+	int counter = 0;
+	int tick = 0;
+	bool GameOver = false;
+};
+
+static_assert(std::is_trivially_copyable<GameState>::value, "GameState must stay memcpy-able");
@@ -0,0 +1,98 @@
+#include "HamiltonianBot.h"
+#include <algorithm>
+
+HamiltonianBot::HamiltonianBot(const Board& brd)
+	:
+	cycle(HamiltonianCycle::Get(brd.GetWidth(), brd.GetHeight())),
+	occupied(size_t(brd.GetWidth()) * brd.GetHeight())
+{}
+
+Direction HamiltonianBot::Decide(const GameState& state, const Board& brd)
+{
+	const Snake& snake = state.snake;
+	const int length = snake.GetLength();
+	const int cells = cycle->GetLength();
+	for (int i = 0; i < length; ++i)
+	{
+		const Location seg = snake.GetSegment(i);
+		occupied[seg.y * cycle->GetWidth() + seg.x] = 1;
+	}
+
+	const Location head = snake.GetSegment(0);
+	const int headIndex = cycle->GetIndex(head);
+	const Direction current = ToDirection(snake.GetDirection());
+	const bool ordered = IsInCycleOrder(snake);
+	const int toTail = length > 1 ? cycle->Forward(headIndex, cycle->GetIndex(snake.GetSegment(length - 1))) : cells;
+	const int toFood = cycle->Forward(headIndex, cycle->GetIndex(state.food.GetLocation()));
+	// how far ahead along the cycle the head may land; cutting stops once the
+	// snake covers half the board, from then on it just follows the cycle
+	const int reach = ordered && length * 2 < cells ? std::min(toTail - 1 - GrowthMargin, toFood) : 1;
+
+	Direction best = current;
+	int bestSteps = 0;
+	for (int i = 0; i < DirectionCount; ++i)
+	{
+		const Direction dir = Direction(i);
+		const Location next = brd.Wrap(head.Add(ToDelta(dir)));
+		if (dir == Opposite(current) || brd.isOutsideBoard(next) || !IsFree(next, snake))
+		{
+			continue;
+		}
+		const int steps = cycle->Forward(headIndex, cycle->GetIndex(next));
+		if (steps == 1 && bestSteps == 0)
+		{
+			best = dir;
+			bestSteps = 1;
+		}
+		else if (steps > bestSteps && steps <= reach)
+		{
+			best = dir;
+			bestSteps = steps;
+		}
+		else if (bestSteps == 0 && !ordered)
+		{
+			// off the cycle (autopilot switched on mid-game): stay alive until the body falls into line
+			best = dir;
+		}
+	}
+
+	for (int i = 0; i < length; ++i)
+	{
+		const Location seg = snake.GetSegment(i);
+		occupied[seg.y * cycle->GetWidth() + seg.x] = 0;
+	}
+	return best;
+}
+
+const char* HamiltonianBot::GetName() const
+{
+	return "hamiltonian";
+}
+
+bool HamiltonianBot::IsInCycleOrder(const Snake& snake) const
+{
+	const int tailIndex = cycle->GetIndex(snake.GetSegment(snake.GetLength() - 1));
+	int prev = 0;
+	for (int i = snake.GetLength() - 2; i >= 0; --i)
+	{
+		const int pos = cycle->Forward(tailIndex, cycle->GetIndex(snake.GetSegment(i)));
+		// equal positions only where the tail doubled up after growing
+		if (pos < prev || (pos == prev && pos != 0))
+		{
+			return false;
+		}
+		prev = pos;
+	}
+	return true;
+}
+
+bool HamiltonianBot::IsFree(Location loc, const Snake& snake) const
+{
+	// the tail moves on with the head, unless it has just doubled up from growing
+	const int length = snake.GetLength();
+	if (length > 1 && loc == snake.GetSegment(length - 1))
+	{
+		return !(snake.GetSegment(length - 2) == loc);
+	}
+	return occupied[loc.y * cycle->GetWidth() + loc.x] == 0;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "Bot.h"
+#include "HamiltonianCycle.h"
+#include <memory>
+#include <vector>
+
+// Follows a Hamiltonian cycle of the board, so it never dies and plays on
+// until the snake fills the board. While the snake is short it cuts across
+// the cycle towards the food, but only where the cut keeps the whole body in
+// cycle order behind the head, with room left to grow before reaching the tail.
+class HamiltonianBot : public Bot
+{
+public:
+	// free cells kept between the head and the tail when cutting ahead
+	static constexpr int GrowthMargin = 4;
+public:
+	HamiltonianBot(const Board& brd);
+	Direction Decide(const GameState& state, const Board& brd) override;
+	const char* GetName() const override;
+private:
+	// true when every segment lies on the cycle behind the one in front of it
+	bool IsInCycleOrder(const Snake& snake) const;
+	bool IsFree(Location loc, const Snake& snake) const;
+private:
+	std::shared_ptr<const HamiltonianCycle> cycle;
+	// body cells of the snake being decided on, cleared again after each decision
+	std::vector<uint8_t> occupied;
+};
@@ -0,0 +1,103 @@
+#include "HamiltonianCycle.h"
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+std::shared_ptr<const HamiltonianCycle> HamiltonianCycle::Get(int width, int height)
+{
+	static std::mutex mutex;
+	static std::map<std::pair<int, int>, std::shared_ptr<const HamiltonianCycle>> cache;
+	std::lock_guard<std::mutex> lock(mutex);
+	std::shared_ptr<const HamiltonianCycle>& cycle = cache[{ width,height }];
+	if (!cycle)
+	{
+		cycle = std::make_shared<const HamiltonianCycle>(width, height);
+	}
+	return cycle;
+}
+
+HamiltonianCycle::HamiltonianCycle(int width, int height)
+	:
+	width(width),
+	height(height),
+	indices(size_t(width) * height)
+{
+	if (width < 2 || height < 2 || (width * height) % 2 != 0)
+	{
+		throw std::runtime_error("no Hamiltonian cycle on a board with an odd number of cells");
+	}
+	path.reserve(indices.size());
+
+	// along the first row, then zig-zag back row by row leaving out the first
+	// column, which is the way back up. With an odd number of rows the same is
+	// done with rows and columns swapped.
+	const bool transposed = height % 2 != 0;
+	const int w = transposed ? height : width;
+	const int h = transposed ? width : height;
+	auto add = [&](int x, int y)
+	{
+		path.push_back(transposed ? Location{ y,x } : Location{ x,y });
+	};
+	for (int x = 0; x < w; ++x)
+	{
+		add(x, 0);
+	}
+	for (int y = 1; y < h; ++y)
+	{
+		if (y % 2 != 0)
+		{
+			for (int x = w - 1; x >= 1; --x)
+			{
+				add(x, y);
+			}
+		}
+		else
+		{
+			for (int x = 1; x < w; ++x)
+			{
+				add(x, y);
+			}
+		}
+	}
+	for (int y = h - 1; y >= 1; --y)
+	{
+		add(0, y);
+	}
+
+	for (int i = 0; i < GetLength(); ++i)
+	{
+		indices[path[i].y * width + path[i].x] = i;
+	}
+}
+
+int HamiltonianCycle::GetWidth() const
+{
+	return width;
+}
+
+int HamiltonianCycle::GetHeight() const
+{
+	return height;
+}
+
+int HamiltonianCycle::GetLength() const
+{
+	return int(path.size());
+}
+
+int HamiltonianCycle::GetIndex(Location loc) const
+{
+	return indices[loc.y * width + loc.x];
+}
+
+Location HamiltonianCycle::GetLocation(int index) const
+{
+	return path[index];
+}
+
+int HamiltonianCycle::Forward(int from, int to) const
+{
+	const int steps = to - from;
+	return steps < 0 ? steps + GetLength() : steps;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "Location.h"
+#include <memory>
+#include <vector>
+
+// A closed path through every cell of a width x height grid, moving one cell
+// at a time. Snakes following it can never run into themselves. A cycle only
+// exists when the number of cells is even.
+class HamiltonianCycle
+{
+public:
+	// shared, built once per grid size; safe to call from several threads
+	static std::shared_ptr<const HamiltonianCycle> Get(int width, int height);
+	HamiltonianCycle(int width, int height);
+	int GetWidth() const;
+	int GetHeight() const;
+	int GetLength() const;
+	// position of a cell along the cycle
+	int GetIndex(Location loc) const;
+	Location GetLocation(int index) const;
+	// steps along the cycle from one position to another, 0..length-1
+	int Forward(int from, int to) const;
+private:
+	int width;
+	int height;
+	std::vector<int> indices;
+	std::vector<Location> path;
+};
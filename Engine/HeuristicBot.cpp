@@ -0,0 +1,137 @@
+#include "HeuristicBot.h"
+#include <algorithm>
+
+HeuristicBot::HeuristicBot(const Board& brd)
+	:
+	HeuristicBot(brd, GetDefaultWeights())
+{}
+
+HeuristicBot::HeuristicBot(const Board& brd, const Weights& weights)
+	:
+	weights(weights),
+	floor(brd.GetWidth(), brd.GetHeight()),
+	open(brd.GetWidth(), brd.GetHeight()),
+	reached(brd.GetWidth(), brd.GetHeight())
+{
+	floor.Fill();
+	for (int y = 0; y < brd.GetHeight(); ++y)
+	{
+		for (int x = 0; x < brd.GetWidth(); ++x)
+		{
+			if (brd.IsWall({ x,y }))
+			{
+				floor.Reset({ x,y });
+			}
+		}
+	}
+}
+
+Direction HeuristicBot::Decide(const GameState& state, const Board& brd)
+{
+	const Snake& snake = state.snake;
+	const int length = snake.GetLength();
+	const Location head = snake.GetSegment(0);
+	const Location tail = snake.GetSegment(length - 1);
+	const Location food = state.food.GetLocation();
+	open = floor;
+	for (int i = 0; i < length - 1; ++i)
+	{
+		open.Reset(snake.GetSegment(i));
+	}
+	// right after growing the last two segments share a cell, and that one stays put
+	const bool tailMoves = length < 2 || !(snake.GetSegment(length - 2) == tail);
+	if (!tailMoves)
+	{
+		open.Reset(tail);
+	}
+
+	const int cells = brd.GetWidth() * brd.GetHeight();
+	const float halfSide = std::max(1, std::min(brd.GetWidth(), brd.GetHeight()) / 2) * 1.0f;
+	const int foodDist = brd.GetDistance(head, food);
+	const Direction current = ToDirection(snake.GetDirection());
+	Direction best = current;
+	float bestScore = 0.0f;
+	bool found = false;
+	for (int i = 0; i < DirectionCount; ++i)
+	{
+		const Direction dir = Direction(i);
+		const Location next = brd.Wrap(head.Add(ToDelta(dir)));
+		if (dir == Opposite(current) || !open.Test(next))
+		{
+			continue;
+		}
+
+		float features[FeatureCount];
+		const int dist = brd.GetDistance(next, food);
+		features[FoodCloser] = dist < foodDist ? 1.0f : -1.0f;
+		features[FoodEaten] = next == food ? 1.0f : 0.0f;
+		const int room = reached.FloodFill(open, next, brd.IsWrapping());
+		features[Room] = float(room) / cells;
+		features[Trapped] = room < length ? 1.0f : 0.0f;
+		features[TailReachable] = reached.Test(tail) ? 1.0f : 0.0f;
+		features[KeepsDirection] = dir == current ? 1.0f : 0.0f;
+		// a wrapping board has no edges to keep away from
+		const int edge = std::min(std::min(next.x, brd.GetWidth() - 1 - next.x), std::min(next.y, brd.GetHeight() - 1 - next.y));
+		features[EdgeDistance] = brd.IsWrapping() ? 1.0f : std::min(1.0f, edge / halfSide);
+		int blocked = 0;
+		for (int n = 0; n < DirectionCount; ++n)
+		{
+			const Location around = brd.Wrap(next.Add(ToDelta(Direction(n))));
+			blocked += !(around == head) && !open.Test(around);
+		}
+		features[Contact] = blocked / 4.0f;
+
+		float score = 0.0f;
+		for (int f = 0; f < FeatureCount; ++f)
+		{
+			score += weights[f] * features[f];
+		}
+		if (!found || score > bestScore)
+		{
+			best = dir;
+			bestScore = score;
+			found = true;
+		}
+	}
+	return best;
+}
+
+const char* HeuristicBot::GetName() const
+{
+	return "heuristic";
+}
+
+const HeuristicBot::Weights& HeuristicBot::GetWeights() const
+{
+	return weights;
+}
+
+HeuristicBot::Weights HeuristicBot::GetDefaultWeights()
+{
+	Weights w = {};
+	w[FoodCloser] = 1.0f;
+	w[FoodEaten] = 1.0f;
+	w[Room] = 2.0f;
+	w[Trapped] = -5.0f;
+	w[TailReachable] = 2.0f;
+	w[KeepsDirection] = 0.1f;
+	w[EdgeDistance] = 0.0f;
+	w[Contact] = 0.5f;
+	return w;
+}
+
+const char* HeuristicBot::GetFeatureName(int feature)
+{
+	static const char* const names[FeatureCount] =
+	{
+		"food-closer",
+		"food-eaten",
+		"room",
+		"trapped",
+		"tail-reachable",
+		"keeps-direction",
+		"edge-distance",
+		"contact"
+	};
+	return names[feature];
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "Bitboard.h"
+#include "Bot.h"
+#include <array>
+
+// Scores every safe move by a weighted sum of simple features of the cell it
+// leads to and takes the best one. The weights are what the genetic trainer
+// in Tools evolves; the defaults are a hand-tuned starting point.
+class HeuristicBot : public Bot
+{
+public:
+	enum Feature
+	{
+		// +1 when the move gets closer to the food, -1 when it moves away
+		FoodCloser,
+		FoodEaten,
+		// cells reachable from the new head, as a share of the board
+		Room,
+		// the reachable cells are fewer than the snake is long
+		Trapped,
+		// the tail can still be reached from the new head
+		TailReachable,
+		KeepsDirection,
+		// distance to the nearest edge, as a share of half the smaller side
+		EdgeDistance,
+		// blocked neighbours of the new head (body or edge), as a share of 4
+		Contact,
+		FeatureCount
+	};
+	using Weights = std::array<float, FeatureCount>;
+public:
+	HeuristicBot(const Board& brd);
+	HeuristicBot(const Board& brd, const Weights& weights);
+	Direction Decide(const GameState& state, const Board& brd) override;
+	const char* GetName() const override;
+	const Weights& GetWeights() const;
+	static Weights GetDefaultWeights();
+	static const char* GetFeatureName(int feature);
+private:
+	Weights weights;
+	// the board's cells that are not walls
+	Bitboard floor;
+	// cells free of the body, the tail included as it moves out of the way
+	Bitboard open;
+	Bitboard reached;
+};
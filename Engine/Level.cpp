@@ -0,0 +1,166 @@
+#include "Level.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+constexpr uint32_t Level::Magic;
+constexpr uint32_t Level::Version;
+
+static_assert(sizeof(Level::Spawn) == 12 && sizeof(Level::Region) == 16, "spawns and regions are stored as they are laid out");
+
+void Level::Write(const std::string& filename, int width, int height, const std::vector<uint8_t>& walls,
+	const std::vector<Spawn>& spawns, const std::vector<Region>& regions)
+{
+	if (width < 1 || height < 1 || walls.size() != size_t(width) * size_t(height))
+	{
+		throw std::runtime_error("Level walls do not match its size: " + filename);
+	}
+	const uint64_t wordsPerRow = (uint64_t(width) + 63u) / 64u;
+	const uint64_t wallsOffset = WallsOffset(spawns.size(), regions.size());
+	MappedFile file(filename, wallsOffset + wordsPerRow * height * sizeof(uint64_t));
+	uint8_t* const data = file.GetData();
+	std::memset(data, 0, size_t(file.GetSize()));
+
+	Header header;
+	header.magic = Magic;
+	header.version = Version;
+	header.width = width;
+	header.height = height;
+	header.spawnCount = uint32_t(spawns.size());
+	header.regionCount = uint32_t(regions.size());
+	std::memcpy(data, &header, sizeof(header));
+	if (!spawns.empty())
+	{
+		std::memcpy(data + sizeof(Header), spawns.data(), spawns.size() * sizeof(Spawn));
+	}
+	if (!regions.empty())
+	{
+		std::memcpy(data + sizeof(Header) + spawns.size() * sizeof(Spawn), regions.data(), regions.size() * sizeof(Region));
+	}
+	uint64_t* const rows = reinterpret_cast<uint64_t*>(data + wallsOffset);
+	for (int y = 0; y < height; ++y)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			if (walls[size_t(y) * width + x])
+			{
+				rows[y * wordsPerRow + (x >> 6)] |= uint64_t(1u) << (x & 63);
+			}
+		}
+	}
+	file.Flush();
+}
+
+Level::Level(const std::string& filename)
+	:
+	file(filename, MappedFile::Access::Read)
+{
+	Header header;
+	if (file.GetSize() < sizeof(Header))
+	{
+		throw std::runtime_error("Not a level file: " + filename);
+	}
+	std::memcpy(&header, file.GetData(), sizeof(header));
+	if (header.magic != Magic || header.version != Version)
+	{
+		throw std::runtime_error("Not a supported level file: " + filename);
+	}
+	if (header.width < 1 || header.height < 1)
+	{
+		throw std::runtime_error("Level has no cells: " + filename);
+	}
+	width = header.width;
+	height = header.height;
+	spawnCount = int(header.spawnCount);
+	wordsPerRow = int((uint64_t(width) + 63u) / 64u);
+	const uint64_t wallsOffset = WallsOffset(header.spawnCount, header.regionCount);
+	if (file.GetSize() < wallsOffset + uint64_t(wordsPerRow) * uint64_t(height) * sizeof(uint64_t))
+	{
+		throw std::runtime_error("Level file is truncated: " + filename);
+	}
+	spawns = reinterpret_cast<const Spawn*>(file.GetData() + sizeof(Header));
+	regions = reinterpret_cast<const Region*>(file.GetData() + sizeof(Header) + header.spawnCount * sizeof(Spawn));
+	walls = reinterpret_cast<const uint64_t*>(file.GetData() + wallsOffset);
+
+	// the rest is only looked up later, so it has to be sound now
+	for (int i = 0; i < spawnCount; ++i)
+	{
+		const Spawn& spawn = spawns[i];
+		if (spawn.x < 0 || spawn.y < 0 || spawn.x >= width || spawn.y >= height || IsWall({ spawn.x,spawn.y }) ||
+			spawn.dir >= uint32_t(DirectionCount))
+		{
+			throw std::runtime_error("Level has a spawn point off the board or on a wall: " + filename);
+		}
+	}
+	uint64_t area = 0u;
+	for (uint32_t i = 0; i < header.regionCount; ++i)
+	{
+		const Region& region = regions[i];
+		if (region.width < 1 || region.height < 1 || region.x < 0 || region.y < 0 ||
+			region.width > width - region.x || region.height > height - region.y)
+		{
+			throw std::runtime_error("Level has a food region off the board: " + filename);
+		}
+		area += uint64_t(region.width) * uint64_t(region.height);
+		regionEnds.push_back(area);
+	}
+}
+
+int Level::GetWidth() const
+{
+	return width;
+}
+
+int Level::GetHeight() const
+{
+	return height;
+}
+
+const uint64_t* Level::GetWallRow(int y) const
+{
+	return walls + size_t(y) * wordsPerRow;
+}
+
+int Level::GetWordsPerRow() const
+{
+	return wordsPerRow;
+}
+
+int Level::GetSpawnCount() const
+{
+	return spawnCount;
+}
+
+const Level::Spawn& Level::GetSpawn(int index) const
+{
+	return spawns[index];
+}
+
+int Level::GetRegionCount() const
+{
+	return int(regionEnds.size());
+}
+
+const Level::Region& Level::GetRegion(int index) const
+{
+	return regions[index];
+}
+
+Location Level::RandomFoodCell(Rng& rng) const
+{
+	if (regionEnds.empty())
+	{
+		return { rng.Range(0, width - 1),rng.Range(0, height - 1) };
+	}
+	const uint64_t pick = ((uint64_t(rng.Next()) << 32) | rng.Next()) % regionEnds.back();
+	const size_t index = std::upper_bound(regionEnds.begin(), regionEnds.end(), pick) - regionEnds.begin();
+	const Region& region = regions[index];
+	const uint64_t offset = pick - (index > 0 ? regionEnds[index - 1] : 0u);
+	return { region.x + int(offset % uint64_t(region.width)),region.y + int(offset / uint64_t(region.width)) };
+}
+
+uint64_t Level::WallsOffset(uint64_t nSpawns, uint64_t nRegions)
+{
+	const uint64_t end = sizeof(Header) + nSpawns * sizeof(Spawn) + nRegions * sizeof(Region);
+	return (end + 7u) & ~uint64_t(7u);
+}
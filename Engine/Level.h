@@ -0,0 +1,82 @@
+#pragma once
+#include "Direction.h"
+#include "Location.h"
+#include "MappedFile.h"
+#include "Rng.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A static maze: walls, snake spawn points and the regions food appears in.
+// The file is memory-mapped and the wall bitmask is read in place, so even a
+// huge level opens instantly and only the pages that get touched are read.
+// File, little endian: Header, spawnCount Spawns, regionCount Regions, then,
+// from the next multiple of 8 bytes, height rows of GetWordsPerRow() uint64_t
+// words, bit x % 64 of word x / 64 set for a wall at x. Bits past the width are 0.
+class Level
+{
+public:
+	struct Spawn
+	{
+		int32_t x;
+		int32_t y;
+		// a Direction
+		uint32_t dir;
+	};
+	// food appears on the open cells of these, the larger ones more often;
+	// a level without regions spreads its food over the whole board
+	struct Region
+	{
+		int32_t x;
+		int32_t y;
+		int32_t width;
+		int32_t height;
+	};
+public:
+	// walls: width x height row major, non-zero for a wall; an existing file is overwritten
+	static void Write(const std::string& filename, int width, int height, const std::vector<uint8_t>& walls,
+		const std::vector<Spawn>& spawns, const std::vector<Region>& regions);
+	Level(const std::string& filename);
+	int GetWidth() const;
+	int GetHeight() const;
+	// false outside the level
+	bool IsWall(Location loc) const
+	{
+		return loc.x >= 0 && loc.y >= 0 && loc.x < width && loc.y < height &&
+			(walls[size_t(loc.y) * wordsPerRow + (loc.x >> 6)] >> (loc.x & 63) & 1u) != 0u;
+	}
+	// one row of the bitmask, e.g. for going over the walls 64 cells at a time
+	const uint64_t* GetWallRow(int y) const;
+	int GetWordsPerRow() const;
+	int GetSpawnCount() const;
+	const Spawn& GetSpawn(int index) const;
+	int GetRegionCount() const;
+	const Region& GetRegion(int index) const;
+	// a random cell for food, which may still be a wall or taken
+	Location RandomFoodCell(Rng& rng) const;
+private:
+	struct Header
+	{
+		uint32_t magic;
+		uint32_t version;
+		int32_t width;
+		int32_t height;
+		uint32_t spawnCount;
+		uint32_t regionCount;
+	};
+	static constexpr uint32_t Magic = 0x4C4B4E53; // "SNKL"
+	static constexpr uint32_t Version = 1;
+private:
+	static uint64_t WallsOffset(uint64_t nSpawns, uint64_t nRegions);
+private:
+	MappedFile file;
+	int width;
+	int height;
+	int wordsPerRow;
+	int spawnCount;
+	const Spawn* spawns;
+	const Region* regions;
+	const uint64_t* walls;
+	// running total of the region areas, to draw a region by its size
+	std::vector<uint64_t> regionEnds;
+};
@@ -1,7 +1,7 @@
 #pragma once
 struct Location
 {
-	Location Add(const Location& loc)
+	Location Add(const Location& loc) const
 	{
 		Location new_loc = { x,y };
 		new_loc.x += loc.x;
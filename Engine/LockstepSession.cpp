@@ -0,0 +1,168 @@
+#include "LockstepSession.h"
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+LockstepSession::LockstepSession(Arena& arena_in, int localPlayer_in, std::vector<Transport*> peers_in,
+	int inputDelay_in)
+	:
+	arena(arena_in),
+	localPlayer(localPlayer_in),
+	nPlayers(arena_in.GetSnakeCount()),
+	peers(std::move(peers_in)),
+	inputDelay(inputDelay_in),
+	// a peer runs at most inputDelay + 1 ticks ahead and sends inputDelay beyond that
+	window(2 * inputDelay_in + 4),
+	inputs(size_t(window) * nPlayers),
+	haveInput(inputs.size()),
+	hashTick(inputs.size(), -1),
+	hashes(inputs.size()),
+	stepInputs(nPlayers),
+	nextLocal(inputDelay_in)
+{
+	if (int(peers.size()) != nPlayers || localPlayer < 0 || localPlayer >= nPlayers || inputDelay < 0)
+	{
+		throw std::runtime_error("Lockstep needs one peer per snake and a local player among them");
+	}
+	// nobody can steer the ticks before the delay, so the snakes keep going
+	for (int t = 0; t < inputDelay; ++t)
+	{
+		for (int p = 0; p < nPlayers; ++p)
+		{
+			inputs[Slot(t) + p] = arena.GetDirection(p);
+			haveInput[Slot(t) + p] = 1;
+		}
+	}
+}
+
+bool LockstepSession::Update(Direction input)
+{
+	if (nextLocal <= tick + inputDelay)
+	{
+		SendLocalInput(input);
+	}
+	ReceiveInputs();
+	const int slot = Slot(tick);
+	for (int p = 0; p < nPlayers; ++p)
+	{
+		if (!haveInput[slot + p])
+		{
+			++stalls;
+			return false;
+		}
+	}
+	for (int p = 0; p < nPlayers; ++p)
+	{
+		stepInputs[p] = inputs[slot + p];
+		haveInput[slot + p] = 0;
+	}
+	arena.Step(stepInputs.data());
+	++tick;
+	return true;
+}
+
+int LockstepSession::GetTick() const
+{
+	return tick;
+}
+
+int LockstepSession::GetStallCount() const
+{
+	return stalls;
+}
+
+uint64_t LockstepSession::GetBytesSent() const
+{
+	uint64_t bytes = 0u;
+	for (const Transport* peer : peers)
+	{
+		bytes += peer ? peer->GetBytesSent() : 0u;
+	}
+	return bytes;
+}
+
+void LockstepSession::SendLocalInput(Direction input)
+{
+	inputs[Slot(nextLocal) + localPlayer] = input;
+	haveInput[Slot(nextLocal) + localPlayer] = 1;
+	message.assign(InputMessage, 0);
+	for (int b = 0; b < 4; ++b)
+	{
+		message[b] = uint8_t(uint32_t(nextLocal) >> (8 * b));
+	}
+	message[4] = uint8_t(input);
+	if (tick % HashInterval == 0)
+	{
+		const uint32_t hash = arena.GetHash();
+		for (int b = 0; b < 4; ++b)
+		{
+			message.push_back(uint8_t(hash >> (8 * b)));
+		}
+		CheckHash(tick, localPlayer, hash);
+	}
+	for (Transport* peer : peers)
+	{
+		if (peer)
+		{
+			peer->Send(message.data(), message.size());
+		}
+	}
+	++nextLocal;
+}
+
+void LockstepSession::ReceiveInputs()
+{
+	for (int p = 0; p < nPlayers; ++p)
+	{
+		Transport* const peer = peers[p];
+		while (peer && peer->Receive(message))
+		{
+			if (message.size() != InputMessage && message.size() != HashedInputMessage)
+			{
+				throw std::runtime_error("Lockstep message of unexpected size from player " + std::to_string(p));
+			}
+			uint32_t t = 0u;
+			for (int b = 0; b < 4; ++b)
+			{
+				t |= uint32_t(message[b]) << (8 * b);
+			}
+			if (int(t) < tick || int(t) >= tick + window || message[4] >= DirectionCount)
+			{
+				throw std::runtime_error("Lockstep input out of range from player " + std::to_string(p));
+			}
+			inputs[Slot(int(t)) + p] = Direction(message[4]);
+			haveInput[Slot(int(t)) + p] = 1;
+			if (message.size() == HashedInputMessage)
+			{
+				uint32_t hash = 0u;
+				for (int b = 0; b < 4; ++b)
+				{
+					hash |= uint32_t(message[5 + b]) << (8 * b);
+				}
+				CheckHash(int(t) - inputDelay, p, hash);
+			}
+		}
+	}
+}
+
+void LockstepSession::CheckHash(int h, int player, uint32_t hash)
+{
+	const int slot = Slot(h);
+	hashTick[slot + player] = h;
+	hashes[slot + player] = hash;
+	for (int p = 0; p < nPlayers; ++p)
+	{
+		// ours goes against every peer's, a peer's against ours
+		const bool compare = player == localPlayer ? p != localPlayer : p == localPlayer;
+		if (compare && hashTick[slot + p] == h && hashes[slot + p] != hash)
+		{
+			throw std::runtime_error("Lockstep desync at tick " + std::to_string(h) + " with player " +
+				std::to_string(player == localPlayer ? p : player));
+		}
+	}
+}
+
+int LockstepSession::Slot(int t) const
+{
+	return (t % window) * nPlayers;
+}
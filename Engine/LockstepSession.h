@@ -0,0 +1,61 @@
+#pragma once
+#include "Arena.h"
+#include "Direction.h"
+#include "Transport.h"
+#include <cstdint>
+#include <vector>
+
+// Deterministic lockstep over an Arena: every player runs the same simulation
+// and only the inputs travel, player i steering snake i. A direction chosen now
+// is applied inputDelay ticks later, which gives it time to reach the others
+// before anyone needs it; a tick runs once the inputs of all players for it are
+// in, so a late peer stalls everybody instead of the games drifting apart.
+// Message per tick to every peer: the tick the input is for (4 bytes) and the
+// direction (1 byte), plus every HashInterval ticks the hash of the sender's
+// arena as it was when sending. A hash that differs from the local one for the
+// same tick is a desync and is thrown as std::runtime_error.
+class LockstepSession
+{
+public:
+	// peers holds one transport per snake of the arena, nullptr for the local player;
+	// every player's arena has to start out the same, e.g. reset with a shared seed
+	LockstepSession(Arena& arena, int localPlayer, std::vector<Transport*> peers, int inputDelay);
+	// schedules the local input and steps the arena if all inputs for its tick
+	// are in; returns whether it stepped. Call it once per simulation tick.
+	bool Update(Direction input);
+	// ticks stepped so far
+	int GetTick() const;
+	// updates that could not step for lack of remote inputs
+	int GetStallCount() const;
+	// payload bytes sent to all peers together
+	uint64_t GetBytesSent() const;
+private:
+	static constexpr int HashInterval = 8;
+	static constexpr size_t InputMessage = 5;
+	static constexpr size_t HashedInputMessage = 9;
+private:
+	void SendLocalInput(Direction input);
+	void ReceiveInputs();
+	// compares a hash of tick h against the other side's, whichever arrives second
+	void CheckHash(int h, int player, uint32_t hash);
+	int Slot(int t) const;
+private:
+	Arena& arena;
+	int localPlayer;
+	int nPlayers;
+	std::vector<Transport*> peers;
+	int inputDelay;
+	// ring buffers over the ticks in flight, window slots of nPlayers entries
+	int window;
+	std::vector<Direction> inputs;
+	std::vector<uint8_t> haveInput;
+	// per slot and player: the tick whose hash is stored, -1 for none; the local player's entry is ours
+	std::vector<int> hashTick;
+	std::vector<uint32_t> hashes;
+	std::vector<Direction> stepInputs;
+	std::vector<uint8_t> message;
+	int tick = 0;
+	// next tick the local player sends its input for
+	int nextLocal;
+	int stalls = 0;
+};
@@ -0,0 +1,45 @@
+#include "LoopbackTransport.h"
+#include <stdexcept>
+
+std::pair<std::unique_ptr<LoopbackTransport>, std::unique_ptr<LoopbackTransport>> LoopbackTransport::CreatePair(
+	int latencyMicroseconds)
+{
+	auto aToB = std::make_shared<Queue>();
+	auto bToA = std::make_shared<Queue>();
+	return { std::unique_ptr<LoopbackTransport>(new LoopbackTransport(bToA, aToB, latencyMicroseconds)),
+		std::unique_ptr<LoopbackTransport>(new LoopbackTransport(aToB, bToA, latencyMicroseconds)) };
+}
+
+LoopbackTransport::LoopbackTransport(std::shared_ptr<Queue> incoming_in, std::shared_ptr<Queue> outgoing_in,
+	int latencyMicroseconds)
+	:
+	incoming(std::move(incoming_in)),
+	outgoing(std::move(outgoing_in)),
+	latency(latencyMicroseconds)
+{
+}
+
+void LoopbackTransport::Send(const uint8_t* data, size_t size)
+{
+	if (size > MaxMessage)
+	{
+		throw std::runtime_error("Message too long for the transport");
+	}
+	std::lock_guard<std::mutex> lock(outgoing->mutex);
+	outgoing->messages.emplace_back(data, data + size);
+	outgoing->due.push_back(std::chrono::steady_clock::now() + latency);
+	bytesSent += size;
+}
+
+bool LoopbackTransport::Receive(std::vector<uint8_t>& message)
+{
+	std::lock_guard<std::mutex> lock(incoming->mutex);
+	if (incoming->messages.empty() || (latency.count() > 0 && incoming->due.front() > std::chrono::steady_clock::now()))
+	{
+		return false;
+	}
+	message.swap(incoming->messages.front());
+	incoming->messages.pop_front();
+	incoming->due.pop_front();
+	return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include "Transport.h"
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+// Both ends of a connection inside one process, for tests and local matches.
+// The ends may be used from different threads. A latency holds every message
+// back for that long after it was sent, to try out netcode on one machine.
+class LoopbackTransport : public Transport
+{
+public:
+	static std::pair<std::unique_ptr<LoopbackTransport>, std::unique_ptr<LoopbackTransport>> CreatePair(
+		int latencyMicroseconds = 0);
+	void Send(const uint8_t* data, size_t size) override;
+	bool Receive(std::vector<uint8_t>& message) override;
+private:
+	struct Queue
+	{
+		std::mutex mutex;
+		std::deque<std::vector<uint8_t>> messages;
+		// when each message may be received
+		std::deque<std::chrono::steady_clock::time_point> due;
+	};
+private:
+	LoopbackTransport(std::shared_ptr<Queue> incoming, std::shared_ptr<Queue> outgoing, int latencyMicroseconds);
+private:
+	std::shared_ptr<Queue> incoming;
+	std::shared_ptr<Queue> outgoing;
+	std::chrono::microseconds latency;
+};
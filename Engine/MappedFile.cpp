@@ -0,0 +1,114 @@
+#include "MappedFile.h"
+#include "ChiliWin.h"
+#include <stdexcept>
+
+MappedFile::MappedFile(const std::string& filename, Access access)
+{
+	const DWORD desired = access == Access::ReadWrite ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+	file = CreateFileA(filename.c_str(), desired, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		file = nullptr;
+		throw std::runtime_error("Could not open file: " + filename);
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		Close();
+		throw std::runtime_error("Could not read the size of file: " + filename);
+	}
+	size = uint64_t(fileSize.QuadPart);
+	Map(filename, access);
+}
+
+MappedFile::MappedFile(const std::string& filename, uint64_t size_in)
+	:
+	size(size_in)
+{
+	file = CreateFileA(filename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+		OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		file = nullptr;
+		throw std::runtime_error("Could not create file: " + filename);
+	}
+	LARGE_INTEGER end;
+	end.QuadPart = LONGLONG(size);
+	if (!SetFilePointerEx(file, end, nullptr, FILE_BEGIN) || !SetEndOfFile(file))
+	{
+		Close();
+		throw std::runtime_error("Could not resize file: " + filename);
+	}
+	Map(filename, Access::ReadWrite);
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+uint8_t* MappedFile::GetData()
+{
+	return view;
+}
+
+const uint8_t* MappedFile::GetData() const
+{
+	return view;
+}
+
+uint64_t MappedFile::GetSize() const
+{
+	return size;
+}
+
+void MappedFile::Flush()
+{
+	if (view && writable)
+	{
+		FlushViewOfFile(view, 0);
+		FlushFileBuffers(file);
+	}
+}
+
+void MappedFile::Map(const std::string& filename, Access access)
+{
+	writable = access == Access::ReadWrite;
+	if (size == 0u)
+	{
+		// an empty file cannot be mapped, and has nothing to map anyway
+		return;
+	}
+	mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping)
+	{
+		Close();
+		throw std::runtime_error("Could not map file: " + filename);
+	}
+	view = static_cast<uint8_t*>(MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0));
+	if (!view)
+	{
+		Close();
+		throw std::runtime_error("Could not map file: " + filename);
+	}
+}
+
+void MappedFile::Close()
+{
+	if (view)
+	{
+		UnmapViewOfFile(view);
+		view = nullptr;
+	}
+	if (mapping)
+	{
+		CloseHandle(mapping);
+		mapping = nullptr;
+	}
+	if (file)
+	{
+		CloseHandle(file);
+		file = nullptr;
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// A whole file mapped into memory. Pages are read in on first touch and written
+// back by the OS, so files far bigger than RAM open instantly and cost only the
+// pages actually used.
+class MappedFile
+{
+public:
+	enum class Access
+	{
+		Read,
+		ReadWrite
+	};
+public:
+	// maps an existing file
+	MappedFile(const std::string& filename, Access access);
+	// creates the file, or resizes an existing one, to size bytes and maps it for writing
+	MappedFile(const std::string& filename, uint64_t size);
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	uint8_t* GetData();
+	const uint8_t* GetData() const;
+	uint64_t GetSize() const;
+	// writes dirty pages back to the file now rather than whenever the OS gets round to it
+	void Flush();
+private:
+	void Map(const std::string& filename, Access access);
+	void Close();
+private:
+	void* file = nullptr;
+	void* mapping = nullptr;
+	uint8_t* view = nullptr;
+	uint64_t size = 0u;
+	bool writable = false;
+};
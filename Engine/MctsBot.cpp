@@ -0,0 +1,257 @@
+#include "MctsBot.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+MctsBot::MctsBot(const Board&, const MctsSettings& settings_in)
+	:
+	settings(settings_in),
+	arena(settings_in.arenaBytes),
+	pool(settings_in.threads)
+{
+	settings.threads = pool.GetThreadCount();
+}
+
+Direction MctsBot::Decide(const GameState& state, const Board& brd)
+{
+	arena.Reset();
+	nodeCount = 1;
+	Node* const root = arena.New<Node>();
+	root->action = ToDirection(state.snake.GetDirection());
+	remaining = settings.iterations;
+
+	// one search per thread, the calling thread's included
+	pool.ParallelFor(settings.threads, [&](int thread)
+	{
+		Search(state, brd, root, thread);
+	});
+	++decisions;
+	lastNodeCount = nodeCount;
+
+	// the most visited move is the one the search trusts most
+	Direction best = root->action;
+	int bestVisits = -1;
+	Node* const children = root->children.load(std::memory_order_acquire);
+	const int childCount = root->expansion.load(std::memory_order_acquire) == 2 ? root->childCount : 0;
+	for (int i = 0; i < childCount; ++i)
+	{
+		const int visits = children[i].visits.load(std::memory_order_relaxed);
+		if (visits > bestVisits)
+		{
+			best = children[i].action;
+			bestVisits = visits;
+		}
+	}
+	return best;
+}
+
+const char* MctsBot::GetName() const
+{
+	return "mcts";
+}
+
+int MctsBot::GetLastNodeCount() const
+{
+	return lastNodeCount;
+}
+
+void MctsBot::Search(const GameState& rootState, const Board& brd, Node* root, int thread)
+{
+	Rng rng(settings.seed ^ (decisions << 8) ^ uint64_t(thread));
+	GameState state;
+	Node* path[MaxDepth + 1];
+	while (remaining.fetch_sub(1, std::memory_order_relaxed) > 0)
+	{
+		state = rootState;
+		int depth = 0;
+		path[0] = root;
+		root->visits.fetch_add(1, std::memory_order_relaxed);
+		float food = 0.0f;
+		float discount = 1.0f;
+
+		// down the tree, then one step into a fresh node
+		Node* node = root;
+		bool leaf = false;
+		while (!leaf && !state.GameOver && depth < MaxDepth)
+		{
+			if (node->expansion.load(std::memory_order_acquire) != 2)
+			{
+				// a node only gets children once a few playouts went through it,
+				// so a young tree is steered by playouts rather than by untried moves
+				if (node != root && node->visits.load(std::memory_order_relaxed) < ExpandVisits)
+				{
+					break;
+				}
+				Expand(node, state);
+				leaf = true;
+				if (node->expansion.load(std::memory_order_acquire) != 2)
+				{
+					// another thread is expanding it, play out from here
+					break;
+				}
+			}
+			node = SelectChild(node);
+			node->visits.fetch_add(1, std::memory_order_relaxed);
+			path[++depth] = node;
+			discount *= FoodDiscount;
+			if (Apply(state, brd, node->action))
+			{
+				food += discount;
+			}
+		}
+
+		// playout
+		for (int m = 0; m < settings.horizon && !state.GameOver; ++m)
+		{
+			discount *= FoodDiscount;
+			if (Apply(state, brd, PlayoutMove(state, brd, rng)))
+			{
+				food += discount;
+			}
+		}
+
+		if (!state.GameOver)
+		{
+			// a little for ending up near the food, so there is a pull towards food the horizon cannot reach
+			const Location head = state.snake.GetSegment(0);
+			const Location target = state.food.GetLocation();
+			const int dist = brd.GetDistance(head, target);
+			food += ProximityWeight * (1.0f - float(dist) / (brd.GetWidth() + brd.GetHeight()));
+		}
+		// squashed rather than capped, so sooner food still scores higher when there is plenty of it
+		const float reward = (state.GameOver ? 0.0f : 0.5f) + 0.5f * food / (1.0f + food);
+		for (int i = 0; i <= depth; ++i)
+		{
+			AddReward(path[i], reward);
+		}
+	}
+}
+
+MctsBot::Node* MctsBot::SelectChild(Node* node) const
+{
+	Node* const children = node->children.load(std::memory_order_acquire);
+	const float logParent = std::log(float(std::max(1, node->visits.load(std::memory_order_relaxed))));
+	Node* best = &children[0];
+	float bestScore = -1.0f;
+	for (int i = 0; i < node->childCount; ++i)
+	{
+		Node* const child = &children[i];
+		const int visits = child->visits.load(std::memory_order_relaxed);
+		if (visits == 0)
+		{
+			// untried moves first
+			return child;
+		}
+		// a visit still in flight counts with no reward yet, which is the virtual loss
+		const float mean = child->reward.load(std::memory_order_relaxed) / visits;
+		const float score = mean + settings.exploration * std::sqrt(logParent / visits);
+		if (score > bestScore)
+		{
+			best = child;
+			bestScore = score;
+		}
+	}
+	return best;
+}
+
+void MctsBot::Expand(Node* node, const GameState& state)
+{
+	int expected = 0;
+	if (!node->expansion.compare_exchange_strong(expected, 1, std::memory_order_acq_rel))
+	{
+		return;
+	}
+	// every turn but the reversal, which Snake::Steer would ignore anyway
+	const Direction current = ToDirection(state.snake.GetDirection());
+	Node* const children = arena.NewArray<Node>(DirectionCount - 1);
+	if (!children)
+	{
+		// arena full: the node stays a leaf for good
+		return;
+	}
+	int count = 0;
+	for (int i = 0; i < DirectionCount; ++i)
+	{
+		if (Direction(i) != Opposite(current))
+		{
+			children[count++].action = Direction(i);
+		}
+	}
+	nodeCount.fetch_add(count, std::memory_order_relaxed);
+	node->childCount = count;
+	node->children.store(children, std::memory_order_relaxed);
+	node->expansion.store(2, std::memory_order_release);
+}
+
+bool MctsBot::Apply(GameState& state, const Board& brd, Direction dir)
+{
+	const int length = state.snake.GetLength();
+	state.snake.Steer(ToDelta(dir));
+	Simulation::Step(state, brd);
+	return state.snake.GetLength() > length;
+}
+
+Direction MctsBot::PlayoutMove(GameState& state, const Board& brd, Rng& rng) const
+{
+	Snake& snake = state.snake;
+	const Location current = snake.GetDirection();
+	const Direction forward = ToDirection(current);
+	Direction options[DirectionCount - 1];
+	int count = 0;
+	for (int i = 0; i < DirectionCount; ++i)
+	{
+		if (Direction(i) != Opposite(forward))
+		{
+			options[count++] = Direction(i);
+		}
+	}
+	if (settings.playout == MctsSettings::Random)
+	{
+		return options[rng.Range(0, count - 1)];
+	}
+
+	// keep the moves the game-over rule lets through
+	Direction safe[DirectionCount - 1];
+	int safeCount = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		snake.SetDirection(ToDelta(options[i]));
+		if (!Simulation::CheckForGameOver(snake, brd))
+		{
+			safe[safeCount++] = options[i];
+		}
+	}
+	snake.SetDirection(current);
+	if (safeCount == 0)
+	{
+		return forward;
+	}
+	if (rng.Range(0, 3) == 0)
+	{
+		return safe[rng.Range(0, safeCount - 1)];
+	}
+	const Location head = snake.GetSegment(0);
+	const Location food = state.food.GetLocation();
+	Direction best = safe[0];
+	int bestDist = INT_MAX;
+	for (int i = 0; i < safeCount; ++i)
+	{
+		const Location next = brd.Wrap(head.Add(ToDelta(safe[i])));
+		const int dist = brd.GetDistance(next, food);
+		if (dist < bestDist)
+		{
+			best = safe[i];
+			bestDist = dist;
+		}
+	}
+	return best;
+}
+
+void MctsBot::AddReward(Node* node, float reward)
+{
+	float old = node->reward.load(std::memory_order_relaxed);
+	while (!node->reward.compare_exchange_weak(old, old + reward, std::memory_order_relaxed))
+	{
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "Bot.h"
+#include "BumpArena.h"
+#include "Rng.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstdint>
+
+struct MctsSettings
+{
+	enum Playout
+	{
+		// uniformly random moves, deaths included
+		Random,
+		// safe moves only, mostly the one closest to the food
+		Heuristic
+	};
+	// playouts per decision, shared by all threads
+	int iterations = 2000;
+	// 0 = one per hardware thread
+	int threads = 0;
+	// moves per playout beyond the tree
+	int horizon = 20;
+	Playout playout = Heuristic;
+	float exploration = 0.5f;
+	uint64_t seed = 1u;
+	size_t arenaBytes = size_t(8) << 20;
+};
+
+// Monte Carlo tree search over the moves of the snake. Every iteration copies
+// the game, replays the moves down the tree and plays out a few more, all with
+// Simulation::Step, so the search runs on the same rules as the game. The
+// game is deterministic from a given state (the food generator is part of
+// it), so nodes hold only statistics and never a copy of the game.
+// Several threads search the same tree. A thread passing through a node counts
+// a visit straight away but adds its reward only at the end (virtual loss),
+// which steers the other threads towards different branches meanwhile.
+// Nodes live in a bump arena that is reset at the start of every decision,
+// and the threads are the bot's own pool, started once with the bot.
+class MctsBot : public Bot
+{
+public:
+	MctsBot(const Board& brd, const MctsSettings& settings = MctsSettings());
+	Direction Decide(const GameState& state, const Board& brd) override;
+	const char* GetName() const override;
+	// tree size of the last decision
+	int GetLastNodeCount() const;
+private:
+	struct Node
+	{
+		std::atomic<int> visits{ 0 };
+		std::atomic<float> reward{ 0.0f };
+		std::atomic<Node*> children{ nullptr };
+		// 0 = leaf, 1 = being expanded by some thread, 2 = children published
+		std::atomic<int> expansion{ 0 };
+		int childCount = 0;
+		Direction action = Direction::Up;
+	};
+	// visits a node takes before it is expanded
+	static constexpr int ExpandVisits = 8;
+	// longest path through the tree that a thread keeps track of
+	static constexpr int MaxDepth = 256;
+	// playout reward for each food, discounted per move it takes to get there
+	static constexpr float FoodDiscount = 0.95f;
+	// share of a food reward for ending a playout next to the food
+	static constexpr float ProximityWeight = 0.2f;
+private:
+	void Search(const GameState& rootState, const Board& brd, Node* root, int thread);
+	Node* SelectChild(Node* node) const;
+	void Expand(Node* node, const GameState& state);
+	// moves on to the next decision; returns whether the move ate food
+	static bool Apply(GameState& state, const Board& brd, Direction dir);
+	Direction PlayoutMove(GameState& state, const Board& brd, Rng& rng) const;
+	static void AddReward(Node* node, float reward);
+private:
+	MctsSettings settings;
+	BumpArena arena;
+	ThreadPool pool;
+	std::atomic<int> remaining{ 0 };
+	std::atomic<int> nodeCount{ 0 };
+	uint64_t decisions = 0u;
+	int lastNodeCount = 0;
+};
@@ -0,0 +1,304 @@
+#include "ObservationEncoder.h"
+#include <algorithm>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace
+{
+	// copies a finished game out with non-temporal stores: the output is far
+	// bigger than the caches and is not read again here, so skip loading it
+	void StreamCopy(void* dst, const void* src, size_t bytes)
+	{
+		uint8_t* d = static_cast<uint8_t*>(dst);
+		const uint8_t* s = static_cast<const uint8_t*>(src);
+		const size_t head = std::min(bytes, size_t((16u - (uintptr_t(d) & 15u)) & 15u));
+		std::memcpy(d, s, head);
+		d += head;
+		s += head;
+		bytes -= head;
+		for (; bytes >= 16u; bytes -= 16u, d += 16, s += 16)
+		{
+			_mm_stream_si128(reinterpret_cast<__m128i*>(d), _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+		}
+		std::memcpy(d, s, bytes);
+	}
+
+	// the 16 mask bits of cells cell..cell + 15, cell a multiple of 16
+	inline unsigned Bits16(const uint64_t* mask, int cell)
+	{
+		return unsigned(mask[cell >> 6] >> (cell & 63)) & 0xFFFFu;
+	}
+
+	// 0xFF in each byte lane whose bit is set: broadcast the 16 bits and pick one per lane
+	inline __m128i Expand16(unsigned bits)
+	{
+		const __m128i bitSelect = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+		const __m128i lanes = _mm_unpacklo_epi64(_mm_set1_epi8(char(bits)), _mm_set1_epi8(char(bits >> 8)));
+		return _mm_cmpeq_epi8(_mm_and_si128(lanes, bitSelect), bitSelect);
+	}
+
+	// the 4 mask bits of cells cell..cell + 3, cell a multiple of 4
+	inline int Bits4(const uint64_t* mask, int cell)
+	{
+		return int(mask[cell >> 6] >> (cell & 63)) & 0xF;
+	}
+
+	// all ones in each 32-bit lane whose bit is set
+	inline __m128i Expand4(int bits)
+	{
+		const __m128i bitSelect = _mm_setr_epi32(1, 2, 4, 8);
+		return _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(bits), bitSelect), bitSelect);
+	}
+
+	inline bool TestBit(const uint64_t* mask, int cell)
+	{
+		return ((mask[cell >> 6] >> (cell & 63)) & 1u) != 0u;
+	}
+
+	inline void SetBit(uint64_t* mask, int cell)
+	{
+		mask[cell >> 6] |= uint64_t(1) << (cell & 63);
+	}
+}
+
+ObservationEncoder::ObservationEncoder(const Board& brd)
+	:
+	width(brd.GetWidth()),
+	height(brd.GetHeight()),
+	wordsPerMask((brd.GetWidth() * brd.GetHeight() + 63) / 64),
+	wallBits((size_t(brd.GetWidth()) * brd.GetHeight() + 63) / 64)
+{
+	for (int y = 0; y < height; ++y)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			if (brd.IsWall({ x,y }))
+			{
+				SetBit(wallBits.data(), y * width + x);
+			}
+		}
+	}
+}
+
+int ObservationEncoder::GetPlaneSize() const
+{
+	return width * height;
+}
+
+size_t ObservationEncoder::GetGameSize() const
+{
+	return size_t(PlaneCount) * GetPlaneSize();
+}
+
+void ObservationEncoder::Encode(const GameState* games, int nGames, uint8_t* out) const
+{
+	EncodeGames(games, nGames, out);
+}
+
+void ObservationEncoder::Encode(const GameState* games, int nGames, float* out) const
+{
+	EncodeGames(games, nGames, out);
+}
+
+template<typename T>
+void ObservationEncoder::EncodeGames(const GameState* games, int nGames, T* out) const
+{
+	// each game is expanded into a small cache-resident scratch buffer and then
+	// streamed out; both buffers live on the stack unless the board is large,
+	// since the simulation server encodes from several threads at once
+	constexpr size_t StackScratchBytes = 16384u;
+	alignas(16) uint8_t stackScratch[StackScratchBytes];
+	std::vector<T> heapScratch;
+	const size_t gameBytes = sizeof(T) * GetGameSize();
+	T* scratch = reinterpret_cast<T*>(stackScratch);
+	if (gameBytes > StackScratchBytes)
+	{
+		heapScratch.resize(GetGameSize());
+		scratch = heapScratch.data();
+	}
+	constexpr int StackMaskWords = 256;
+	uint64_t stackMasks[StackMaskWords];
+	std::vector<uint64_t> heapMasks;
+	uint64_t* masks = stackMasks;
+	if (MaskCount * wordsPerMask > StackMaskWords)
+	{
+		heapMasks.resize(size_t(MaskCount) * wordsPerMask);
+		masks = heapMasks.data();
+	}
+
+	// the walls are the same for every game, the other planes are all rewritten per game
+	ExpandWalls(scratch + WallPlane * GetPlaneSize());
+	for (int g = 0; g < nGames; ++g, out += GetGameSize())
+	{
+		FillMasks(games[g], masks);
+		ExpandPlanes(masks, scratch);
+		StreamCopy(out, scratch, gameBytes);
+	}
+	_mm_sfence();
+}
+
+void ObservationEncoder::FillMasks(const GameState& game, uint64_t* masks) const
+{
+	std::fill_n(masks, MaskCount * wordsPerMask, uint64_t(0));
+	const Snake& snake = game.snake;
+	const int length = snake.GetLength();
+	const Location head = snake.GetSegment(0);
+	SetBit(masks + HeadMask * wordsPerMask, head.y * width + head.x);
+	const Location food = game.food.GetLocation();
+	SetBit(masks + FoodMask * wordsPerMask, food.y * width + food.x);
+
+	// AgeLevels next to the head down to about AgeLevels / (length - 1) at the
+	// tail, with the scale in 16.16 fixed point; levels are rounded up, so no
+	// body cell is left at 0
+	const int scale = length > 1 ? (AgeLevels << 16) / (length - 1) : 0;
+	uint64_t* const age = masks + AgeMask * wordsPerMask;
+	Location prev = head;
+	for (int i = 1; i < length; ++i)
+	{
+		const Location seg = snake.GetSegment(i);
+		// right after growing, the last segments share a cell; the youngest one sets its level
+		if (i > 1 && seg == prev)
+		{
+			continue;
+		}
+		prev = seg;
+		const int cell = seg.y * width + seg.x;
+		const int level = ((length - i) * scale + 0xFFFF) >> 16;
+		const uint64_t bit = uint64_t(1) << (cell & 63);
+		for (int k = 0; k < AgeBits; ++k)
+		{
+			age[k * wordsPerMask + (cell >> 6)] |= bit & (uint64_t(0) - uint64_t((level >> k) & 1));
+		}
+	}
+}
+
+void ObservationEncoder::ExpandPlanes(const uint64_t* masks, uint8_t* game) const
+{
+	const int cells = GetPlaneSize();
+	uint8_t* const pHead = game + HeadPlane * cells;
+	uint8_t* const pBody = game + BodyPlane * cells;
+	uint8_t* const pFood = game + FoodPlane * cells;
+	const uint64_t* const head = masks + HeadMask * wordsPerMask;
+	const uint64_t* const food = masks + FoodMask * wordsPerMask;
+	const uint64_t* const age = masks + AgeMask * wordsPerMask;
+	const __m128i zero = _mm_setzero_si128();
+	// most of the board is empty in every plane, and an empty run of 16 cells
+	// costs a single store. Age bit k is worth 17 << k: the levels 1..15 come
+	// out as 17..255, and as the four values share no bits, or-ing them adds them up
+	int i = 0;
+	for (; i + 16 <= cells; i += 16)
+	{
+		const unsigned headBits = Bits16(head, i);
+		const unsigned foodBits = Bits16(food, i);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pHead + i), headBits ? Expand16(headBits) : zero);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pFood + i), foodBits ? Expand16(foodBits) : zero);
+		unsigned ageBits[AgeBits];
+		unsigned anyAge = 0u;
+		for (int k = 0; k < AgeBits; ++k)
+		{
+			ageBits[k] = Bits16(age + k * wordsPerMask, i);
+			anyAge |= ageBits[k];
+		}
+		__m128i body = zero;
+		if (anyAge)
+		{
+			for (int k = 0; k < AgeBits; ++k)
+			{
+				const __m128i weight = _mm_set1_epi8(char(17 << k));
+				body = _mm_or_si128(body, _mm_and_si128(Expand16(ageBits[k]), weight));
+			}
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pBody + i), body);
+	}
+	for (; i < cells; ++i)
+	{
+		pHead[i] = TestBit(head, i) ? 255u : 0u;
+		pFood[i] = TestBit(food, i) ? 255u : 0u;
+		int level = 0;
+		for (int k = 0; k < AgeBits; ++k)
+		{
+			level |= int(TestBit(age + k * wordsPerMask, i)) << k;
+		}
+		pBody[i] = uint8_t(level * 17);
+	}
+}
+
+void ObservationEncoder::ExpandPlanes(const uint64_t* masks, float* game) const
+{
+	const int cells = GetPlaneSize();
+	float* const pHead = game + HeadPlane * cells;
+	float* const pBody = game + BodyPlane * cells;
+	float* const pFood = game + FoodPlane * cells;
+	const uint64_t* const head = masks + HeadMask * wordsPerMask;
+	const uint64_t* const food = masks + FoodMask * wordsPerMask;
+	const uint64_t* const age = masks + AgeMask * wordsPerMask;
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 levels = _mm_set1_ps(float(AgeLevels));
+	int i = 0;
+	for (; i + 4 <= cells; i += 4)
+	{
+		const int headBits = Bits4(head, i);
+		const int foodBits = Bits4(food, i);
+		_mm_storeu_ps(pHead + i, headBits ? _mm_and_ps(_mm_castsi128_ps(Expand4(headBits)), one) : zero);
+		_mm_storeu_ps(pFood + i, foodBits ? _mm_and_ps(_mm_castsi128_ps(Expand4(foodBits)), one) : zero);
+		int ageBits[AgeBits];
+		int anyAge = 0;
+		for (int k = 0; k < AgeBits; ++k)
+		{
+			ageBits[k] = Bits4(age + k * wordsPerMask, i);
+			anyAge |= ageBits[k];
+		}
+		__m128 body = zero;
+		if (anyAge)
+		{
+			__m128i level = _mm_setzero_si128();
+			for (int k = 0; k < AgeBits; ++k)
+			{
+				level = _mm_or_si128(level, _mm_and_si128(Expand4(ageBits[k]), _mm_set1_epi32(1 << k)));
+			}
+			body = _mm_div_ps(_mm_cvtepi32_ps(level), levels);
+		}
+		_mm_storeu_ps(pBody + i, body);
+	}
+	for (; i < cells; ++i)
+	{
+		pHead[i] = TestBit(head, i) ? 1.0f : 0.0f;
+		pFood[i] = TestBit(food, i) ? 1.0f : 0.0f;
+		int level = 0;
+		for (int k = 0; k < AgeBits; ++k)
+		{
+			level |= int(TestBit(age + k * wordsPerMask, i)) << k;
+		}
+		pBody[i] = float(level) / AgeLevels;
+	}
+}
+
+void ObservationEncoder::ExpandWalls(uint8_t* plane) const
+{
+	const int cells = GetPlaneSize();
+	int i = 0;
+	for (; i + 16 <= cells; i += 16)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(plane + i), Expand16(Bits16(wallBits.data(), i)));
+	}
+	for (; i < cells; ++i)
+	{
+		plane[i] = TestBit(wallBits.data(), i) ? 255u : 0u;
+	}
+}
+
+void ObservationEncoder::ExpandWalls(float* plane) const
+{
+	const __m128 one = _mm_set1_ps(1.0f);
+	const int cells = GetPlaneSize();
+	int i = 0;
+	for (; i + 4 <= cells; i += 4)
+	{
+		_mm_storeu_ps(plane + i, _mm_and_ps(_mm_castsi128_ps(Expand4(Bits4(wallBits.data(), i))), one));
+	}
+	for (; i < cells; ++i)
+	{
+		plane[i] = TestBit(wallBits.data(), i) ? 1.0f : 0.0f;
+	}
+}
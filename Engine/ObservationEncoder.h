@@ -0,0 +1,64 @@
+#pragma once
+#include "Board.h"
+#include "GameState.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Writes the board state of many games straight into caller-owned tensors in
+// NCHW layout: N games x PlaneCount planes x height x width. Everything is read
+// from the GameStates themselves (snake body, food) and the board's walls,
+// never from rendered pixels. uint8 planes hold 0..255, float planes 0..1.
+// Each game is first reduced to occupancy bitmasks, one bit per cell, which
+// are then expanded into all planes with SSE2, 16 cells (uint8) or 4 cells
+// (float) per step.
+class ObservationEncoder
+{
+public:
+	enum Plane
+	{
+		HeadPlane,
+		// body segments, brightest next to the head and fading towards the tail
+		// in AgeLevels steps
+		BodyPlane,
+		FoodPlane,
+		WallPlane,
+		PlaneCount
+	};
+public:
+	ObservationEncoder(const Board& brd);
+	int GetPlaneSize() const;
+	// elements per game, i.e. PlaneCount * height * width
+	size_t GetGameSize() const;
+	void Encode(const GameState* games, int nGames, uint8_t* out) const;
+	void Encode(const GameState* games, int nGames, float* out) const;
+public:
+	// the body's age is held in AgeBits bit masks, so it comes in AgeLevels steps
+	static constexpr int AgeBits = 4;
+	static constexpr int AgeLevels = (1 << AgeBits) - 1;
+private:
+	// the masks of one game, each wordsPerMask words
+	enum Mask
+	{
+		HeadMask,
+		FoodMask,
+		// AgeBits masks, bit k of each body cell's age level
+		AgeMask,
+		MaskCount = AgeMask + AgeBits
+	};
+private:
+	template<typename T>
+	void EncodeGames(const GameState* games, int nGames, T* out) const;
+	void FillMasks(const GameState& game, uint64_t* masks) const;
+	// the head, body and food planes
+	void ExpandPlanes(const uint64_t* masks, uint8_t* game) const;
+	void ExpandPlanes(const uint64_t* masks, float* game) const;
+	void ExpandWalls(uint8_t* plane) const;
+	void ExpandWalls(float* plane) const;
+private:
+	int width;
+	int height;
+	int wordsPerMask;
+	// one bit per cell in plane order (bit y * width + x), padded to whole 64-bit words
+	std::vector<uint64_t> wallBits;
+};
@@ -0,0 +1,146 @@
+#include "PerfOverlay.h"
+#include "AllocationCounter.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+	// 3x5 pixel font, one row of three bits per 3-bit group, top row first
+	struct Glyph
+	{
+		char ch;
+		unsigned short rows;
+	};
+
+	constexpr unsigned short Rows(int r0, int r1, int r2, int r3, int r4)
+	{
+		return static_cast<unsigned short>((r0 << 12) | (r1 << 9) | (r2 << 6) | (r3 << 3) | r4);
+	}
+
+	const Glyph glyphs[] =
+	{
+		{ '0',Rows(07,05,05,05,07) },{ '1',Rows(02,06,02,02,07) },{ '2',Rows(07,01,07,04,07) },
+		{ '3',Rows(07,01,07,01,07) },{ '4',Rows(05,05,07,01,01) },{ '5',Rows(07,04,07,01,07) },
+		{ '6',Rows(07,04,07,05,07) },{ '7',Rows(07,01,01,01,01) },{ '8',Rows(07,05,07,05,07) },
+		{ '9',Rows(07,05,07,01,07) },{ '.',Rows(00,00,00,00,02) },{ ':',Rows(00,02,00,02,00) },
+		{ '/',Rows(01,01,02,04,04) },{ '-',Rows(00,00,07,00,00) },{ 'A',Rows(02,05,07,05,05) },
+		{ 'C',Rows(07,04,04,04,07) },{ 'E',Rows(07,04,07,04,07) },{ 'F',Rows(07,04,07,04,04) },
+		{ 'G',Rows(07,04,05,05,07) },{ 'H',Rows(05,05,07,05,05) },{ 'I',Rows(07,02,02,02,07) },
+		{ 'K',Rows(05,05,06,05,05) },{ 'L',Rows(04,04,04,04,07) },{ 'M',Rows(05,07,07,05,05) },
+		{ 'N',Rows(06,05,05,05,05) },{ 'O',Rows(07,05,05,05,07) },{ 'P',Rows(07,05,07,04,04) },
+		{ 'R',Rows(06,05,06,05,05) },{ 'S',Rows(07,04,07,01,07) },{ 'T',Rows(07,02,02,02,02) },
+		{ 'U',Rows(05,05,05,05,07) }
+	};
+}
+
+PerfOverlay::PerfOverlay()
+	:
+	lastAllocations(AllocationCounter::GetCount())
+{}
+
+void PerfOverlay::Toggle()
+{
+	visible = !visible;
+}
+
+bool PerfOverlay::IsVisible() const
+{
+	return visible;
+}
+
+void PerfOverlay::Update(int ticks, int snakeLength)
+{
+	const uint64_t now = Profiler::ReadCycles();
+	if (lastFrameCycles != 0u)
+	{
+		const float ms = float(Profiler::CyclesToMs(now - lastFrameCycles));
+		newest = (newest + 1) % GraphFrames;
+		frameMs[newest] = ms;
+		secondMs += ms;
+	}
+	lastFrameCycles = now;
+
+	if (tickScope < 0)
+	{
+		tickScope = Profiler::FindScope("Tick");
+	}
+	tickMs = tickScope < 0 ? 0.0f : float(Profiler::GetLastMs(Profiler::GetCurrentThreadIndex(), tickScope));
+
+	const uint64_t allocations = AllocationCounter::GetCount();
+	allocationsPerFrame = int(allocations - lastAllocations);
+	lastAllocations = allocations;
+
+	ticksThisSecond += ticks;
+	if (secondMs >= 1000.0f)
+	{
+		ticksPerSecond = int(ticksThisSecond * 1000.0f / secondMs + 0.5f);
+		ticksThisSecond = 0;
+		secondMs = 0.0f;
+	}
+	length = snakeLength;
+}
+
+void PerfOverlay::Draw(Graphics& gfx) const
+{
+	PROFILE_SCOPE("Overlay");
+	const int bottom = y0 + GraphHeight;
+	gfx.DrawHollowRect(x0 - 1, y0 - 1, GraphFrames + 1, GraphHeight + 1, Colors::Gray);
+	for (int i = 0; i < GraphFrames; ++i)
+	{
+		// oldest frame on the left, newest on the right
+		const float ms = frameMs[(newest + 1 + i) % GraphFrames];
+		const int h = std::min(GraphHeight, int(ms / GraphMsPerPixel));
+		const Color c = ms <= 17.0f ? Colors::Green : (ms <= 34.0f ? Colors::Yellow : Colors::Red);
+		gfx.DrawRect(x0 + i, bottom - h, x0 + i + 1, bottom, c);
+	}
+	// 60 fps budget line
+	const int budgetY = bottom - int(16.67f / GraphMsPerPixel);
+	for (int x = x0; x < x0 + GraphFrames; x += 4)
+	{
+		gfx.PutPixel(x, budgetY, Colors::White);
+	}
+
+	char text[32];
+	const int col0 = x0 + GraphFrames + 12;
+	const int col1 = col0 + 260;
+	const int line = 7 * GlyphScale;
+	std::snprintf(text, sizeof(text), "FRAME %.2f MS", frameMs[newest]);
+	DrawText(gfx, col0, y0, text, Colors::White);
+	std::snprintf(text, sizeof(text), "TICK %.3f MS", tickMs);
+	DrawText(gfx, col0, y0 + line, text, Colors::White);
+	std::snprintf(text, sizeof(text), "TICKS/S %d", ticksPerSecond);
+	DrawText(gfx, col0, y0 + 2 * line, text, Colors::White);
+	std::snprintf(text, sizeof(text), "LENGTH %d", length);
+	DrawText(gfx, col1, y0, text, Colors::White);
+	std::snprintf(text, sizeof(text), "ALLOCS %d", allocationsPerFrame);
+	DrawText(gfx, col1, y0 + line, text, allocationsPerFrame > 0 ? Colors::Yellow : Colors::White);
+}
+
+void PerfOverlay::DrawText(Graphics& gfx, int x, int y, const char* text, Color c) const
+{
+	for (; *text; ++text, x += 4 * GlyphScale)
+	{
+		DrawGlyph(gfx, x, y, *text, c);
+	}
+}
+
+void PerfOverlay::DrawGlyph(Graphics& gfx, int x, int y, char ch, Color c) const
+{
+	const Glyph* pGlyph = std::find_if(std::begin(glyphs), std::end(glyphs),
+		[ch](const Glyph& g) { return g.ch == ch; });
+	if (pGlyph == std::end(glyphs))
+	{
+		return;
+	}
+	for (int row = 0; row < 5; ++row)
+	{
+		for (int col = 0; col < 3; ++col)
+		{
+			if (pGlyph->rows & (1 << ((4 - row) * 3 + (2 - col))))
+			{
+				gfx.DrawRectDim(x + col * GlyphScale, y + row * GlyphScale, GlyphScale, GlyphScale, c);
+			}
+		}
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "Graphics.h"
+#include <cstdint>
+
+// Toggleable performance HUD drawn into the strip below the board: frame time,
+// tick time, ticks per second, snake length, heap allocations per frame and a
+// scrolling graph of the last GraphFrames frame times. It only does a few
+// thousand pixel writes, so it barely shows up in what it is measuring.
+class PerfOverlay
+{
+public:
+	PerfOverlay();
+	void Toggle();
+	bool IsVisible() const;
+	// call once per frame with the number of simulation ticks run since the last call
+	void Update(int ticks, int snakeLength);
+	void Draw(Graphics& gfx) const;
+private:
+	void DrawText(Graphics& gfx, int x, int y, const char* text, Color c) const;
+	void DrawGlyph(Graphics& gfx, int x, int y, char ch, Color c) const;
+private:
+	static constexpr int GraphFrames = 240;
+	static constexpr int GraphHeight = 44;
+	static constexpr float GraphMsPerPixel = 0.75f;
+	static constexpr int GlyphScale = 2;
+	static constexpr int x0 = 4;
+	static constexpr int y0 = Graphics::ScreenHeight - GraphHeight - 4;
+	bool visible = false;
+	float frameMs[GraphFrames] = {};
+	int newest = 0;
+	uint64_t lastFrameCycles = 0;
+	uint64_t lastAllocations = 0;
+	float tickMs = 0.0f;
+	int allocationsPerFrame = 0;
+	int length = 0;
+	// ticks per second over the last full second
+	int ticksThisSecond = 0;
+	float secondMs = 0.0f;
+	int ticksPerSecond = 0;
+	int tickScope = -1;
+};
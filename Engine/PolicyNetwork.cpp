@@ -0,0 +1,523 @@
+#include "PolicyNetwork.h"
+#include "BinaryIO.h"
+#include "Rng.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <immintrin.h>
+#include <intrin.h>
+#include <stdexcept>
+
+constexpr unsigned int PolicyNetwork::Magic;
+constexpr unsigned int PolicyNetwork::Version;
+
+namespace
+{
+	// sanity limits for weight files, far above anything a snake policy needs
+	constexpr int MaxLayers = 64;
+	constexpr int MaxLayerSize = 1 << 20;
+
+	// The first layer reads board planes, which are almost all zero: each row
+	// lists its non-zero inputs first and only adds up the weights of those.
+	// Later layers are small and dense and go through a plain matrix product.
+
+	template<typename T>
+	int FindNonZeroScalar(const T* in, int count, int* indices)
+	{
+		int n = 0;
+		for (int i = 0; i < count; ++i)
+		{
+			indices[n] = i;
+			n += in[i] != T(0);
+		}
+		return n;
+	}
+
+	void AppendBits(unsigned long mask, int base, int* indices, int& n)
+	{
+		unsigned long bit;
+		while (_BitScanForward(&bit, mask))
+		{
+			indices[n++] = base + int(bit);
+			mask &= mask - 1u;
+		}
+	}
+
+	int FindNonZeroAvx2(const float* in, int count, int* indices)
+	{
+		const __m256 zero = _mm256_setzero_ps();
+		int n = 0;
+		int i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			const unsigned mask = unsigned(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(in + i), zero, _CMP_NEQ_UQ)));
+			AppendBits(mask, i, indices, n);
+		}
+		for (; i < count; ++i)
+		{
+			indices[n] = i;
+			n += in[i] != 0.0f;
+		}
+		return n;
+	}
+
+	int FindNonZeroAvx2(const uint8_t* in, int count, int* indices)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		int n = 0;
+		int i = 0;
+		for (; i + 64 <= count; i += 64)
+		{
+			// one test for 64 inputs, most of which are zero
+			const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+			const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 32));
+			const __m256i any = _mm256_or_si256(lo, hi);
+			if (_mm256_testz_si256(any, any))
+			{
+				continue;
+			}
+			AppendBits(~unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, zero))), i, indices, n);
+			AppendBits(~unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, zero))), i + 32, indices, n);
+		}
+		for (; i + 32 <= count; i += 32)
+		{
+			const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+			const unsigned mask = ~unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, zero)));
+			AppendBits(mask, i, indices, n);
+		}
+		for (; i < count; ++i)
+		{
+			indices[n] = i;
+			n += in[i] != 0u;
+		}
+		return n;
+	}
+
+	template<typename T>
+	void SparseRowScalar(const T* in, const int* indices, int count, float scale, int stride,
+		const float* weights, const float* biases, bool relu, float* out)
+	{
+		std::copy(biases, biases + stride, out);
+		for (int k = 0; k < count; ++k)
+		{
+			const float x = scale * float(in[indices[k]]);
+			const float* w = weights + size_t(indices[k]) * stride;
+			for (int o = 0; o < stride; ++o)
+			{
+				out[o] += x * w[o];
+			}
+		}
+		if (relu)
+		{
+			for (int o = 0; o < stride; ++o)
+			{
+				out[o] = std::max(out[o], 0.0f);
+			}
+		}
+	}
+
+	// 8 * Vectors outputs kept in registers while the listed inputs go by
+	template<int Vectors, typename T>
+	void SparseBlockAvx2(const T* in, const int* indices, int count, float scale, int stride,
+		const float* weights, const float* biases, bool relu, float* out)
+	{
+		__m256 acc[Vectors];
+		for (int v = 0; v < Vectors; ++v)
+		{
+			acc[v] = _mm256_loadu_ps(biases + 8 * v);
+		}
+		for (int k = 0; k < count; ++k)
+		{
+			const __m256 x = _mm256_set1_ps(scale * float(in[indices[k]]));
+			const float* w = weights + size_t(indices[k]) * stride;
+			for (int v = 0; v < Vectors; ++v)
+			{
+				acc[v] = _mm256_fmadd_ps(x, _mm256_loadu_ps(w + 8 * v), acc[v]);
+			}
+		}
+		for (int v = 0; v < Vectors; ++v)
+		{
+			_mm256_storeu_ps(out + 8 * v, relu ? _mm256_max_ps(acc[v], _mm256_setzero_ps()) : acc[v]);
+		}
+	}
+
+	template<typename T>
+	void SparseRowAvx2(const T* in, const int* indices, int count, float scale, int stride,
+		const float* weights, const float* biases, bool relu, float* out)
+	{
+		int o = 0;
+		for (; o + 32 <= stride; o += 32)
+		{
+			SparseBlockAvx2<4>(in, indices, count, scale, stride, weights + o, biases + o, relu, out + o);
+		}
+		for (; o < stride; o += 8)
+		{
+			SparseBlockAvx2<1>(in, indices, count, scale, stride, weights + o, biases + o, relu, out + o);
+		}
+	}
+
+	void DenseScalar(const float* in, int inStride, int nRows, int inputs, int stride,
+		const float* weights, const float* biases, bool relu, float* out)
+	{
+		for (int r = 0; r < nRows; ++r, in += inStride, out += stride)
+		{
+			std::copy(biases, biases + stride, out);
+			const float* w = weights;
+			for (int i = 0; i < inputs; ++i, w += stride)
+			{
+				const float x = in[i];
+				for (int o = 0; o < stride; ++o)
+				{
+					out[o] += x * w[o];
+				}
+			}
+			if (relu)
+			{
+				for (int o = 0; o < stride; ++o)
+				{
+					out[o] = std::max(out[o], 0.0f);
+				}
+			}
+		}
+	}
+
+	// Rows x (8 * Vectors) block of outputs kept in registers while every input streams through once
+	template<int Rows, int Vectors>
+	void DenseBlockAvx2(const float* in, int inStride, int inputs, int stride,
+		const float* weights, const float* biases, bool relu, float* out)
+	{
+		__m256 acc[Rows][Vectors];
+		for (int v = 0; v < Vectors; ++v)
+		{
+			const __m256 b = _mm256_loadu_ps(biases + 8 * v);
+			for (int r = 0; r < Rows; ++r)
+			{
+				acc[r][v] = b;
+			}
+		}
+		const float* w = weights;
+		for (int i = 0; i < inputs; ++i, w += stride)
+		{
+			__m256 wv[Vectors];
+			for (int v = 0; v < Vectors; ++v)
+			{
+				wv[v] = _mm256_loadu_ps(w + 8 * v);
+			}
+			for (int r = 0; r < Rows; ++r)
+			{
+				const __m256 x = _mm256_set1_ps(in[r * inStride + i]);
+				for (int v = 0; v < Vectors; ++v)
+				{
+					acc[r][v] = _mm256_fmadd_ps(x, wv[v], acc[r][v]);
+				}
+			}
+		}
+		const __m256 zero = _mm256_setzero_ps();
+		for (int r = 0; r < Rows; ++r)
+		{
+			for (int v = 0; v < Vectors; ++v)
+			{
+				_mm256_storeu_ps(out + r * stride + 8 * v, relu ? _mm256_max_ps(acc[r][v], zero) : acc[r][v]);
+			}
+		}
+	}
+
+	template<int Rows>
+	void DenseRowsAvx2(const float* in, int inStride, int inputs, int stride,
+		const float* weights, const float* biases, bool relu, float* out)
+	{
+		int o = 0;
+		for (; o + 16 <= stride; o += 16)
+		{
+			DenseBlockAvx2<Rows, 2>(in, inStride, inputs, stride, weights + o, biases + o, relu, out + o);
+		}
+		if (o < stride)
+		{
+			DenseBlockAvx2<Rows, 1>(in, inStride, inputs, stride, weights + o, biases + o, relu, out + o);
+		}
+	}
+
+	template<int RowBlock>
+	void DenseAvx2(const float* in, int inStride, int nRows, int inputs, int stride,
+		const float* weights, const float* biases, bool relu, float* out)
+	{
+		int r = 0;
+		for (; r + RowBlock <= nRows; r += RowBlock)
+		{
+			DenseRowsAvx2<RowBlock>(in + r * inStride, inStride, inputs, stride, weights, biases, relu, out + r * stride);
+		}
+		switch (nRows - r)
+		{
+		case 3:
+			DenseRowsAvx2<3>(in + r * inStride, inStride, inputs, stride, weights, biases, relu, out + r * stride);
+			break;
+		case 2:
+			DenseRowsAvx2<2>(in + r * inStride, inStride, inputs, stride, weights, biases, relu, out + r * stride);
+			break;
+		case 1:
+			DenseRowsAvx2<1>(in + r * inStride, inStride, inputs, stride, weights, biases, relu, out + r * stride);
+			break;
+		}
+	}
+}
+
+PolicyNetwork::PolicyNetwork(const std::vector<int>& sizes, uint64_t seed)
+	:
+	useAvx2(CpuHasAvx2())
+{
+	Build(sizes);
+	// He initialisation, uniform in +-sqrt(6 / inputs); biases stay 0
+	Rng rng(seed);
+	for (Layer& layer : layers)
+	{
+		const float limit = std::sqrt(6.0f / layer.inputs);
+		for (int i = 0; i < layer.inputs; ++i)
+		{
+			for (int o = 0; o < layer.outputs; ++o)
+			{
+				layer.weights[size_t(i) * layer.stride + o] = limit * (2.0f * rng.Next() / 4294967296.0f - 1.0f);
+			}
+		}
+	}
+}
+
+PolicyNetwork::PolicyNetwork(const std::string& filename)
+	:
+	useAvx2(CpuHasAvx2())
+{
+	std::ifstream in(filename, std::ios::binary);
+	if (!in)
+	{
+		throw std::runtime_error("Could not open network file: " + filename);
+	}
+	if (ReadRaw<unsigned int>(in) != Magic || ReadRaw<unsigned int>(in) != Version)
+	{
+		throw std::runtime_error("Not a supported network file: " + filename);
+	}
+	const int layerCount = ReadRaw<int>(in);
+	if (!in || layerCount < 1 || layerCount > MaxLayers)
+	{
+		throw std::runtime_error("Network file is truncated or corrupt: " + filename);
+	}
+	std::vector<int> sizes(layerCount + 1);
+	for (int& size : sizes)
+	{
+		size = ReadRaw<int>(in);
+		if (!in || size < 1 || size > MaxLayerSize)
+		{
+			throw std::runtime_error("Network file is truncated or corrupt: " + filename);
+		}
+	}
+	Build(sizes);
+	std::vector<float> rowMajor;
+	for (Layer& layer : layers)
+	{
+		rowMajor.resize(size_t(layer.outputs) * layer.inputs);
+		in.read(reinterpret_cast<char*>(rowMajor.data()), rowMajor.size() * sizeof(float));
+		in.read(reinterpret_cast<char*>(layer.biases.data()), layer.outputs * sizeof(float));
+		for (int o = 0; o < layer.outputs; ++o)
+		{
+			for (int i = 0; i < layer.inputs; ++i)
+			{
+				layer.weights[size_t(i) * layer.stride + o] = rowMajor[size_t(o) * layer.inputs + i];
+			}
+		}
+	}
+	if (!in)
+	{
+		throw std::runtime_error("Network file is truncated or corrupt: " + filename);
+	}
+}
+
+void PolicyNetwork::Save(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios::binary);
+	if (!out)
+	{
+		throw std::runtime_error("Could not open network file for writing: " + filename);
+	}
+	WriteRaw(out, Magic);
+	WriteRaw(out, Version);
+	WriteRaw(out, int(layers.size()));
+	WriteRaw(out, GetInputSize());
+	for (const Layer& layer : layers)
+	{
+		WriteRaw(out, layer.outputs);
+	}
+	for (const Layer& layer : layers)
+	{
+		for (int o = 0; o < layer.outputs; ++o)
+		{
+			for (int i = 0; i < layer.inputs; ++i)
+			{
+				WriteRaw(out, layer.weights[size_t(i) * layer.stride + o]);
+			}
+		}
+		out.write(reinterpret_cast<const char*>(layer.biases.data()), layer.outputs * sizeof(float));
+	}
+}
+
+int PolicyNetwork::GetInputSize() const
+{
+	return layers.front().inputs;
+}
+
+int PolicyNetwork::GetOutputSize() const
+{
+	return layers.back().outputs;
+}
+
+void PolicyNetwork::Evaluate(const float* inputs, int nRows, float* scores)
+{
+	CopyScores(Forward(inputs, nRows, 1.0f), nRows, scores);
+}
+
+void PolicyNetwork::Evaluate(const uint8_t* inputs, int nRows, float* scores)
+{
+	CopyScores(Forward(inputs, nRows, 1.0f / 255.0f), nRows, scores);
+}
+
+void PolicyNetwork::Act(const float* inputs, int nRows, int* actions)
+{
+	PickActions(Forward(inputs, nRows, 1.0f), nRows, actions);
+}
+
+void PolicyNetwork::Act(const uint8_t* inputs, int nRows, int* actions)
+{
+	PickActions(Forward(inputs, nRows, 1.0f / 255.0f), nRows, actions);
+}
+
+bool PolicyNetwork::IsUsingAvx2() const
+{
+	return useAvx2;
+}
+
+void PolicyNetwork::SetUseAvx2(bool on)
+{
+	useAvx2 = on && CpuHasAvx2();
+}
+
+bool PolicyNetwork::CpuHasAvx2()
+{
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return false;
+	}
+	__cpuid(info, 1);
+	const bool fma = (info[2] & (1 << 12)) != 0;
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx = (info[2] & (1 << 28)) != 0;
+	if (!fma || !osxsave || !avx)
+	{
+		return false;
+	}
+	// the OS has to save the ymm registers on context switches too
+	if ((_xgetbv(0) & 6u) != 6u)
+	{
+		return false;
+	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+}
+
+void PolicyNetwork::Build(const std::vector<int>& sizes)
+{
+	if (sizes.size() < 2)
+	{
+		throw std::runtime_error("A network needs at least an input and an output size");
+	}
+	layers.resize(sizes.size() - 1);
+	for (size_t l = 0; l < layers.size(); ++l)
+	{
+		Layer& layer = layers[l];
+		layer.inputs = sizes[l];
+		layer.outputs = sizes[l + 1];
+		layer.stride = (layer.outputs + 7) & ~7;
+		layer.weights.assign(size_t(layer.inputs) * layer.stride, 0.0f);
+		layer.biases.assign(layer.stride, 0.0f);
+	}
+	nonZero.resize(layers.front().inputs);
+}
+
+void PolicyNetwork::CopyScores(const float* last, int nRows, float* scores) const
+{
+	const int stride = layers.back().stride;
+	const int outputs = GetOutputSize();
+	for (int r = 0; r < nRows; ++r)
+	{
+		std::copy(last + r * stride, last + r * stride + outputs, scores + r * outputs);
+	}
+}
+
+void PolicyNetwork::PickActions(const float* last, int nRows, int* actions) const
+{
+	const int stride = layers.back().stride;
+	const int outputs = GetOutputSize();
+	for (int r = 0; r < nRows; ++r, last += stride)
+	{
+		actions[r] = int(std::max_element(last, last + outputs) - last);
+	}
+}
+
+template<typename T>
+const float* PolicyNetwork::Forward(const T* inputs, int nRows, float scale)
+{
+	// first layer, one row at a time over its non-zero inputs
+	const Layer& first = layers.front();
+	std::vector<float>* out = &activations[0];
+	if (out->size() < size_t(nRows) * first.stride)
+	{
+		out->resize(size_t(nRows) * first.stride);
+	}
+	bool relu = layers.size() > 1;
+	for (int r = 0; r < nRows; ++r)
+	{
+		const T* row = inputs + size_t(r) * first.inputs;
+		float* outRow = out->data() + size_t(r) * first.stride;
+		if (useAvx2)
+		{
+			const int count = FindNonZeroAvx2(row, first.inputs, nonZero.data());
+			SparseRowAvx2(row, nonZero.data(), count, scale, first.stride,
+				first.weights.data(), first.biases.data(), relu, outRow);
+		}
+		else
+		{
+			const int count = FindNonZeroScalar(row, first.inputs, nonZero.data());
+			SparseRowScalar(row, nonZero.data(), count, scale, first.stride,
+				first.weights.data(), first.biases.data(), relu, outRow);
+		}
+	}
+
+	const float* in = out->data();
+	int inStride = first.stride;
+	for (size_t l = 1; l < layers.size(); ++l)
+	{
+		const Layer& layer = layers[l];
+		out = &activations[l & 1];
+		if (out->size() < size_t(nRows) * layer.stride)
+		{
+			out->resize(size_t(nRows) * layer.stride);
+		}
+		relu = l + 1 < layers.size();
+		if (useAvx2)
+		{
+			DenseAvx2<RowBlock>(in, inStride, nRows, layer.inputs, layer.stride,
+				layer.weights.data(), layer.biases.data(), relu, out->data());
+		}
+		else
+		{
+			DenseScalar(in, inStride, nRows, layer.inputs, layer.stride,
+				layer.weights.data(), layer.biases.data(), relu, out->data());
+		}
+		in = out->data();
+		inStride = layer.stride;
+	}
+	if (useAvx2)
+	{
+		// leave no dirty upper halves behind for the SSE code that follows
+		_mm256_zeroupper();
+	}
+	return in;
+}
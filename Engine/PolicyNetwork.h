@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Small dense network (ReLU between layers, raw scores out) evaluated for a
+// whole batch of games per call, e.g. on ObservationEncoder planes with the
+// scores picking the Direction each game steps with in SnakeEnv. uint8 planes
+// are read as value / 255, the same as the encoder's float planes.
+// Weight file, little endian: magic, version, layer count L, then L + 1 layer
+// sizes (inputs first), then per layer its weights as outputs x inputs floats
+// row major, followed by its outputs biases.
+// The layer kernels use AVX2 and FMA when the CPU has them and plain C++
+// otherwise; both give the same scores up to float rounding.
+class PolicyNetwork
+{
+public:
+	// random weights, for benchmarks and as a starting point for training
+	PolicyNetwork(const std::vector<int>& sizes, uint64_t seed);
+	PolicyNetwork(const std::string& filename);
+	void Save(const std::string& filename) const;
+	int GetInputSize() const;
+	int GetOutputSize() const;
+	// inputs: nRows x GetInputSize(), scores: nRows x GetOutputSize()
+	void Evaluate(const float* inputs, int nRows, float* scores);
+	void Evaluate(const uint8_t* inputs, int nRows, float* scores);
+	// the highest scoring output of every row
+	void Act(const float* inputs, int nRows, int* actions);
+	void Act(const uint8_t* inputs, int nRows, int* actions);
+	bool IsUsingAvx2() const;
+	// falls back to the plain kernels, e.g. to compare them; on=true is ignored without CPU support
+	void SetUseAvx2(bool on);
+	static bool CpuHasAvx2();
+private:
+	struct Layer
+	{
+		int inputs;
+		int outputs;
+		// outputs rounded up to whole 8-float vectors, the padding weights and biases are 0
+		int stride;
+		// transposed to inputs x stride, so one input row feeds consecutive outputs
+		std::vector<float> weights;
+		std::vector<float> biases;
+	};
+	static constexpr unsigned int Magic = 0x4E4B4E53; // "SNKN"
+	static constexpr unsigned int Version = 1;
+	// rows of the batch a kernel call works through together
+	static constexpr int RowBlock = 4;
+private:
+	void Build(const std::vector<int>& sizes);
+	// runs all layers; returns the last activations, nRows x the last layer's stride
+	template<typename T>
+	const float* Forward(const T* inputs, int nRows, float scale);
+	void CopyScores(const float* last, int nRows, float* scores) const;
+	void PickActions(const float* last, int nRows, int* actions) const;
+private:
+	std::vector<Layer> layers;
+	// activations ping-pong between these, grown on demand and kept
+	std::vector<float> activations[2];
+	// positions of the non-zero inputs of the row going through the first layer
+	std::vector<int> nonZero;
+	bool useAvx2;
+};
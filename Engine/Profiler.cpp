@@ -0,0 +1,293 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <intrin.h>
+#include <mutex>
+#include <sstream>
+
+namespace
+{
+	struct Frame
+	{
+		uint64_t cycles[Profiler::MaxScopes];
+	};
+
+	struct ThreadData
+	{
+		uint64_t current[Profiler::MaxScopes] = {};
+		Frame frames[Profiler::HistoryFrames] = {};
+		// number of frames ever committed; published with release after the slot is written
+		std::atomic<uint32_t> frameCount{ 0u };
+		int index = 0;
+		char name[32] = {};
+		// span queue, allocated the first time this thread records while tracing
+		std::atomic<Profiler::Span*> spans{ nullptr };
+		std::atomic<uint32_t> spanHead{ 0u };
+		std::atomic<uint32_t> spanTail{ 0u };
+		std::atomic<uint64_t> droppedSpans{ 0u };
+	};
+
+	std::mutex registryMutex;
+	const char* scopeNames[Profiler::MaxScopes] = {};
+	std::atomic<int> scopeCount{ 0 };
+	// thread records are never freed, so readers can hold on to them without locking
+	ThreadData* threads[Profiler::MaxThreads] = {};
+	std::atomic<int> threadCount{ 0 };
+	thread_local ThreadData* pLocal = nullptr;
+	std::atomic<bool> tracing{ false };
+
+	const auto startTime = std::chrono::steady_clock::now();
+	const uint64_t startCycles = __rdtsc();
+
+	void PushSpan(ThreadData& data, const Profiler::Span& span)
+	{
+		Profiler::Span* spans = data.spans.load(std::memory_order_relaxed);
+		if (!spans)
+		{
+			spans = new Profiler::Span[Profiler::SpanQueueSize];
+			data.spans.store(spans, std::memory_order_release);
+		}
+		const uint32_t head = data.spanHead.load(std::memory_order_relaxed);
+		const uint32_t tail = data.spanTail.load(std::memory_order_acquire);
+		if (head - tail >= uint32_t(Profiler::SpanQueueSize))
+		{
+			// consumer is behind; drop rather than stall the thread being measured
+			data.droppedSpans.fetch_add(1u, std::memory_order_relaxed);
+			return;
+		}
+		spans[head % Profiler::SpanQueueSize] = span;
+		data.spanHead.store(head + 1u, std::memory_order_release);
+	}
+
+	ThreadData* GetLocal()
+	{
+		if (!pLocal)
+		{
+			std::lock_guard<std::mutex> lock(registryMutex);
+			const int index = threadCount.load(std::memory_order_relaxed);
+			if (index >= Profiler::MaxThreads)
+			{
+				// out of slots: keep timing into a private record nobody reads
+				static thread_local ThreadData overflow;
+				pLocal = &overflow;
+				return pLocal;
+			}
+			pLocal = new ThreadData;
+			pLocal->index = index;
+			std::snprintf(pLocal->name, sizeof(pLocal->name), "thread %d", index);
+			threads[index] = pLocal;
+			threadCount.store(index + 1, std::memory_order_release);
+		}
+		return pLocal;
+	}
+}
+
+int Profiler::RegisterScope(const char* name)
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+	const int count = scopeCount.load(std::memory_order_relaxed);
+	for (int i = 0; i < count; ++i)
+	{
+		if (std::strcmp(scopeNames[i], name) == 0)
+		{
+			return i;
+		}
+	}
+	if (count == MaxScopes)
+	{
+		// share the last slot rather than write out of bounds
+		return MaxScopes - 1;
+	}
+	scopeNames[count] = name;
+	scopeCount.store(count + 1, std::memory_order_release);
+	return count;
+}
+
+int Profiler::FindScope(const char* name)
+{
+	const int count = GetScopeCount();
+	for (int i = 0; i < count; ++i)
+	{
+		if (std::strcmp(scopeNames[i], name) == 0)
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+int Profiler::GetScopeCount()
+{
+	return scopeCount.load(std::memory_order_acquire);
+}
+
+const char* Profiler::GetScopeName(int scope)
+{
+	return scopeNames[scope];
+}
+
+void Profiler::Record(int scope, uint64_t start, uint64_t end)
+{
+	ThreadData& data = *GetLocal();
+	data.current[scope] += end - start;
+	if (tracing.load(std::memory_order_relaxed))
+	{
+		PushSpan(data, { start,end,scope });
+	}
+}
+
+void Profiler::EndFrame()
+{
+	ThreadData& data = *GetLocal();
+	const uint32_t count = data.frameCount.load(std::memory_order_relaxed);
+	std::memcpy(data.frames[count % HistoryFrames].cycles, data.current, sizeof(data.current));
+	std::memset(data.current, 0, sizeof(data.current));
+	data.frameCount.store(count + 1, std::memory_order_release);
+}
+
+int Profiler::GetThreadCount()
+{
+	return threadCount.load(std::memory_order_acquire);
+}
+
+int Profiler::GetCurrentThreadIndex()
+{
+	return GetLocal()->index;
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	ThreadData& data = *GetLocal();
+	std::lock_guard<std::mutex> lock(registryMutex);
+	std::snprintf(data.name, sizeof(data.name), "%s", name);
+}
+
+std::string Profiler::GetThreadName(int thread)
+{
+	std::lock_guard<std::mutex> lock(registryMutex);
+	return threads[thread]->name;
+}
+
+Profiler::Summary Profiler::Summarize(int thread, int scope)
+{
+	Summary summary;
+	if (thread < 0 || thread >= GetThreadCount() || scope < 0 || scope >= MaxScopes)
+	{
+		return summary;
+	}
+	const ThreadData& data = *threads[thread];
+	const uint32_t count = data.frameCount.load(std::memory_order_acquire);
+	if (count == 0u)
+	{
+		return summary;
+	}
+	// skip the oldest slot, it is the one the owning thread overwrites next
+	const int n = int(std::min<uint32_t>(count, HistoryFrames - 1));
+	uint64_t samples[HistoryFrames];
+	uint64_t total = 0u;
+	for (int i = 0; i < n; ++i)
+	{
+		samples[i] = data.frames[(count - 1u - i) % HistoryFrames].cycles[scope];
+		total += samples[i];
+	}
+	summary.frames = n;
+	summary.last = CyclesToMs(samples[0]);
+	summary.mean = CyclesToMs(total) / n;
+	summary.min = CyclesToMs(*std::min_element(samples, samples + n));
+	uint64_t* p99 = samples + (n * 99) / 100;
+	std::nth_element(samples, p99, samples + n);
+	summary.p99 = CyclesToMs(*p99);
+	return summary;
+}
+
+double Profiler::GetLastMs(int thread, int scope)
+{
+	if (thread < 0 || thread >= GetThreadCount() || scope < 0 || scope >= MaxScopes)
+	{
+		return 0.0;
+	}
+	const ThreadData& data = *threads[thread];
+	const uint32_t count = data.frameCount.load(std::memory_order_acquire);
+	return count == 0u ? 0.0 : CyclesToMs(data.frames[(count - 1u) % HistoryFrames].cycles[scope]);
+}
+
+std::string Profiler::Report(int thread)
+{
+	std::ostringstream out;
+	out.setf(std::ios::fixed);
+	out.precision(3);
+	out << "scope              min ms   mean ms    p99 ms\n";
+	for (int i = 0; i < GetScopeCount(); ++i)
+	{
+		const Summary s = Summarize(thread, i);
+		std::string name = GetScopeName(i);
+		name.resize(16, ' ');
+		out << name << ' ' << s.min << "  " << s.mean << "  " << s.p99 << '\n';
+	}
+	return out.str();
+}
+
+void Profiler::SetTracing(bool enabled)
+{
+	tracing.store(enabled, std::memory_order_relaxed);
+}
+
+bool Profiler::IsTracing()
+{
+	return tracing.load(std::memory_order_relaxed);
+}
+
+int Profiler::DrainSpans(int thread, Span* out, int maxSpans)
+{
+	ThreadData& data = *threads[thread];
+	const Span* spans = data.spans.load(std::memory_order_acquire);
+	if (!spans)
+	{
+		return 0;
+	}
+	const uint32_t tail = data.spanTail.load(std::memory_order_relaxed);
+	const uint32_t head = data.spanHead.load(std::memory_order_acquire);
+	const int n = int(std::min<uint32_t>(head - tail, uint32_t(maxSpans)));
+	for (int i = 0; i < n; ++i)
+	{
+		out[i] = spans[(tail + i) % SpanQueueSize];
+	}
+	data.spanTail.store(tail + n, std::memory_order_release);
+	return n;
+}
+
+uint64_t Profiler::GetDroppedSpans(int thread)
+{
+	return threads[thread]->droppedSpans.load(std::memory_order_relaxed);
+}
+
+uint64_t Profiler::ReadCycles()
+{
+	return __rdtsc();
+}
+
+uint64_t Profiler::GetStartCycles()
+{
+	return startCycles;
+}
+
+double Profiler::CyclesToMs(uint64_t cycles)
+{
+	return double(cycles) / GetCyclesPerMs();
+}
+
+double Profiler::GetCyclesPerMs()
+{
+	// calibrate the tsc against steady_clock over the whole run so far;
+	// the longer the program has been running the better the estimate
+	auto elapsed = std::chrono::steady_clock::now() - startTime;
+	while (elapsed < std::chrono::milliseconds(10))
+	{
+		elapsed = std::chrono::steady_clock::now() - startTime;
+	}
+	const double ms = std::chrono::duration<double, std::milli>(elapsed).count();
+	return double(__rdtsc() - startCycles) / ms;
+}
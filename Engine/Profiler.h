@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Build with CHILI_PROFILER=0 to compile every PROFILE_SCOPE and PROFILE_END_FRAME out.
+#ifndef CHILI_PROFILER
+#define CHILI_PROFILER 1
+#endif
+
+// Low overhead frame profiler. PROFILE_SCOPE times the enclosing block with rdtsc
+// and adds the cycles to the calling thread's running totals; PROFILE_END_FRAME
+// commits those totals as one frame into the thread's ring of the last
+// HistoryFrames frames. Each ring has exactly one writer (its thread), so
+// recording never takes a lock; other threads may read summaries at any time.
+// While tracing is on, every timed scope is also pushed as a span into a bounded
+// per-thread queue for a single consumer (see TraceWriter) to drain.
+class Profiler
+{
+public:
+	static constexpr int MaxScopes = 32;
+	static constexpr int MaxThreads = 64;
+	static constexpr int HistoryFrames = 256;
+	static constexpr int SpanQueueSize = 1 << 15;
+	// all times in milliseconds
+	struct Summary
+	{
+		double min = 0.0;
+		double mean = 0.0;
+		double p99 = 0.0;
+		double last = 0.0;
+		int frames = 0;
+	};
+	struct Span
+	{
+		uint64_t start;
+		uint64_t end;
+		int scope;
+	};
+	class ScopedTimer
+	{
+	public:
+		ScopedTimer(int scope)
+			:
+			scope(scope),
+			start(ReadCycles())
+		{}
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+		~ScopedTimer()
+		{
+			Record(scope, start, ReadCycles());
+		}
+	private:
+		int scope;
+		uint64_t start;
+	};
+public:
+	static int RegisterScope(const char* name);
+	static int FindScope(const char* name);
+	static int GetScopeCount();
+	static const char* GetScopeName(int scope);
+	static void Record(int scope, uint64_t start, uint64_t end);
+	static void EndFrame();
+	// threads are numbered in the order they first record anything; the game loop is usually 0
+	static int GetThreadCount();
+	static int GetCurrentThreadIndex();
+	static void SetThreadName(const char* name);
+	static std::string GetThreadName(int thread);
+	static Summary Summarize(int thread, int scope);
+	static double GetLastMs(int thread, int scope);
+	static std::string Report(int thread);
+	static void SetTracing(bool enabled);
+	static bool IsTracing();
+	// only one consumer may drain spans at a time
+	static int DrainSpans(int thread, Span* spans, int maxSpans);
+	static uint64_t GetDroppedSpans(int thread);
+	static uint64_t ReadCycles();
+	static uint64_t GetStartCycles();
+	static double GetCyclesPerMs();
+	static double CyclesToMs(uint64_t cycles);
+};
+
+#if CHILI_PROFILER
+#define PROFILE_CONCAT_(a,b) a##b
+#define PROFILE_CONCAT(a,b) PROFILE_CONCAT_(a,b)
+#define PROFILE_SCOPE(name) \
+	static const int PROFILE_CONCAT(profileScopeId_,__LINE__) = Profiler::RegisterScope(name); \
+	const Profiler::ScopedTimer PROFILE_CONCAT(profileScope_,__LINE__)(PROFILE_CONCAT(profileScopeId_,__LINE__))
+#define PROFILE_END_FRAME() Profiler::EndFrame()
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_END_FRAME()
+#endif
@@ -0,0 +1,146 @@
+#include "Replay.h"
+#include "BinaryIO.h"
+#include "Direction.h"
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <stdexcept>
+
+Replay::Replay(int keyframeInterval)
+	:
+	keyframeInterval(keyframeInterval)
+{
+	assert(keyframeInterval > 0);
+}
+
+void Replay::Begin(unsigned int seed_in)
+{
+	seed = seed_in;
+	inputs.clear();
+	keyframes.clear();
+}
+
+bool Replay::NeedsKeyframe() const
+{
+	return GetTickCount() % keyframeInterval == 0;
+}
+
+void Replay::AddKeyframe(const GameState& state)
+{
+	keyframes.push_back({ GetTickCount(), state });
+}
+
+void Replay::RecordInput(Location delta_loc)
+{
+	inputs.push_back((unsigned char)ToDirection(delta_loc));
+}
+
+void Replay::Truncate(int tick)
+{
+	if (tick < GetTickCount())
+	{
+		inputs.resize(tick);
+	}
+	while (!keyframes.empty() && keyframes.back().tick >= tick)
+	{
+		keyframes.pop_back();
+	}
+}
+
+Location Replay::GetInput(int tick) const
+{
+	return ToDelta(Direction(inputs[tick]));
+}
+
+const Replay::Keyframe& Replay::FindKeyframe(int tick) const
+{
+	assert(!keyframes.empty());
+	// keyframes are appended in tick order, so the one we want is the last one not after tick
+	auto it = std::upper_bound(keyframes.begin(), keyframes.end(), tick,
+		[](int t, const Keyframe& k) { return t < k.tick; });
+	if (it != keyframes.begin())
+	{
+		--it;
+	}
+	return *it;
+}
+
+int Replay::GetTickCount() const
+{
+	return int(inputs.size());
+}
+
+unsigned int Replay::GetSeed() const
+{
+	return seed;
+}
+
+void Replay::Save(const std::string& filename) const
+{
+	std::ofstream out(filename, std::ios::binary);
+	if (!out)
+	{
+		throw std::runtime_error("Could not open replay file for writing: " + filename);
+	}
+	WriteRaw(out, Magic);
+	WriteRaw(out, Version);
+	WriteRaw(out, seed);
+	WriteRaw(out, keyframeInterval);
+	WriteRaw(out, int(sizeof(GameState)));
+	WriteRaw(out, int(inputs.size()));
+	out.write(reinterpret_cast<const char*>(inputs.data()), inputs.size());
+	WriteRaw(out, int(keyframes.size()));
+	for (const Keyframe& k : keyframes)
+	{
+		WriteRaw(out, k.tick);
+		WriteRaw(out, k.state);
+	}
+}
+
+void Replay::Load(const std::string& filename)
+{
+	std::ifstream in(filename, std::ios::binary);
+	if (!in)
+	{
+		throw std::runtime_error("Could not open replay file: " + filename);
+	}
+	if (ReadRaw<unsigned int>(in) != Magic || ReadRaw<unsigned int>(in) != Version)
+	{
+		throw std::runtime_error("Not a supported replay file: " + filename);
+	}
+	seed = ReadRaw<unsigned int>(in);
+	keyframeInterval = ReadRaw<int>(in);
+	if (ReadRaw<int>(in) != int(sizeof(GameState)))
+	{
+		throw std::runtime_error("Replay was recorded by an incompatible build: " + filename);
+	}
+	// the counts are checked before anything is allocated for them: the inputs
+	// cannot outnumber the bytes left in the file, and a keyframe is taken
+	// every keyframeInterval ticks
+	const std::streamoff start = in.tellg();
+	in.seekg(0, std::ios::end);
+	const std::streamoff left = in.tellg() - start;
+	in.seekg(start);
+	const int inputCount = ReadRaw<int>(in);
+	if (!in || keyframeInterval <= 0 || inputCount < 0 || inputCount > left)
+	{
+		throw std::runtime_error("Replay file is truncated or corrupt: " + filename);
+	}
+	inputs.resize(inputCount);
+	in.read(reinterpret_cast<char*>(inputs.data()), inputs.size());
+	const int keyframeCount = ReadRaw<int>(in);
+	if (!in || keyframeCount < 0 || keyframeCount > inputCount / keyframeInterval + 1)
+	{
+		throw std::runtime_error("Replay file is truncated or corrupt: " + filename);
+	}
+	keyframes.resize(keyframeCount);
+	for (Keyframe& k : keyframes)
+	{
+		k.tick = ReadRaw<int>(in);
+		k.state = ReadRaw<GameState>(in);
+	}
+	if (!in || keyframes.empty())
+	{
+		throw std::runtime_error("Replay file is truncated or corrupt: " + filename);
+	}
+}
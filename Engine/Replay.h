@@ -0,0 +1,42 @@
+#pragma once
+#include "Location.h"
+#include "GameState.h"
+#include <string>
+#include <vector>
+
+// Records the per-tick input of a game together with periodic full state
+// snapshots (keyframes), so playback can jump to any tick by restoring the
+// nearest keyframe and simulating at most keyframeInterval - 1 ticks forward.
+class Replay
+{
+public:
+	struct Keyframe
+	{
+		int tick;
+		GameState state;
+	};
+public:
+	Replay(int keyframeInterval = DefaultKeyframeInterval);
+	void Begin(unsigned int seed);
+	bool NeedsKeyframe() const;
+	void AddKeyframe(const GameState& state);
+	void RecordInput(Location delta_loc);
+	// drops everything recorded from tick onwards, e.g. after rolling the game back
+	void Truncate(int tick);
+	Location GetInput(int tick) const;
+	const Keyframe& FindKeyframe(int tick) const;
+	int GetTickCount() const;
+	unsigned int GetSeed() const;
+	void Save(const std::string& filename) const;
+	void Load(const std::string& filename);
+public:
+	// smaller intervals make seeking faster at the cost of a bigger file
+	static constexpr int DefaultKeyframeInterval = 300;
+private:
+	static constexpr unsigned int Magic = 0x524B4E53; // "SNKR"
+	static constexpr unsigned int Version = 3;
+	unsigned int seed = 0;
+	int keyframeInterval;
+	std::vector<unsigned char> inputs;
+	std::vector<Keyframe> keyframes;
+};
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+
+// Small deterministic generator (xorshift64*). Unlike std::mt19937 and the std
+// distributions its state is 8 bytes and its output is the same on every
+// compiler, so it can be copied around with the rest of the game state.
+class Rng
+{
+public:
+	Rng() = default;
+	explicit Rng(uint64_t seed)
+	{
+		Seed(seed);
+	}
+	void Seed(uint64_t seed)
+	{
+		// splitmix64 scramble, so small seeds still start from a well mixed non-zero state
+		uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		state = (z ^ (z >> 31)) | 1u;
+	}
+	uint32_t Next()
+	{
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		return uint32_t((state * 0x2545F4914F6CDD1Dull) >> 32);
+	}
+	// uniform integer in [lo,hi]
+	int Range(int lo, int hi)
+	{
+		const uint64_t span = uint64_t(int64_t(hi) - lo) + 1u;
+		return lo + int((uint64_t(Next()) * span) >> 32);
+	}
+private:
+	uint64_t state = 0x853C49E6748FEA9Bull;
+};
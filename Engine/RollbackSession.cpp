@@ -0,0 +1,152 @@
+#include "RollbackSession.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+RollbackSession::RollbackSession(Arena& arena_in, int localPlayer_in, std::vector<Transport*> peers_in,
+	int maxRollback_in)
+	:
+	arena(arena_in),
+	localPlayer(localPlayer_in),
+	nPlayers(arena_in.GetSnakeCount()),
+	peers(std::move(peers_in)),
+	maxRollback(maxRollback_in),
+	// a peer runs at most maxRollback ticks past its oldest missing input, which may be ours
+	window(2 * maxRollback_in + 4),
+	inputs(size_t(window) * nPlayers),
+	used(inputs.size()),
+	lastKnown(nPlayers, -1),
+	initial(nPlayers),
+	snapshots(maxRollback_in + 1),
+	stepInputs(nPlayers)
+{
+	if (int(peers.size()) != nPlayers || localPlayer < 0 || localPlayer >= nPlayers || maxRollback < 1)
+	{
+		throw std::runtime_error("Rollback needs one peer per snake, a local player among them and room to roll back");
+	}
+	for (int p = 0; p < nPlayers; ++p)
+	{
+		initial[p] = arena.GetDirection(p);
+	}
+}
+
+bool RollbackSession::Update(Direction input)
+{
+	// after a stall the input for this tick has gone out already
+	if (lastKnown[localPlayer] < tick)
+	{
+		inputs[Slot(tick) + localPlayer] = input;
+		lastKnown[localPlayer] = tick;
+		message.assign(InputMessage, 0);
+		for (int b = 0; b < 4; ++b)
+		{
+			message[b] = uint8_t(uint32_t(tick) >> (8 * b));
+		}
+		message[4] = uint8_t(input);
+		for (Transport* peer : peers)
+		{
+			if (peer)
+			{
+				peer->Send(message.data(), message.size());
+			}
+		}
+	}
+	ReceiveInputs();
+
+	lastResimulated = 0;
+	if (mispredicted < tick)
+	{
+		arena.Load(snapshots[mispredicted % snapshots.size()]);
+		for (int t = mispredicted; t < tick; ++t)
+		{
+			Simulate(t);
+		}
+		lastResimulated = tick - mispredicted;
+	}
+	if (tick - GetConfirmedTick() >= maxRollback)
+	{
+		mispredicted = tick;
+		++stalls;
+		return false;
+	}
+	Simulate(tick);
+	++tick;
+	mispredicted = tick;
+	return true;
+}
+
+int RollbackSession::GetTick() const
+{
+	return tick;
+}
+
+int RollbackSession::GetConfirmedTick() const
+{
+	return *std::min_element(lastKnown.begin(), lastKnown.end()) + 1;
+}
+
+int RollbackSession::GetLastResimulated() const
+{
+	return lastResimulated;
+}
+
+int RollbackSession::GetStallCount() const
+{
+	return stalls;
+}
+
+void RollbackSession::ReceiveInputs()
+{
+	for (int p = 0; p < nPlayers; ++p)
+	{
+		Transport* const peer = peers[p];
+		while (peer && peer->Receive(message))
+		{
+			if (message.size() != InputMessage)
+			{
+				throw std::runtime_error("Rollback message of unexpected size from player " + std::to_string(p));
+			}
+			uint32_t t = 0u;
+			for (int b = 0; b < 4; ++b)
+			{
+				t |= uint32_t(message[b]) << (8 * b);
+			}
+			if (int(t) != lastKnown[p] + 1 || int(t) > tick + maxRollback + 1 || message[4] >= DirectionCount)
+			{
+				throw std::runtime_error("Rollback input out of order from player " + std::to_string(p));
+			}
+			const Direction input = Direction(message[4]);
+			inputs[Slot(int(t)) + p] = input;
+			lastKnown[p] = int(t);
+			// the ticks after it were predicted from this input's predecessor,
+			// so they can only be wrong if this one is
+			if (int(t) < tick && used[Slot(int(t)) + p] != input)
+			{
+				mispredicted = std::min(mispredicted, int(t));
+			}
+		}
+	}
+}
+
+Direction RollbackSession::GetInput(int t, int player) const
+{
+	const int known = std::min(t, lastKnown[player]);
+	return known < 0 ? initial[player] : inputs[Slot(known) + player];
+}
+
+void RollbackSession::Simulate(int t)
+{
+	arena.Save(snapshots[t % snapshots.size()]);
+	for (int p = 0; p < nPlayers; ++p)
+	{
+		stepInputs[p] = GetInput(t, p);
+		used[Slot(t) + p] = stepInputs[p];
+	}
+	arena.Step(stepInputs.data());
+}
+
+int RollbackSession::Slot(int t) const
+{
+	return (t % window) * nPlayers;
+}
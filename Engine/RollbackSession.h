@@ -0,0 +1,65 @@
+#pragma once
+#include "Arena.h"
+#include "Direction.h"
+#include "Transport.h"
+#include <cstdint>
+#include <vector>
+
+// Rollback multiplayer over an Arena. Remote inputs that have not arrived yet
+// are predicted to repeat the player's last known one, so every Update steps
+// without waiting for the network. When a late input turns out to differ from
+// its prediction, the arena is loaded back to the snapshot from before that
+// tick and stepped forward again with the corrections, in the same Update.
+// Snapshots of the last maxRollback ticks are kept; a session that runs that
+// far past the oldest missing input stalls until it arrives, so no Update
+// steps more than maxRollback + 1 ticks. The messages are the same 5 bytes per
+// tick and peer as LockstepSession's, without the hashes.
+class RollbackSession
+{
+public:
+	// peers holds one transport per snake of the arena, nullptr for the local player;
+	// every player's arena has to start out the same, e.g. reset with a shared seed
+	RollbackSession(Arena& arena, int localPlayer, std::vector<Transport*> peers, int maxRollback);
+	// sends the local input for the current tick, rolls back if an input that
+	// came in contradicts its prediction and steps once; returns whether it stepped
+	bool Update(Direction input);
+	int GetTick() const;
+	// all inputs before this tick are known, so the arena up to it is final
+	int GetConfirmedTick() const;
+	// ticks stepped again by the last Update to correct predictions
+	int GetLastResimulated() const;
+	int GetStallCount() const;
+private:
+	static constexpr size_t InputMessage = 5;
+private:
+	void ReceiveInputs();
+	// the known input, otherwise the player's last known one
+	Direction GetInput(int t, int player) const;
+	// snapshots the arena as it is at tick t and steps it
+	void Simulate(int t);
+	int Slot(int t) const;
+private:
+	Arena& arena;
+	int localPlayer;
+	int nPlayers;
+	std::vector<Transport*> peers;
+	int maxRollback;
+	// ring buffers over the ticks in flight, window slots of nPlayers entries:
+	// the inputs that arrived, and those the arena was stepped with
+	int window;
+	std::vector<Direction> inputs;
+	std::vector<Direction> used;
+	// per player: the latest tick with a known input, inputs arrive in order
+	std::vector<int> lastKnown;
+	// what is predicted before a player's first input arrives
+	std::vector<Direction> initial;
+	// the arena at the start of each of the last maxRollback + 1 ticks
+	std::vector<Arena::Snapshot> snapshots;
+	std::vector<Direction> stepInputs;
+	std::vector<uint8_t> message;
+	int tick = 0;
+	// earliest tick stepped with a wrong prediction, tick when there is none
+	int mispredicted = 0;
+	int lastResimulated = 0;
+	int stalls = 0;
+};
@@ -0,0 +1,69 @@
+#include "Simulation.h"
+
+void Simulation::Reset(GameState& state, const Board& brd, uint64_t seed)
+{
+	state = GameState();
+	state.rng.Seed(seed);
+	state.snake.InitHead(brd.GetStart(), brd.GetStartDirection());
+	state.food.Jump(RandomFoodLocation(state.rng, brd));
+}
+
+void Simulation::Tick(GameState& state, const Board& brd)
+{
+	++state.tick;
+	++state.counter;
+
+	if (state.snake.CheckFood(state.food))
+	{
+		state.food.Jump(RandomFoodLocation(state.rng, brd));
+	}
+	if (state.counter >= Timer)
+	{
+		state.GameOver = CheckForGameOver(state.snake, brd);
+		if (!state.GameOver)
+		{
+			state.snake.Move(brd);
+			state.counter = 0;
+		}
+	}
+}
+
+void Simulation::Step(GameState& state, const Board& brd)
+{
+	bool moved = false;
+	while (!state.GameOver)
+	{
+		Tick(state, brd);
+		moved = moved || state.counter == 0;
+		if (moved && state.counter == Timer - 1)
+		{
+			break;
+		}
+	}
+}
+
+bool Simulation::CheckForGameOver(const Snake& snake, const Board& brd)
+{
+	// a snake covering the whole board has nowhere left to go either
+	const Location next = snake.GetNextHeadLocation(brd);
+	return snake.EatsItself(brd) || brd.isOutsideBoard(next) || brd.IsWall(next) ||
+		snake.GetLength() >= brd.GetWidth() * brd.GetHeight();
+}
+
+Location Simulation::RandomFoodLocation(Rng& rng, const Board& brd)
+{
+	Location loc = brd.RandomFoodCell(rng);
+	for (int t = 0; brd.IsWall(loc) && t < FoodTries; ++t)
+	{
+		loc = brd.RandomFoodCell(rng);
+	}
+	// a food region that is nearly all wall: the first open cell in view from there on
+	const Location origin = brd.GetOrigin();
+	for (int c = 0; brd.IsWall(loc) && c < brd.GetWidth() * brd.GetHeight(); ++c)
+	{
+		const int x = loc.x - origin.x + 1 < brd.GetWidth() ? loc.x - origin.x + 1 : 0;
+		const int y = x == 0 ? (loc.y - origin.y + 1) % brd.GetHeight() : loc.y - origin.y;
+		loc = origin.Add({ x,y });
+	}
+	return loc;
+}
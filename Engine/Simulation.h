@@ -0,0 +1,25 @@
+#pragma once
+#include "GameState.h"
+#include "Board.h"
+#include <cstdint>
+
+// The snake rules, independent of the window, keyboard and graphics. The
+// windowed Game and every headless user (environments, bots, tools) advance
+// a GameState through these functions, so they all play by the same rules.
+class Simulation
+{
+public:
+	// ticks between two moves of the snake
+	static constexpr int Timer = 20;
+	// random draws for food before it falls back to searching for an open cell
+	static constexpr int FoodTries = 64;
+public:
+	static void Reset(GameState& state, const Board& brd, uint64_t seed);
+	static void Tick(GameState& state, const Board& brd);
+	// advances from one steering decision to the next: ticks until the snake has
+	// moved once and stops right before the tick that moves it again, so any
+	// food reached by the move is eaten within the same step
+	static void Step(GameState& state, const Board& brd);
+	static bool CheckForGameOver(const Snake& snake, const Board& brd);
+	static Location RandomFoodLocation(Rng& rng, const Board& brd);
+};
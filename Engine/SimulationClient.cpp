@@ -0,0 +1,185 @@
+#include "SimulationClient.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+	uint32_t Read32(const uint8_t* p)
+	{
+		return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+	}
+
+	void Put32(std::vector<uint8_t>& out, uint32_t value)
+	{
+		for (int b = 0; b < 4; ++b)
+		{
+			out.push_back(uint8_t(value >> (8 * b)));
+		}
+	}
+}
+
+SimulationClient::SimulationClient(const std::string& path, int timeoutMs)
+	:
+	socket(UnixSocket::Connect(path, timeoutMs))
+{
+}
+
+void SimulationClient::GetInfo(int& width, int& height, int& planes)
+{
+	const std::vector<uint8_t> body = Call(SimulationServer::Op::Info);
+	if (body.size() != 5)
+	{
+		throw std::runtime_error("Malformed Info response");
+	}
+	width = body[0] | body[1] << 8;
+	height = body[2] | body[3] << 8;
+	planes = body[4];
+}
+
+std::vector<uint32_t> SimulationClient::Create(uint32_t count, uint64_t seed)
+{
+	BeginRequest(SimulationServer::Op::Create);
+	Put32(request, count);
+	Put32(request, uint32_t(seed));
+	Put32(request, uint32_t(seed >> 32));
+	std::vector<uint8_t> body;
+	ReceiveResponse(SendRequest(), body);
+	if (body.size() != 4 * size_t(count))
+	{
+		throw std::runtime_error("Malformed Create response");
+	}
+	std::vector<uint32_t> ids(count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		ids[i] = Read32(&body[4 * i]);
+	}
+	return ids;
+}
+
+uint32_t SimulationClient::SendStep(const uint32_t* ids, const uint8_t* actions, uint32_t count)
+{
+	BeginRequest(SimulationServer::Op::Step);
+	Put32(request, count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		Put32(request, ids[i]);
+		request.push_back(actions[i]);
+	}
+	return SendRequest();
+}
+
+uint32_t SimulationClient::SendObserve(const uint32_t* ids, uint32_t count)
+{
+	BeginRequest(SimulationServer::Op::Observe);
+	Put32(request, count);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		Put32(request, ids[i]);
+	}
+	return SendRequest();
+}
+
+void SimulationClient::Destroy(const std::vector<uint32_t>& ids)
+{
+	BeginRequest(SimulationServer::Op::Destroy);
+	Put32(request, uint32_t(ids.size()));
+	for (uint32_t id : ids)
+	{
+		Put32(request, id);
+	}
+	std::vector<uint8_t> body;
+	ReceiveResponse(SendRequest(), body);
+}
+
+void SimulationClient::Shutdown()
+{
+	Call(SimulationServer::Op::Shutdown);
+}
+
+void SimulationClient::ReceiveResponse(uint32_t requestId, std::vector<uint8_t>& body)
+{
+	uint8_t chunk[65536];
+	bool closed = false;
+	while (inBuffer.size() < 4 || inBuffer.size() - 4 < Read32(inBuffer.data()))
+	{
+		const size_t got = socket.Receive(chunk, sizeof(chunk), closed);
+		if (got > 0)
+		{
+			inBuffer.insert(inBuffer.end(), chunk, chunk + got);
+		}
+		else if (closed)
+		{
+			throw std::runtime_error("Simulation server hung up");
+		}
+		else
+		{
+			UnixSocket::Wait({ &socket }, {}, 1000);
+		}
+	}
+	const uint32_t size = Read32(inBuffer.data());
+	if (size < 5 || Read32(&inBuffer[4]) != requestId)
+	{
+		throw std::runtime_error("Simulation server answered out of order");
+	}
+	const bool failed = inBuffer[8] != 0u;
+	body.assign(inBuffer.begin() + 9, inBuffer.begin() + 4 + size);
+	inBuffer.erase(inBuffer.begin(), inBuffer.begin() + 4 + size);
+	if (failed)
+	{
+		throw std::runtime_error("Simulation server: " + std::string(body.begin(), body.end()));
+	}
+}
+
+float SimulationClient::GetReward(const std::vector<uint8_t>& body, uint32_t i)
+{
+	float reward;
+	std::memcpy(&reward, &body[5 * size_t(i)], 4);
+	return reward;
+}
+
+bool SimulationClient::GetDone(const std::vector<uint8_t>& body, uint32_t i)
+{
+	return body[5 * size_t(i) + 4] != 0u;
+}
+
+void SimulationClient::BeginRequest(SimulationServer::Op op)
+{
+	request.assign(9, 0u);
+	request[8] = uint8_t(op);
+}
+
+uint32_t SimulationClient::SendRequest()
+{
+	const uint32_t requestId = nextId++;
+	const uint32_t size = uint32_t(request.size() - 4);
+	for (int b = 0; b < 4; ++b)
+	{
+		request[b] = uint8_t(size >> (8 * b));
+		request[4 + b] = uint8_t(requestId >> (8 * b));
+	}
+	// the server never stops reading, so waiting to write cannot deadlock on unread responses
+	size_t at = 0;
+	bool closed = false;
+	while (at < request.size())
+	{
+		const size_t sent = socket.Send(request.data() + at, request.size() - at, closed);
+		if (closed)
+		{
+			throw std::runtime_error("Simulation server hung up");
+		}
+		at += sent;
+		if (sent == 0)
+		{
+			UnixSocket::Wait({}, { &socket }, 1000);
+		}
+	}
+	return requestId;
+}
+
+std::vector<uint8_t> SimulationClient::Call(SimulationServer::Op op)
+{
+	BeginRequest(op);
+	std::vector<uint8_t> body;
+	ReceiveResponse(SendRequest(), body);
+	return body;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "SimulationServer.h"
+#include "UnixSocket.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// C++ end of the SimulationServer protocol, the same calls a trainer in another
+// language makes. The Send calls only queue a request and return its id, so
+// several can be in flight before ReceiveResponse collects them in order;
+// error responses are thrown as std::runtime_error.
+class SimulationClient
+{
+public:
+	SimulationClient(const std::string& path, int timeoutMs = 5000);
+	void GetInfo(int& width, int& height, int& planes);
+	std::vector<uint32_t> Create(uint32_t count, uint64_t seed);
+	uint32_t SendStep(const uint32_t* ids, const uint8_t* actions, uint32_t count);
+	uint32_t SendObserve(const uint32_t* ids, uint32_t count);
+	void Destroy(const std::vector<uint32_t>& ids);
+	// asks the server to stop and waits for it to confirm
+	void Shutdown();
+	// waits for the next response, which has to answer requestId, and copies its body
+	void ReceiveResponse(uint32_t requestId, std::vector<uint8_t>& body);
+	// body of a Step response: reward and done flag of game i
+	static float GetReward(const std::vector<uint8_t>& body, uint32_t i);
+	static bool GetDone(const std::vector<uint8_t>& body, uint32_t i);
+private:
+	// the request is assembled in request after its 9 byte header
+	void BeginRequest(SimulationServer::Op op);
+	uint32_t SendRequest();
+	std::vector<uint8_t> Call(SimulationServer::Op op);
+private:
+	UnixSocket socket;
+	std::vector<uint8_t> request;
+	std::vector<uint8_t> inBuffer;
+	uint32_t nextId = 1u;
+};
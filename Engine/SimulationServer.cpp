@@ -0,0 +1,355 @@
+#include "SimulationServer.h"
+#include "Direction.h"
+#include "Simulation.h"
+#include "SnakeEnv.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+constexpr uint32_t SimulationServer::MaxRequest;
+constexpr uint32_t SimulationServer::MaxCreate;
+
+namespace
+{
+	uint32_t Read32(const uint8_t* p)
+	{
+		return uint32_t(p[0]) | uint32_t(p[1]) << 8 | uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+	}
+
+	void Write32(uint8_t* p, uint32_t value)
+	{
+		for (int b = 0; b < 4; ++b)
+		{
+			p[b] = uint8_t(value >> (8 * b));
+		}
+	}
+
+	void Put16(std::vector<uint8_t>& out, uint32_t value)
+	{
+		out.push_back(uint8_t(value));
+		out.push_back(uint8_t(value >> 8));
+	}
+
+	void Put32(std::vector<uint8_t>& out, uint32_t value)
+	{
+		out.resize(out.size() + 4);
+		Write32(&out[out.size() - 4], value);
+	}
+}
+
+SimulationServer::SimulationServer(const std::string& path, int threads, const Board& brd)
+	:
+	brd(brd),
+	encoder(this->brd),
+	pool(threads),
+	listener(UnixSocket::Listen(path, 16))
+{
+}
+
+void SimulationServer::Serve(const std::atomic<bool>& stop)
+{
+	bool running = true;
+	while (running && !stop)
+	{
+		std::vector<const UnixSocket*> readers(1, &listener);
+		std::vector<const UnixSocket*> writers;
+		for (const Connection& connection : connections)
+		{
+			readers.push_back(&connection.socket);
+			if (!connection.outBuffer.empty())
+			{
+				writers.push_back(&connection.socket);
+			}
+		}
+		// the timeout is only there to notice stop
+		UnixSocket::Wait(readers, writers, 100);
+		for (UnixSocket peer = listener.Accept(); peer.IsOpen(); peer = listener.Accept())
+		{
+			connections.emplace_back();
+			connections.back().socket = std::move(peer);
+		}
+		for (Connection& connection : connections)
+		{
+			Receive(connection);
+			size_t at = 0;
+			while (running && connection.inBuffer.size() - at >= 4)
+			{
+				const uint32_t size = Read32(&connection.inBuffer[at]);
+				if (size < 5 || size > MaxRequest)
+				{
+					// the framing is lost, nothing after this can be trusted
+					connection.closed = true;
+					break;
+				}
+				if (connection.inBuffer.size() - at - 4 < size)
+				{
+					break;
+				}
+				running = Handle(&connection.inBuffer[at + 4], size, connection.outBuffer);
+				at += 4 + size;
+			}
+			connection.inBuffer.erase(connection.inBuffer.begin(), connection.inBuffer.begin() + at);
+			Send(connection);
+		}
+		connections.erase(std::remove_if(connections.begin(), connections.end(), [](const Connection& connection)
+		{
+			return connection.closed;
+		}), connections.end());
+	}
+
+	// the Shutdown response still has to go out
+	for (int tries = 0; tries < 100; ++tries)
+	{
+		std::vector<const UnixSocket*> writers;
+		for (Connection& connection : connections)
+		{
+			Send(connection);
+			if (!connection.closed && !connection.outBuffer.empty())
+			{
+				writers.push_back(&connection.socket);
+			}
+		}
+		if (writers.empty())
+		{
+			break;
+		}
+		UnixSocket::Wait({}, writers, 10);
+	}
+}
+
+int SimulationServer::GetGameCount() const
+{
+	return int(games.size() - freeIds.size());
+}
+
+void SimulationServer::Receive(Connection& connection)
+{
+	uint8_t chunk[65536];
+	while (!connection.closed)
+	{
+		const size_t got = connection.socket.Receive(chunk, sizeof(chunk), connection.closed);
+		if (got == 0)
+		{
+			break;
+		}
+		connection.inBuffer.insert(connection.inBuffer.end(), chunk, chunk + got);
+	}
+}
+
+void SimulationServer::Send(Connection& connection)
+{
+	size_t at = 0;
+	bool lost = false;
+	while (at < connection.outBuffer.size())
+	{
+		const size_t sent = connection.socket.Send(connection.outBuffer.data() + at, connection.outBuffer.size() - at,
+			lost);
+		if (sent == 0)
+		{
+			break;
+		}
+		at += sent;
+	}
+	connection.outBuffer.erase(connection.outBuffer.begin(), connection.outBuffer.begin() + at);
+	if (lost)
+	{
+		connection.closed = true;
+	}
+}
+
+bool SimulationServer::Handle(const uint8_t* request, size_t size, std::vector<uint8_t>& out)
+{
+	const uint32_t requestId = Read32(request);
+	const Op op = Op(request[4]);
+	const uint8_t* const body = request + 5;
+	const size_t bodySize = size - 5;
+	const size_t start = out.size();
+	Put32(out, 0u);
+	Put32(out, requestId);
+	out.push_back(0u);
+	bool keepServing = true;
+	++requestCount;
+	try
+	{
+		switch (op)
+		{
+		case Op::Info:
+			Put16(out, uint32_t(brd.GetWidth()));
+			Put16(out, uint32_t(brd.GetHeight()));
+			out.push_back(uint8_t(ObservationEncoder::PlaneCount));
+			break;
+		case Op::Create:
+			Create(body, bodySize, out);
+			break;
+		case Op::Step:
+			StepGames(body, bodySize, out);
+			break;
+		case Op::Observe:
+			Observe(body, bodySize, out);
+			break;
+		case Op::Destroy:
+			Destroy(body, bodySize);
+			break;
+		case Op::Shutdown:
+			keepServing = false;
+			break;
+		default:
+			throw std::runtime_error("Unknown request " + std::to_string(int(op)));
+		}
+	}
+	catch (const std::exception& e)
+	{
+		// every request is checked before it changes anything, so an error leaves the games as they were
+		out.resize(start + 9);
+		out.back() = 1u;
+		out.insert(out.end(), e.what(), e.what() + std::strlen(e.what()));
+	}
+	Write32(&out[start], uint32_t(out.size() - start - 4));
+	return keepServing;
+}
+
+void SimulationServer::Create(const uint8_t* body, size_t size, std::vector<uint8_t>& out)
+{
+	if (size != 12)
+	{
+		throw std::runtime_error("Create takes a count and a seed");
+	}
+	const uint32_t count = Read32(body);
+	const uint64_t seed = uint64_t(Read32(body + 4)) | uint64_t(Read32(body + 8)) << 32;
+	if (count > MaxCreate)
+	{
+		throw std::runtime_error("Create asks for more than " + std::to_string(MaxCreate) + " games");
+	}
+	// all the memory is taken up front, so running out of it leaves the games as they were
+	const size_t newGames = count > freeIds.size() ? count - freeIds.size() : 0u;
+	games.reserve(games.size() + newGames);
+	seedSequences.reserve(seedSequences.size() + newGames);
+	inUse.reserve(inUse.size() + newGames);
+	seenIn.reserve(seenIn.size() + newGames);
+	out.reserve(out.size() + 4 * size_t(count));
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		uint32_t id;
+		if (freeIds.empty())
+		{
+			id = uint32_t(games.size());
+			games.emplace_back();
+			seedSequences.emplace_back();
+			inUse.push_back(0u);
+			seenIn.push_back(0u);
+		}
+		else
+		{
+			id = freeIds.back();
+			freeIds.pop_back();
+		}
+		inUse[id] = 1u;
+		seedSequences[id].Seed(seed + i);
+		ResetGame(id);
+		Put32(out, id);
+	}
+}
+
+void SimulationServer::StepGames(const uint8_t* body, size_t size, std::vector<uint8_t>& out)
+{
+	const uint32_t count = ReadIds(body, size, 5);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (body[4 + 5 * i + 4] >= DirectionCount)
+		{
+			throw std::runtime_error("Step with an action that is not a Direction");
+		}
+	}
+	const size_t base = out.size();
+	out.resize(base + 5 * size_t(count));
+	const int batches = int((count + BatchGames - 1) / BatchGames);
+	pool.ParallelFor(batches, [&](int batch)
+	{
+		const uint32_t end = std::min(count, uint32_t(batch + 1) * BatchGames);
+		for (uint32_t i = uint32_t(batch) * BatchGames; i < end; ++i)
+		{
+			const uint32_t id = Read32(body + 4 + 5 * i);
+			GameState& state = games[id];
+			const int length = state.snake.GetLength();
+			state.snake.Steer(ToDelta(Direction(body[4 + 5 * i + 4])));
+			Simulation::Step(state, brd);
+			float reward;
+			uint8_t done = 0u;
+			if (state.GameOver)
+			{
+				reward = SnakeEnv::DeathReward;
+				done = 1u;
+				ResetGame(id);
+			}
+			else
+			{
+				reward = SnakeEnv::FoodReward * (state.snake.GetLength() - length);
+			}
+			uint8_t* const result = &out[base + 5 * i];
+			std::memcpy(result, &reward, 4);
+			result[4] = done;
+		}
+	});
+}
+
+void SimulationServer::Observe(const uint8_t* body, size_t size, std::vector<uint8_t>& out)
+{
+	const uint32_t count = ReadIds(body, size, 4);
+	const size_t gameSize = encoder.GetGameSize();
+	const size_t base = out.size();
+	out.resize(base + gameSize * count);
+	const int batches = int((count + BatchGames - 1) / BatchGames);
+	pool.ParallelFor(batches, [&](int batch)
+	{
+		const uint32_t end = std::min(count, uint32_t(batch + 1) * BatchGames);
+		for (uint32_t i = uint32_t(batch) * BatchGames; i < end; ++i)
+		{
+			encoder.Encode(&games[Read32(body + 4 + 4 * i)], 1, &out[base + gameSize * i]);
+		}
+	});
+}
+
+void SimulationServer::Destroy(const uint8_t* body, size_t size)
+{
+	const uint32_t count = ReadIds(body, size, 4);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint32_t id = Read32(body + 4 + 4 * i);
+		inUse[id] = 0u;
+		freeIds.push_back(id);
+	}
+}
+
+uint32_t SimulationServer::ReadIds(const uint8_t* body, size_t size, size_t stride)
+{
+	if (size < 4)
+	{
+		throw std::runtime_error("Request without a count");
+	}
+	const uint32_t count = Read32(body);
+	if (count > (size - 4) / stride || size != 4 + stride * count)
+	{
+		throw std::runtime_error("Request size does not match its count");
+	}
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint32_t id = Read32(body + 4 + stride * i);
+		if (id >= games.size() || !inUse[id])
+		{
+			throw std::runtime_error("No game with id " + std::to_string(id));
+		}
+		if (seenIn[id] == requestCount)
+		{
+			throw std::runtime_error("Game id " + std::to_string(id) + " appears twice in one request");
+		}
+		seenIn[id] = requestCount;
+	}
+	return count;
+}
+
+void SimulationServer::ResetGame(uint32_t id)
+{
+	const uint64_t seed = (uint64_t(seedSequences[id].Next()) << 32) | seedSequences[id].Next();
+	Simulation::Reset(games[id], brd, seed);
+}
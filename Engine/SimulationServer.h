@@ -0,0 +1,87 @@
+#pragma once
+#include "Board.h"
+#include "GameState.h"
+#include "ObservationEncoder.h"
+#include "Rng.h"
+#include "ThreadPool.h"
+#include "UnixSocket.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Hosts many headless games for trainers in other processes, e.g. Python,
+// which send batched requests over a Unix socket. A client may send any number
+// of requests before reading the responses; each connection's requests run in
+// order, every batch spread over a thread pool. Games follow SnakeEnv: a step
+// is one steering decision, rewards are SnakeEnv::FoodReward and DeathReward,
+// and a game that ends starts over straight away with a seed from its own sequence.
+// Framing, little endian:
+//   request:  u32 size of the rest, u32 request id, u8 Op, body
+//   response: u32 size of the rest, u32 request id, u8 status (0 ok, 1 error), body or error text
+// Bodies:
+//   Info:     -                                  -> u16 width, u16 height, u8 planes
+//   Create:   u32 count <= MaxCreate, u64 seed   -> count x u32 game id
+//   Step:     u32 count, count x (u32 id, u8 Direction) -> count x (f32 reward, u8 done)
+//   Observe:  u32 count, count x u32 id          -> count x ObservationEncoder uint8 planes
+//   Destroy:  u32 count, count x u32 id          -> -
+//   Shutdown: -                                  -> -, then Serve returns
+class SimulationServer
+{
+public:
+	enum class Op : uint8_t
+	{
+		Info = 1,
+		Create,
+		Step,
+		Observe,
+		Destroy,
+		Shutdown
+	};
+	// larger requests close the connection
+	static constexpr uint32_t MaxRequest = 64u << 20;
+	// games one Create may ask for, so that the response with its ids fits in MaxRequest
+	static constexpr uint32_t MaxCreate = MaxRequest / 4u - 16u;
+public:
+	// brd may carry a level, whose walls the games play against and the observations show
+	SimulationServer(const std::string& path, int threads = 0, const Board& brd = Board());
+	// answers requests until a Shutdown request or until stop is set
+	void Serve(const std::atomic<bool>& stop);
+	int GetGameCount() const;
+private:
+	struct Connection
+	{
+		UnixSocket socket;
+		std::vector<uint8_t> inBuffer;
+		std::vector<uint8_t> outBuffer;
+		bool closed = false;
+	};
+	// games handed to the pool together, so a job is more than one short step
+	static constexpr int BatchGames = 64;
+private:
+	void Receive(Connection& connection);
+	void Send(Connection& connection);
+	// appends the response to out; returns false for Shutdown
+	bool Handle(const uint8_t* request, size_t size, std::vector<uint8_t>& out);
+	void Create(const uint8_t* body, size_t size, std::vector<uint8_t>& out);
+	void StepGames(const uint8_t* body, size_t size, std::vector<uint8_t>& out);
+	void Observe(const uint8_t* body, size_t size, std::vector<uint8_t>& out);
+	void Destroy(const uint8_t* body, size_t size);
+	// reads the count and checks the ids that follow, each stride bytes apart
+	uint32_t ReadIds(const uint8_t* body, size_t size, size_t stride);
+	void ResetGame(uint32_t id);
+private:
+	Board brd;
+	ObservationEncoder encoder;
+	ThreadPool pool;
+	UnixSocket listener;
+	std::vector<Connection> connections;
+	// indexed by game id; ids of destroyed games are reused
+	std::vector<GameState> games;
+	std::vector<Rng> seedSequences;
+	std::vector<uint8_t> inUse;
+	std::vector<uint32_t> freeIds;
+	// per game: the last request it appeared in, to turn away duplicate ids
+	std::vector<uint32_t> seenIn;
+	uint32_t requestCount = 0u;
+};
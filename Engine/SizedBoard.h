@@ -0,0 +1,160 @@
+#pragma once
+#include "Direction.h"
+#include "Location.h"
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// Board geometry with the size fixed at compile time, or read at run time for
+// SizedBoard<> (DynamicSize). Both share one implementation: every size query
+// is IsFixed ? W : width, which leaves only the constant in a fixed board, so
+// bounds checks, cell indices and neighbour steps of a fixed board compile
+// down to immediates and shifts, and loops over its rows have a known count.
+// Cells are numbered by bit position: a row takes whole 64-bit words, so a
+// cell index is also the cell's bit in an occupancy bitboard, with no division.
+
+constexpr int DynamicSize = 0;
+
+constexpr int CeilPowerOfTwo(int v, int p = 1)
+{
+	return p >= v ? p : CeilPowerOfTwo(v, p * 2);
+}
+
+// N elements held in place, or a vector of a size given at run time when N is DynamicSize
+template<typename T, int N>
+class SizedArray
+{
+public:
+	explicit SizedArray(int n)
+	{
+		assert(n == N);
+	}
+	T& operator[](int i)
+	{
+		return items[i];
+	}
+	const T& operator[](int i) const
+	{
+		return items[i];
+	}
+private:
+	T items[N];
+};
+
+template<typename T>
+class SizedArray<T, DynamicSize>
+{
+public:
+	explicit SizedArray(int n)
+		:
+		items(n)
+	{}
+	T& operator[](int i)
+	{
+		return items[i];
+	}
+	const T& operator[](int i) const
+	{
+		return items[i];
+	}
+private:
+	std::vector<T> items;
+};
+
+template<int W = DynamicSize, int H = DynamicSize>
+class SizedBoard
+{
+public:
+	static constexpr bool IsFixed = W != DynamicSize && H != DynamicSize;
+	// whole words per row, and bitboard words for the board, or DynamicSize
+	static constexpr int FixedRowWords = IsFixed ? (W + 63) / 64 : DynamicSize;
+	static constexpr int FixedWords = IsFixed ? H * FixedRowWords : DynamicSize;
+public:
+	explicit SizedBoard(int width = W, int height = H)
+		:
+		width(width),
+		height(height)
+	{
+		static_assert((W == DynamicSize) == (H == DynamicSize), "either both sides are fixed or neither");
+		assert(width > 0 && height > 0 && (!IsFixed || (width == W && height == H)));
+	}
+	int GetWidth() const
+	{
+		return IsFixed ? W : width;
+	}
+	int GetHeight() const
+	{
+		return IsFixed ? H : height;
+	}
+	int GetCellCount() const
+	{
+		return GetWidth() * GetHeight();
+	}
+	int GetRowWords() const
+	{
+		return IsFixed ? FixedRowWords : (width + 63) / 64;
+	}
+	int GetWordCount() const
+	{
+		return GetHeight() * GetRowWords();
+	}
+	bool IsInside(Location loc) const
+	{
+		// one unsigned compare per axis catches both sides
+		return unsigned(loc.x) < unsigned(GetWidth()) && unsigned(loc.y) < unsigned(GetHeight());
+	}
+	int Index(Location loc) const
+	{
+		return loc.y * GetRowWords() * 64 + loc.x;
+	}
+	// the index difference to the neighbour in dir
+	int GetStep(Direction dir) const
+	{
+		const int steps[DirectionCount] = { -GetRowWords() * 64,GetRowWords() * 64,-1,1 };
+		return steps[int(dir)];
+	}
+private:
+	int width;
+	int height;
+};
+
+// One bit per cell of a SizedBoard, indexed by SizedBoard::Index
+template<int W = DynamicSize, int H = DynamicSize>
+class SizedBitboard
+{
+public:
+	explicit SizedBitboard(const SizedBoard<W, H>& board)
+		:
+		wordCount(board.GetWordCount()),
+		words(board.GetWordCount())
+	{
+		Clear();
+	}
+	void Clear()
+	{
+		for (int w = 0; w < GetWordCount(); ++w)
+		{
+			words[w] = 0u;
+		}
+	}
+	void Set(int cell)
+	{
+		words[cell >> 6] |= uint64_t(1) << (cell & 63);
+	}
+	void Reset(int cell)
+	{
+		words[cell >> 6] &= ~(uint64_t(1) << (cell & 63));
+	}
+	bool Test(int cell) const
+	{
+		return (words[cell >> 6] >> (cell & 63)) & 1u;
+	}
+private:
+	int GetWordCount() const
+	{
+		return SizedBoard<W, H>::IsFixed ? SizedBoard<W, H>::FixedWords : wordCount;
+	}
+private:
+	int wordCount;
+	SizedArray<uint64_t, SizedBoard<W, H>::FixedWords> words;
+};
@@ -0,0 +1,165 @@
+#pragma once
+#include "Rng.h"
+#include "Simulation.h"
+#include "SizedBoard.h"
+
+// The snake rules of Simulation on an open board of a size fixed at compile
+// time, SizedGame<W, H>, or given at run time, SizedGame<>, for runs that
+// step huge numbers of games on one of a few board sizes. A game plays out
+// exactly as GameState does under Snake::Steer and Simulation::Step on a
+// Board of that size: the same moves, growth, food draws and game over.
+// The body is a ring of cell indices and the occupancy a bitboard, so a move
+// touches the new head and the old tail only, and a collision test is one
+// bit; GameState's Snake shifts every segment on each move and Simulation
+// ticks Timer times per move.
+template<int W = DynamicSize, int H = DynamicSize>
+class SizedGame
+{
+public:
+	using BoardType = SizedBoard<W, H>;
+public:
+	explicit SizedGame(int width = W, int height = H)
+		:
+		board(width, height),
+		occupied(board),
+		ringMask(CeilPowerOfTwo(width * height) - 1),
+		ring(CeilPowerOfTwo(width * height))
+	{}
+	// like Simulation::Reset: the snake at the start Board uses, (10,10) on the
+	// 30x25 board, heading right
+	void Reset(uint64_t seed)
+	{
+		rng.Seed(seed);
+		occupied.Clear();
+		head = { board.GetWidth() / 3,board.GetHeight() * 2 / 5 };
+		front = 0;
+		ring[0] = board.Index(head);
+		occupied.Set(ring[0]);
+		length = 1;
+		dir = Direction::Right;
+		over = false;
+		moved = false;
+		PlaceFood();
+	}
+	// Snake::Steer towards new_dir, then Simulation::Step
+	void Step(Direction new_dir)
+	{
+		if (over)
+		{
+			return;
+		}
+		// only turns across the axis of the last move
+		if ((int(new_dir) >> 1) != (int(dir) >> 1))
+		{
+			dir = new_dir;
+		}
+		// Simulation checks for food on every tick: Timer times before the
+		// first move, then once more before each move after the Timer - 1 ticks
+		// that follow the previous one
+		Eat(moved ? 1 : Simulation::Timer);
+		if (!IsSafe(dir))
+		{
+			over = true;
+			return;
+		}
+		Move();
+		moved = true;
+		Eat(Simulation::Timer - 1);
+	}
+	// whether a move in dir keeps the game going, as Simulation::CheckForGameOver judges it
+	bool IsSafe(Direction d) const
+	{
+		const Location next = head.Add(ToDelta(d));
+		if (length >= board.GetCellCount() || !board.IsInside(next))
+		{
+			return false;
+		}
+		// the tail moves out of the way, unless it is doubled up after growing
+		const int cell = board.Index(next);
+		return !occupied.Test(cell) || (cell == GetTail() && !TailStays());
+	}
+	bool IsOver() const
+	{
+		return over;
+	}
+	int GetLength() const
+	{
+		return length;
+	}
+	Location GetHead() const
+	{
+		return head;
+	}
+	Location GetFood() const
+	{
+		return food;
+	}
+	Direction GetDirection() const
+	{
+		return dir;
+	}
+	const BoardType& GetBoard() const
+	{
+		return board;
+	}
+private:
+	int GetTail() const
+	{
+		return ring[(front + length - 1) & GetRingMask()];
+	}
+	bool TailStays() const
+	{
+		return length >= 2 && ring[(front + length - 2) & GetRingMask()] == GetTail();
+	}
+	int GetRingMask() const
+	{
+		return BoardType::IsFixed ? CeilPowerOfTwo(W * H) - 1 : ringMask;
+	}
+	void Move()
+	{
+		const int tail = GetTail();
+		if (!TailStays())
+		{
+			occupied.Reset(tail);
+		}
+		head = head.Add(ToDelta(dir));
+		front = (front - 1) & GetRingMask();
+		ring[front] = board.Index(head);
+		occupied.Set(ring[front]);
+	}
+	void Eat(int checks)
+	{
+		for (int i = 0; i < checks && head == food; ++i)
+		{
+			// the snake cannot outgrow the board, the food moves on regardless
+			if (length < board.GetCellCount())
+			{
+				ring[(front + length) & GetRingMask()] = GetTail();
+				++length;
+			}
+			PlaceFood();
+		}
+	}
+	void PlaceFood()
+	{
+		// Board::RandomFoodCell, which may well land on the snake
+		const int x = rng.Range(1, board.GetWidth() - 1);
+		const int y = rng.Range(1, board.GetHeight() - 1);
+		food = { x,y };
+	}
+private:
+	BoardType board;
+	SizedBitboard<W, H> occupied;
+	int ringMask;
+	// the body's cells, head at ring[front]; a power of two at least the cell count
+	SizedArray<int, BoardType::IsFixed ? CeilPowerOfTwo(W * H) : DynamicSize> ring;
+	int front = 0;
+	int length = 0;
+	Location head;
+	Location food;
+	Direction dir = Direction::Right;
+	bool over = false;
+	// whether the snake has moved since the reset
+	bool moved = false;
+	Rng rng;
+};
@@ -1,26 +1,16 @@
 #include "Snake.h"
+#include "ChiliWin.h"
 
 
-void Snake::InitHead()
+void Snake::InitHead(Location loc, Location new_delta_loc)
 {
-	SegmentNumber[0].SetLocation({ 10,10 });
-	SegmentNumber[0].SetColor({ 255, 120, 0 });
+	SegmentNumber[0].SetLocation(loc);
+	delta_loc = new_delta_loc;
+	prev_delta_loc = new_delta_loc;
 }
 
 void Snake::InitSegment()
 {
-	switch (nSegments % 3)
-	{
-	case 0:
-		SegmentNumber[nSegments].SetColor({ 0,153,0 });
-		break;
-	case 1:
-		SegmentNumber[nSegments].SetColor({ 0,204,0 });
-		break;
-	case 2:
-		SegmentNumber[nSegments].SetColor({ 0,255,0 });
-		break;
-	}
 	SegmentNumber[nSegments].SetLocation(SegmentNumber[nSegments - 1].GetLocation());
 }
 
@@ -28,49 +18,48 @@ void Snake::CheckForInput(Keyboard& kbd)
 {
 	if (kbd.KeyIsPressed(VK_UP))
 	{
-		if (abs(prev_delta_loc.y) + 1 != 2)
-		{
-			delta_loc = { 0,-1 };
-		}
+		Steer({ 0,-1 });
 	}
 
 	if (kbd.KeyIsPressed(VK_DOWN))
 	{
-		if (abs(prev_delta_loc.y) + 1 != 2)
-		{
-			delta_loc = { 0,1 };
-		}
+		Steer({ 0,1 });
 	}
 
 	if (kbd.KeyIsPressed(VK_LEFT))
 	{
-		if (abs(prev_delta_loc.x) + 1 != 2)
-		{
-			delta_loc = { -1,0 };
-		}
+		Steer({ -1,0 });
 	}
 
 	if (kbd.KeyIsPressed(VK_RIGHT))
 	{
-		if (abs(prev_delta_loc.x) + 1 != 2)
-		{
-			delta_loc = { 1,0 };
-		}
+		Steer({ 1,0 });
+	}
+}
+
+void Snake::Steer(Location new_delta_loc)
+{
+	// only turns across the current axis of travel are allowed
+	if ((new_delta_loc.y != 0 && abs(prev_delta_loc.y) + 1 != 2) ||
+		(new_delta_loc.x != 0 && abs(prev_delta_loc.x) + 1 != 2))
+	{
+		delta_loc = new_delta_loc;
 	}
 }
 
-void Snake::Move()
+void Snake::Move(const Board& brd)
 {
 	for (int i = nSegments - 1; i > 0; --i)
 	{
 		SegmentNumber[i].SetLocation(SegmentNumber[i - 1]);
 	}
 	SegmentNumber[0].MoveHead(delta_loc);
+	SegmentNumber[0].SetLocation(brd.Wrap(SegmentNumber[0].GetLocation()));
 	prev_delta_loc = delta_loc;
 }
 
 
-bool Snake::CheckFood(Food& food)
+bool Snake::CheckFood(const Food& food)
 {
 	if (((food.GetLocation().x - SegmentNumber[0].GetLocation().x) == 0) && ((food.GetLocation().y - SegmentNumber[0].GetLocation().y) == 0))
 	{
@@ -99,16 +88,17 @@ void Snake::DrawToBoard(Board& brd)
 {
 	for (int i = nSegments - 1; i > 0; --i)
 	{
-		brd.DrawSegment(SegmentNumber[i].GetColor(), SegmentNumber[i].GetLocation());
+		Color c = GetSegmentColor(i);
+		brd.DrawSegment(c, SegmentNumber[i].GetLocation());
 	}
 
-	
-	brd.DrawSegment(SegmentNumber[0].GetColor(), SegmentNumber[0].GetLocation());
+	Color c = GetSegmentColor(0);
+	brd.DrawSegment(c, SegmentNumber[0].GetLocation());
 }
 
-bool Snake::EatsItself()
+bool Snake::EatsItself(const Board& brd) const
 {
-	Location head_loc_next = SegmentNumber[0].GetLocation().Add(delta_loc);
+	Location head_loc_next = GetNextHeadLocation(brd);
 
 	for (int i = 1; i < nSegments - 1; ++i)
 	{
@@ -120,9 +110,46 @@ bool Snake::EatsItself()
 	return false;
 }
 
-Location & Snake::GetNextHeadLocation() 
+Location Snake::GetNextHeadLocation(const Board& brd) const
 {
-	return SegmentNumber[0].GetLocation().Add(delta_loc);
+	return brd.Wrap(SegmentNumber[0].GetLocation().Add(delta_loc));
+}
+
+int Snake::GetLength() const
+{
+	return nSegments;
+}
+
+Location Snake::GetSegment(int index) const
+{
+	return SegmentNumber[index].GetLocation();
+}
+
+Location Snake::GetDirection() const
+{
+	return delta_loc;
+}
+
+void Snake::SetDirection(Location new_delta_loc)
+{
+	delta_loc = new_delta_loc;
+}
+
+Color Snake::GetSegmentColor(int index)
+{
+	if (index == 0)
+	{
+		return { 255, 120, 0 };
+	}
+	switch (index % 3)
+	{
+	case 0:
+		return { 0,153,0 };
+	case 1:
+		return { 0,204,0 };
+	default:
+		return { 0,255,0 };
+	}
 }
 
 
@@ -145,17 +172,12 @@ void Snake::Segment::SetLocation(Location new_loc)
 	loc = new_loc;
 }
 
-void Snake::Segment::SetColor(Color color)
-{
-	c = color;
-}
-
 Location& Snake::Segment::GetLocation()
 {
 	return loc;
 }
 
-Color& Snake::Segment::GetColor()
+const Location& Snake::Segment::GetLocation() const
 {
-	return c;
+	return loc;
 }
@@ -1,24 +1,29 @@
 #pragma once
-#include "Graphics.h"
 #include "Location.h"
 #include "Board.h"
 #include "Keyboard.h"
 #include "Food.h"
-#include <random>
 
 
 class Snake
 {
 public:
-	void InitHead();
+	void InitHead(Location loc, Location new_delta_loc);
 	void InitSegment();
 	void CheckForInput(Keyboard& kbd);
-	void Move();
-	bool CheckFood(Food& food);
+	// turns towards new_delta_loc unless that would reverse into the body
+	void Steer(Location new_delta_loc);
+	// the head comes back in at the opposite edge of a wrapping board
+	void Move(const Board& brd);
+	bool CheckFood(const Food& food);
 	void Grow();
 	void DrawToBoard(Board& brd);
-	bool EatsItself();
-	Location& GetNextHeadLocation();
+	bool EatsItself(const Board& brd) const;
+	Location GetNextHeadLocation(const Board& brd) const;
+	int GetLength() const;
+	Location GetSegment(int index) const;
+	Location GetDirection() const;
+	void SetDirection(Location new_delta_loc);
 
 private:
 	
@@ -28,17 +33,19 @@ private:
 			void MoveHead(Location& delta_loc);
 			void SetLocation(Segment& new_loc);
 			void SetLocation(Location new_loc);
-			void SetColor(Color color);
 			Location& GetLocation();
-			Color& GetColor();
+			const Location& GetLocation() const;
 		private:
 			Location loc;
-			Color c;
 		};
 
 
 private:
-	static constexpr int MaxSegments = 100;
+	static Color GetSegmentColor(int index);
+
+private:
+	// enough to cover every cell of the 30x25 board
+	static constexpr int MaxSegments = 750;
 	Segment SegmentNumber[MaxSegments];
 	int nSegments = 1;
 	Location delta_loc = { 1, 0 };
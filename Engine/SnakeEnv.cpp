@@ -0,0 +1,127 @@
+#include "SnakeEnv.h"
+#include "Direction.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <cassert>
+
+SnakeEnv::SnakeEnv(int nGames, const Board& brd)
+	:
+	brd(brd),
+	games(nGames),
+	seedSequences(nGames),
+	rewards(nGames),
+	dones(nGames),
+	observations(size_t(nGames) * brd.GetWidth() * brd.GetHeight()),
+	blank(size_t(brd.GetWidth()) * brd.GetHeight(), uint8_t(Empty))
+{
+	assert(nGames > 0);
+	for (int y = 0; y < brd.GetHeight(); ++y)
+	{
+		for (int x = 0; x < brd.GetWidth(); ++x)
+		{
+			if (brd.IsWall({ x,y }))
+			{
+				blank[y * brd.GetWidth() + x] = Body;
+			}
+		}
+	}
+}
+
+void SnakeEnv::Reset(const uint64_t* seeds)
+{
+	for (int i = 0; i < GetGameCount(); ++i)
+	{
+		seedSequences[i].Seed(seeds[i]);
+		ResetGame(i);
+		rewards[i] = 0.0f;
+		dones[i] = 0u;
+	}
+}
+
+void SnakeEnv::Step(const int* actions)
+{
+	for (int i = 0; i < GetGameCount(); ++i)
+	{
+		GameState& state = games[i];
+		const int length = state.snake.GetLength();
+		state.snake.Steer(ToDelta(Direction(actions[i])));
+		Simulation::Step(state, brd);
+		if (state.GameOver)
+		{
+			rewards[i] = DeathReward;
+			dones[i] = 1u;
+			ResetGame(i);
+		}
+		else
+		{
+			rewards[i] = FoodReward * (state.snake.GetLength() - length);
+			dones[i] = 0u;
+			Observe(i);
+		}
+	}
+}
+
+int SnakeEnv::GetGameCount() const
+{
+	return int(games.size());
+}
+
+const Board& SnakeEnv::GetBoard() const
+{
+	return brd;
+}
+
+const GameState& SnakeEnv::GetState(int game) const
+{
+	return games[game];
+}
+
+const GameState* SnakeEnv::GetStates() const
+{
+	return games.data();
+}
+
+const float* SnakeEnv::GetRewards() const
+{
+	return rewards.data();
+}
+
+const uint8_t* SnakeEnv::GetDones() const
+{
+	return dones.data();
+}
+
+const uint8_t* SnakeEnv::GetObservations() const
+{
+	return observations.data();
+}
+
+int SnakeEnv::GetObservationSize() const
+{
+	return brd.GetWidth() * brd.GetHeight();
+}
+
+void SnakeEnv::ResetGame(int game)
+{
+	const uint64_t seed = (uint64_t(seedSequences[game].Next()) << 32) | seedSequences[game].Next();
+	Simulation::Reset(games[game], brd, seed);
+	Observe(game);
+}
+
+void SnakeEnv::Observe(int game)
+{
+	const GameState& state = games[game];
+	const int width = brd.GetWidth();
+	uint8_t* const pCells = observations.data() + size_t(game) * GetObservationSize();
+	std::copy(blank.begin(), blank.end(), pCells);
+
+	const Location food = state.food.GetLocation();
+	pCells[food.y * width + food.x] = Food;
+	for (int i = state.snake.GetLength() - 1; i > 0; --i)
+	{
+		const Location seg = state.snake.GetSegment(i);
+		pCells[seg.y * width + seg.x] = Body;
+	}
+	const Location head = state.snake.GetSegment(0);
+	pCells[head.y * width + head.x] = Head;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "Board.h"
+#include "GameState.h"
+#include "Rng.h"
+#include <cstdint>
+#include <vector>
+
+// Gym-style vectorised environment: N independent games stepped together by
+// one call. Each step is one steering decision (see Simulation::Step), actions
+// are Direction values. Rewards, done flags and observations are written into
+// buffers allocated once in the constructor, so stepping never allocates.
+// A game that ends is reset straight away with a seed drawn from its own
+// seed sequence, and its observation is that of the fresh game.
+class SnakeEnv
+{
+public:
+	enum Cell : uint8_t
+	{
+		Empty,
+		Body,
+		Head,
+		Food
+	};
+	static constexpr float FoodReward = 1.0f;
+	static constexpr float DeathReward = -1.0f;
+public:
+	SnakeEnv(int nGames, const Board& brd = Board());
+	void Reset(const uint64_t* seeds);
+	void Step(const int* actions);
+	int GetGameCount() const;
+	const Board& GetBoard() const;
+	const GameState& GetState(int game) const;
+	// all games, contiguous, e.g. for ObservationEncoder
+	const GameState* GetStates() const;
+	const float* GetRewards() const;
+	const uint8_t* GetDones() const;
+	// nGames x height x width Cell values, row major; a level's walls show as
+	// Body, blocked just the same, which keeps every cell in ExperienceBuffer's two bits
+	const uint8_t* GetObservations() const;
+	int GetObservationSize() const;
+private:
+	void ResetGame(int game);
+	void Observe(int game);
+private:
+	Board brd;
+	std::vector<GameState> games;
+	std::vector<Rng> seedSequences;
+	std::vector<float> rewards;
+	std::vector<uint8_t> dones;
+	std::vector<uint8_t> observations;
+	// an observation of the board alone, walls and nothing else
+	std::vector<uint8_t> blank;
+};
@@ -0,0 +1,226 @@
+#include "SpectatorClient.h"
+#include "SpectatorServer.h"
+#include <stdexcept>
+
+// bounds checked little endian reads over one message
+class SpectatorClient::Reader
+{
+public:
+	Reader(const uint8_t* data_in, size_t size_in)
+		:
+		data(data_in),
+		size(size_in)
+	{}
+	uint32_t Get8()
+	{
+		Need(1);
+		return data[at++];
+	}
+	uint32_t Get16()
+	{
+		Need(2);
+		const uint32_t value = uint32_t(data[at]) | uint32_t(data[at + 1]) << 8;
+		at += 2;
+		return value;
+	}
+	uint32_t Get32()
+	{
+		Need(4);
+		uint32_t value = 0u;
+		for (int b = 0; b < 4; ++b)
+		{
+			value |= uint32_t(data[at + b]) << (8 * b);
+		}
+		at += 4;
+		return value;
+	}
+private:
+	void Need(size_t bytes) const
+	{
+		if (size - at < bytes)
+		{
+			throw std::runtime_error("Spectator message cut short");
+		}
+	}
+private:
+	const uint8_t* data;
+	size_t size;
+	size_t at = 0;
+};
+
+SpectatorClient::SpectatorClient(const std::string& path, int timeoutMs)
+	:
+	socket(UnixSocket::Connect(path, timeoutMs))
+{
+}
+
+int SpectatorClient::Poll()
+{
+	bool closed = false;
+	uint8_t chunk[16384];
+	for (size_t got = socket.Receive(chunk, sizeof(chunk), closed); got > 0;
+		got = socket.Receive(chunk, sizeof(chunk), closed))
+	{
+		inBuffer.insert(inBuffer.end(), chunk, chunk + got);
+	}
+	int applied = 0;
+	size_t at = 0;
+	while (inBuffer.size() - at >= 4)
+	{
+		Reader header(inBuffer.data() + at, 4);
+		const size_t size = header.Get32();
+		if (inBuffer.size() - at - 4 < size)
+		{
+			break;
+		}
+		Apply(inBuffer.data() + at + 4, size);
+		at += 4 + size;
+		++applied;
+	}
+	inBuffer.erase(inBuffer.begin(), inBuffer.begin() + at);
+	if (closed)
+	{
+		throw std::runtime_error("Spectator server disconnected");
+	}
+	return applied;
+}
+
+bool SpectatorClient::IsSynced() const
+{
+	return synced;
+}
+
+int SpectatorClient::GetTick() const
+{
+	return tick;
+}
+
+int SpectatorClient::GetWidth() const
+{
+	return width;
+}
+
+int SpectatorClient::GetHeight() const
+{
+	return height;
+}
+
+int SpectatorClient::GetSnakeCount() const
+{
+	return int(bodies.size());
+}
+
+bool SpectatorClient::IsAlive(int snake) const
+{
+	return !bodies[snake].empty();
+}
+
+int SpectatorClient::GetLength(int snake) const
+{
+	return int(bodies[snake].size());
+}
+
+Location SpectatorClient::GetSegment(int snake, int index) const
+{
+	return ToLocation(bodies[snake][index]);
+}
+
+int SpectatorClient::GetFoodCount() const
+{
+	return int(food.size());
+}
+
+bool SpectatorClient::GetFood(int slot, Location& loc) const
+{
+	if (food[slot] == SpectatorServer::NoCell)
+	{
+		return false;
+	}
+	loc = ToLocation(food[slot]);
+	return true;
+}
+
+int SpectatorClient::GetKeyframeCount() const
+{
+	return keyframes;
+}
+
+void SpectatorClient::Apply(const uint8_t* payload, size_t size)
+{
+	Reader in(payload, size);
+	const SpectatorServer::MessageType type = SpectatorServer::MessageType(in.Get8());
+	const int messageTick = int(in.Get32());
+	if (type == SpectatorServer::MessageType::Keyframe)
+	{
+		width = int(in.Get16());
+		height = int(in.Get16());
+		bodies.assign(in.Get16(), std::deque<uint32_t>());
+		food.assign(in.Get16(), SpectatorServer::NoCell);
+		for (std::deque<uint32_t>& body : bodies)
+		{
+			const uint32_t length = in.Get32();
+			for (uint32_t i = 0; i < length; ++i)
+			{
+				body.push_back(in.Get32());
+			}
+		}
+		for (uint32_t& cell : food)
+		{
+			cell = in.Get32();
+		}
+		tick = messageTick;
+		synced = true;
+		++keyframes;
+		return;
+	}
+	if (type != SpectatorServer::MessageType::Delta)
+	{
+		throw std::runtime_error("Spectator message of unknown type");
+	}
+	if (!synced || messageTick != tick + 1)
+	{
+		synced = false;
+		return;
+	}
+	const uint32_t nSnakes = in.Get16();
+	for (uint32_t i = 0; i < nSnakes; ++i)
+	{
+		const uint32_t snake = in.Get16();
+		const uint32_t change = in.Get8();
+		if (snake >= bodies.size())
+		{
+			throw std::runtime_error("Spectator delta for a snake that does not exist");
+		}
+		std::deque<uint32_t>& body = bodies[snake];
+		if (change & SpectatorServer::Died)
+		{
+			body.clear();
+			continue;
+		}
+		if (change & SpectatorServer::HeadAdded)
+		{
+			body.push_front(in.Get32());
+		}
+		if ((change & SpectatorServer::TailRemoved) && !body.empty())
+		{
+			body.pop_back();
+		}
+	}
+	const uint32_t nFood = in.Get16();
+	for (uint32_t i = 0; i < nFood; ++i)
+	{
+		const uint32_t slot = in.Get16();
+		const uint32_t cell = in.Get32();
+		if (slot >= food.size())
+		{
+			throw std::runtime_error("Spectator delta for a food slot that does not exist");
+		}
+		food[slot] = cell;
+	}
+	tick = messageTick;
+}
+
+Location SpectatorClient::ToLocation(uint32_t cell) const
+{
+	return { int(cell % uint32_t(width)),int(cell / uint32_t(width)) };
+}
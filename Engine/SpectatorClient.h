@@ -0,0 +1,47 @@
+#pragma once
+#include "Location.h"
+#include "UnixSocket.h"
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+// The receiving end of a SpectatorServer: a copy of the arena's snakes and
+// food, kept up to date from the stream. Until the first keyframe, and after a
+// delta that does not follow on, it waits for the next keyframe.
+class SpectatorClient
+{
+public:
+	SpectatorClient(const std::string& path, int timeoutMs = 5000);
+	// applies every whole message that arrived and returns how many; throws when the server is gone
+	int Poll();
+	// whether the copy is complete, as of GetTick
+	bool IsSynced() const;
+	int GetTick() const;
+	int GetWidth() const;
+	int GetHeight() const;
+	int GetSnakeCount() const;
+	bool IsAlive(int snake) const;
+	int GetLength(int snake) const;
+	// index 0 is the head
+	Location GetSegment(int snake, int index) const;
+	int GetFoodCount() const;
+	bool GetFood(int slot, Location& loc) const;
+	int GetKeyframeCount() const;
+private:
+	class Reader;
+private:
+	void Apply(const uint8_t* payload, size_t size);
+	Location ToLocation(uint32_t cell) const;
+private:
+	UnixSocket socket;
+	std::vector<uint8_t> inBuffer;
+	// per snake its cells, head at the front; empty when dead
+	std::vector<std::deque<uint32_t>> bodies;
+	std::vector<uint32_t> food;
+	int width = 0;
+	int height = 0;
+	int tick = -1;
+	bool synced = false;
+	int keyframes = 0;
+};
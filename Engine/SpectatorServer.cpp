@@ -0,0 +1,266 @@
+#include "SpectatorServer.h"
+#include <algorithm>
+#include <stdexcept>
+
+constexpr uint32_t SpectatorServer::NoCell;
+
+namespace
+{
+	void Put16(std::vector<uint8_t>& out, uint32_t value)
+	{
+		out.push_back(uint8_t(value));
+		out.push_back(uint8_t(value >> 8));
+	}
+
+	void Put32(std::vector<uint8_t>& out, uint32_t value)
+	{
+		for (int b = 0; b < 4; ++b)
+		{
+			out.push_back(uint8_t(value >> (8 * b)));
+		}
+	}
+
+	void Patch16(std::vector<uint8_t>& out, size_t at, uint32_t value)
+	{
+		out[at] = uint8_t(value);
+		out[at + 1] = uint8_t(value >> 8);
+	}
+
+	uint32_t CellOf(const Arena& arena, Location loc)
+	{
+		return uint32_t(loc.y) * uint32_t(arena.GetWidth()) + uint32_t(loc.x);
+	}
+
+	uint32_t FoodCell(const Arena& arena, int slot)
+	{
+		Location loc;
+		return arena.GetFood(slot, loc) ? CellOf(arena, loc) : SpectatorServer::NoCell;
+	}
+
+	// the size field first, filled in once the message is complete
+	std::vector<uint8_t> BeginMessage(SpectatorServer::MessageType type, int tick)
+	{
+		std::vector<uint8_t> out;
+		Put32(out, 0u);
+		out.push_back(uint8_t(type));
+		Put32(out, uint32_t(tick));
+		return out;
+	}
+
+	void EndMessage(std::vector<uint8_t>& out)
+	{
+		const uint32_t size = uint32_t(out.size() - 4);
+		for (int b = 0; b < 4; ++b)
+		{
+			out[b] = uint8_t(size >> (8 * b));
+		}
+	}
+}
+
+SpectatorServer::SpectatorServer(const std::string& path, size_t maxQueuedBytes_in)
+	:
+	listener(UnixSocket::Listen(path, 64)),
+	maxQueuedBytes(maxQueuedBytes_in)
+{
+}
+
+void SpectatorServer::Publish(const Arena& arena)
+{
+	Flush();
+	for (Subscriber& subscriber : subscribers)
+	{
+		if (subscriber.queuedBytes > maxQueuedBytes)
+		{
+			// a message partly on its way has to go out whole, the rest is replaced by a keyframe
+			const size_t keep = subscriber.offset > 0 ? 1 : 0;
+			while (subscriber.queue.size() > keep)
+			{
+				subscriber.queuedBytes -= subscriber.queue.back()->size();
+				subscriber.queue.pop_back();
+			}
+			subscriber.needsKeyframe = true;
+			++resyncs;
+		}
+	}
+	// deltas only follow on from the tick before in the same arena
+	const bool follows = lastTick >= 0 && arena.GetTick() == lastTick + 1 &&
+		int(lastLength.size()) == arena.GetSnakeCount() && int(lastFood.size()) == arena.GetFoodCount();
+	Message keyframe;
+	Message delta;
+	for (Subscriber& subscriber : subscribers)
+	{
+		if (subscriber.needsKeyframe || !follows)
+		{
+			if (!keyframe)
+			{
+				keyframe = EncodeKeyframe(arena);
+				lastKeyframeSize = keyframe->size();
+			}
+			Enqueue(subscriber, keyframe);
+			subscriber.needsKeyframe = false;
+		}
+		else
+		{
+			if (!delta)
+			{
+				delta = EncodeDelta(arena);
+				lastDeltaSize = delta->size();
+			}
+			Enqueue(subscriber, delta);
+		}
+	}
+	Remember(arena);
+	Flush();
+}
+
+void SpectatorServer::Flush()
+{
+	for (UnixSocket peer = listener.Accept(); peer.IsOpen(); peer = listener.Accept())
+	{
+		subscribers.emplace_back();
+		subscribers.back().socket = std::move(peer);
+	}
+	for (Subscriber& subscriber : subscribers)
+	{
+		bool lost = false;
+		while (!subscriber.queue.empty() && !lost)
+		{
+			const std::vector<uint8_t>& front = *subscriber.queue.front();
+			const size_t sent = subscriber.socket.Send(front.data() + subscriber.offset, front.size() - subscriber.offset,
+				lost);
+			if (sent == 0)
+			{
+				break;
+			}
+			subscriber.offset += sent;
+			subscriber.queuedBytes -= sent;
+			if (subscriber.offset == front.size())
+			{
+				subscriber.queue.pop_front();
+				subscriber.offset = 0;
+			}
+		}
+		if (lost)
+		{
+			// dropped below
+			subscriber.socket = UnixSocket();
+		}
+	}
+	subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(), [](const Subscriber& subscriber)
+	{
+		return !subscriber.socket.IsOpen();
+	}), subscribers.end());
+}
+
+int SpectatorServer::GetSubscriberCount() const
+{
+	return int(subscribers.size());
+}
+
+int SpectatorServer::GetResyncCount() const
+{
+	return resyncs;
+}
+
+size_t SpectatorServer::GetLastDeltaSize() const
+{
+	return lastDeltaSize;
+}
+
+size_t SpectatorServer::GetLastKeyframeSize() const
+{
+	return lastKeyframeSize;
+}
+
+SpectatorServer::Message SpectatorServer::EncodeKeyframe(const Arena& arena) const
+{
+	if (arena.GetWidth() > 0xFFFF || arena.GetHeight() > 0xFFFF || arena.GetSnakeCount() > 0xFFFF ||
+		arena.GetFoodCount() > 0xFFFF)
+	{
+		throw std::runtime_error("Arena too large for the spectator stream");
+	}
+	std::vector<uint8_t> out = BeginMessage(MessageType::Keyframe, arena.GetTick());
+	Put16(out, uint32_t(arena.GetWidth()));
+	Put16(out, uint32_t(arena.GetHeight()));
+	Put16(out, uint32_t(arena.GetSnakeCount()));
+	Put16(out, uint32_t(arena.GetFoodCount()));
+	for (int s = 0; s < arena.GetSnakeCount(); ++s)
+	{
+		const int length = arena.IsAlive(s) ? arena.GetLength(s) : 0;
+		Put32(out, uint32_t(length));
+		for (int i = 0; i < length; ++i)
+		{
+			Put32(out, CellOf(arena, arena.GetSegment(s, i)));
+		}
+	}
+	for (int slot = 0; slot < arena.GetFoodCount(); ++slot)
+	{
+		Put32(out, FoodCell(arena, slot));
+	}
+	EndMessage(out);
+	return std::make_shared<const std::vector<uint8_t>>(std::move(out));
+}
+
+SpectatorServer::Message SpectatorServer::EncodeDelta(const Arena& arena) const
+{
+	std::vector<uint8_t> out = BeginMessage(MessageType::Delta, arena.GetTick());
+	size_t countAt = out.size();
+	Put16(out, 0u);
+	uint32_t count = 0u;
+	for (int s = 0; s < arena.GetSnakeCount(); ++s)
+	{
+		if (lastLength[s] == 0)
+		{
+			continue;
+		}
+		Put16(out, uint32_t(s));
+		++count;
+		if (!arena.IsAlive(s))
+		{
+			out.push_back(uint8_t(Died));
+			continue;
+		}
+		// a living snake moves every step, only the tail tells whether it ate
+		out.push_back(uint8_t(HeadAdded | (arena.GetLength(s) == lastLength[s] ? TailRemoved : 0)));
+		Put32(out, CellOf(arena, arena.GetSegment(s, 0)));
+	}
+	Patch16(out, countAt, count);
+
+	countAt = out.size();
+	Put16(out, 0u);
+	count = 0u;
+	for (int slot = 0; slot < arena.GetFoodCount(); ++slot)
+	{
+		const uint32_t cell = FoodCell(arena, slot);
+		if (cell != lastFood[slot])
+		{
+			Put16(out, uint32_t(slot));
+			Put32(out, cell);
+			++count;
+		}
+	}
+	Patch16(out, countAt, count);
+	EndMessage(out);
+	return std::make_shared<const std::vector<uint8_t>>(std::move(out));
+}
+
+void SpectatorServer::Remember(const Arena& arena)
+{
+	lastTick = arena.GetTick();
+	lastLength.resize(arena.GetSnakeCount());
+	for (int s = 0; s < arena.GetSnakeCount(); ++s)
+	{
+		lastLength[s] = arena.IsAlive(s) ? arena.GetLength(s) : 0;
+	}
+	lastFood.resize(arena.GetFoodCount());
+	for (int slot = 0; slot < arena.GetFoodCount(); ++slot)
+	{
+		lastFood[slot] = FoodCell(arena, slot);
+	}
+}
+
+void SpectatorServer::Enqueue(Subscriber& subscriber, const Message& message)
+{
+	subscriber.queue.push_back(message);
+	subscriber.queuedBytes += message->size();
+}
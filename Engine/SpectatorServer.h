@@ -0,0 +1,74 @@
+#pragma once
+#include "Arena.h"
+#include "UnixSocket.h"
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Streams an Arena to any number of spectators over Unix sockets. Publish,
+// called after every Step, encodes what changed since the last tick once and
+// queues that same buffer for every subscriber: heads added, tails removed,
+// deaths and food that moved. A subscriber joining gets a keyframe with the
+// whole arena first. Sending never waits; a subscriber whose queue grows past
+// maxQueuedBytes loses its unsent messages and gets a keyframe instead.
+// Messages, little endian: u32 size of the rest, u8 MessageType, u32 tick, then
+// - Keyframe: u16 width, u16 height, u16 snakes, u16 food slots, per snake
+//   u32 length (0 if dead) and its cells head first, per food slot u32 cell
+// - Delta: u16 count, per changed snake u16 index, u8 Change bits and the new
+//   head's u32 cell with HeadAdded; u16 count, per moved food u16 slot, u32 cell
+// Cells are y * width + x, NoCell for none.
+class SpectatorServer
+{
+public:
+	enum class MessageType : uint8_t
+	{
+		Keyframe = 1,
+		Delta = 2
+	};
+	enum Change : uint8_t
+	{
+		HeadAdded = 1,
+		TailRemoved = 2,
+		Died = 4
+	};
+	static constexpr uint32_t NoCell = 0xFFFFFFFF;
+public:
+	SpectatorServer(const std::string& path, size_t maxQueuedBytes = size_t(1) << 20);
+	void Publish(const Arena& arena);
+	// takes on waiting subscribers and sends what the OS accepts; Publish does this too
+	void Flush();
+	int GetSubscriberCount() const;
+	// times a slow subscriber was set back to a keyframe
+	int GetResyncCount() const;
+	size_t GetLastDeltaSize() const;
+	size_t GetLastKeyframeSize() const;
+private:
+	using Message = std::shared_ptr<const std::vector<uint8_t>>;
+	struct Subscriber
+	{
+		UnixSocket socket;
+		std::deque<Message> queue;
+		// bytes of the front message already sent
+		size_t offset = 0;
+		size_t queuedBytes = 0;
+		bool needsKeyframe = true;
+	};
+private:
+	Message EncodeKeyframe(const Arena& arena) const;
+	Message EncodeDelta(const Arena& arena) const;
+	void Remember(const Arena& arena);
+	static void Enqueue(Subscriber& subscriber, const Message& message);
+private:
+	UnixSocket listener;
+	size_t maxQueuedBytes;
+	std::vector<Subscriber> subscribers;
+	// the arena as last published
+	int lastTick = -1;
+	std::vector<int> lastLength;
+	std::vector<uint32_t> lastFood;
+	int resyncs = 0;
+	size_t lastDeltaSize = 0;
+	size_t lastKeyframeSize = 0;
+};
@@ -0,0 +1,50 @@
+#include "StateHistory.h"
+#include <cassert>
+#include <cstring>
+
+StateHistory::StateHistory(int capacity)
+	:
+	slots(capacity)
+{
+	assert(capacity > 0);
+}
+
+void StateHistory::Clear()
+{
+	head = 0;
+	count = 0;
+}
+
+void StateHistory::Push(const GameState& state)
+{
+	std::memcpy(&slots[head], &state, sizeof(GameState));
+	head = (head + 1) % GetCapacity();
+	if (count < GetCapacity())
+	{
+		++count;
+	}
+}
+
+bool StateHistory::Rollback(int ticksBack, GameState& state)
+{
+	if (ticksBack < 0 || ticksBack >= count)
+	{
+		return false;
+	}
+	const int index = (head - 1 - ticksBack + GetCapacity()) % GetCapacity();
+	std::memcpy(&state, &slots[index], sizeof(GameState));
+	// everything newer than the restored state is now in the future, so forget it
+	head = (index + 1) % GetCapacity();
+	count -= ticksBack;
+	return true;
+}
+
+int StateHistory::GetCount() const
+{
+	return count;
+}
+
+int StateHistory::GetCapacity() const
+{
+	return int(slots.size());
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "GameState.h"
+#include <vector>
+
+// Ring of the last few GameStates. All slots are allocated up front, so
+// pushing and rolling back are plain memcpys with no allocation.
+class StateHistory
+{
+public:
+	StateHistory(int capacity);
+	void Clear();
+	void Push(const GameState& state);
+	// restores the state from ticksBack pushes ago (0 = the most recent one)
+	bool Rollback(int ticksBack, GameState& state);
+	int GetCount() const;
+	int GetCapacity() const;
+private:
+	std::vector<GameState> slots;
+	int head = 0;
+	int count = 0;
+};
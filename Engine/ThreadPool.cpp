@@ -0,0 +1,99 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(int threads)
+{
+	if (threads <= 0)
+	{
+		threads = std::max(1, int(std::thread::hardware_concurrency()));
+	}
+	for (int t = 1; t < threads; ++t)
+	{
+		workers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+int ThreadPool::GetThreadCount() const
+{
+	return int(workers.size()) + 1;
+}
+
+void ThreadPool::ParallelFor(int count_in, const std::function<void(int index)>& job_in)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &job_in;
+		count = count_in;
+		next = 0;
+		active = int(workers.size());
+		error = nullptr;
+		++round;
+	}
+	wake.notify_all();
+	RunIndices();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this] { return active == 0; });
+	job = nullptr;
+	if (error)
+	{
+		std::rethrow_exception(error);
+	}
+}
+
+void ThreadPool::WorkerLoop()
+{
+	unsigned int seen = 0u;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [&] { return stopping || round != seen; });
+			if (stopping)
+			{
+				return;
+			}
+			seen = round;
+		}
+		RunIndices();
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--active == 0)
+		{
+			finished.notify_one();
+		}
+	}
+}
+
+void ThreadPool::RunIndices()
+{
+	for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+	{
+		try
+		{
+			(*job)(i);
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!error)
+			{
+				error = std::current_exception();
+			}
+			// skip whatever is left
+			next = count;
+		}
+	}
+}
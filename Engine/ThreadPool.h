@@ -0,0 +1,42 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops. ParallelFor hands the
+// indices out one at a time to the workers and to the calling thread, which
+// works along, and returns once every index is done. Jobs should write their
+// results by index, so the outcome never depends on which thread ran what.
+class ThreadPool
+{
+public:
+	// threads counts the calling thread too; 0 = one per hardware thread
+	ThreadPool(int threads = 0);
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	int GetThreadCount() const;
+	// the first exception thrown by a job is rethrown here once all threads have stopped
+	void ParallelFor(int count, const std::function<void(int index)>& job);
+private:
+	void WorkerLoop();
+	void RunIndices();
+private:
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable finished;
+	const std::function<void(int)>* job = nullptr;
+	int count = 0;
+	std::atomic<int> next{ 0 };
+	// workers still busy with the current loop
+	int active = 0;
+	// bumped for every loop, so a worker knows there is new work
+	unsigned int round = 0u;
+	bool stopping = false;
+	std::exception_ptr error;
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include "Location.h"
+
+// Wrapping of coordinates on a toroidal board, where leaving one edge enters
+// again from the opposite one. Everything moves a cell at a time, so a
+// coordinate is never more than one cell off the board: wrapping it takes two
+// compares and a multiply-add, with no branch for the predictor to miss. With
+// the size known at compile time and a power of two it is a single mask.
+
+constexpr bool IsPowerOfTwo(int v)
+{
+	return v > 0 && (v & (v - 1)) == 0;
+}
+
+// v in [-1, size]
+inline int WrapCoordinate(int v, int size)
+{
+	return v + size * (int(v < 0) - int(v >= size));
+}
+
+template<int Size>
+inline int WrapCoordinate(int v)
+{
+	// the condition is a constant, so only one side is left after compiling
+	return IsPowerOfTwo(Size) ? v & (Size - 1) : WrapCoordinate(v, Size);
+}
+
+inline Location WrapLocation(Location loc, int width, int height)
+{
+	return { WrapCoordinate(loc.x, width),WrapCoordinate(loc.y, height) };
+}
+
+template<int Width, int Height>
+inline Location WrapLocation(Location loc)
+{
+	return { WrapCoordinate<Width>(loc.x),WrapCoordinate<Height>(loc.y) };
+}
+
+// steps between two coordinates of a ring of size cells, the shorter way round
+inline int RingDistance(int a, int b, int size)
+{
+	const int d = a > b ? a - b : b - a;
+	return d < size - d ? d : size - d;
+}
@@ -0,0 +1,87 @@
+#include "TraceWriter.h"
+#include <chrono>
+#include <stdexcept>
+
+TraceWriter::TraceWriter(const std::string& filename)
+	:
+	out(filename),
+	batch(DrainBatch)
+{
+	if (!out)
+	{
+		throw std::runtime_error("Could not open trace file for writing: " + filename);
+	}
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	out.setf(std::ios::fixed);
+	out.precision(3);
+	Profiler::SetTracing(true);
+	worker = std::thread(&TraceWriter::Run, this);
+}
+
+TraceWriter::~TraceWriter()
+{
+	Profiler::SetTracing(false);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_one();
+	worker.join();
+	// pick up whatever was recorded between the last drain and tracing going off
+	Drain();
+	out << "\n]}\n";
+}
+
+uint64_t TraceWriter::GetWrittenSpans() const
+{
+	return writtenSpans.load(std::memory_order_relaxed);
+}
+
+void TraceWriter::Run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (!stopping)
+	{
+		wake.wait_for(lock, std::chrono::milliseconds(10));
+		lock.unlock();
+		Drain();
+		lock.lock();
+	}
+}
+
+void TraceWriter::Drain()
+{
+	WriteThreadNames();
+	const double usPerCycle = 1000.0 / Profiler::GetCyclesPerMs();
+	const uint64_t startCycles = Profiler::GetStartCycles();
+	for (int thread = 0; thread < Profiler::GetThreadCount(); ++thread)
+	{
+		int n;
+		while ((n = Profiler::DrainSpans(thread, batch.data(), DrainBatch)) > 0)
+		{
+			for (int i = 0; i < n; ++i)
+			{
+				const Profiler::Span& span = batch[i];
+				out << (firstEvent ? "" : ",\n")
+					<< "{\"name\":\"" << Profiler::GetScopeName(span.scope)
+					<< "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+					<< ",\"ts\":" << double(span.start - startCycles) * usPerCycle
+					<< ",\"dur\":" << double(span.end - span.start) * usPerCycle << '}';
+				firstEvent = false;
+			}
+			writtenSpans.fetch_add(uint64_t(n), std::memory_order_relaxed);
+		}
+	}
+	out.flush();
+}
+
+void TraceWriter::WriteThreadNames()
+{
+	for (; namedThreads < Profiler::GetThreadCount(); ++namedThreads)
+	{
+		out << (firstEvent ? "" : ",\n")
+			<< "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << namedThreads
+			<< ",\"args\":{\"name\":\"" << Profiler::GetThreadName(namedThreads) << "\"}}";
+		firstEvent = false;
+	}
+}
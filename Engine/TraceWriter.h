@@ -0,0 +1,38 @@
+#pragma once
+#include "Profiler.h"
+#include <atomic>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Streams profiler spans from every thread to a Chrome trace-event JSON file
+// (load it in chrome://tracing or ui.perfetto.dev), one track per thread.
+// Spans are drained and written by a background thread, so the only cost to
+// the threads being traced is pushing into their bounded span queues.
+class TraceWriter
+{
+public:
+	TraceWriter(const std::string& filename);
+	TraceWriter(const TraceWriter&) = delete;
+	TraceWriter& operator=(const TraceWriter&) = delete;
+	~TraceWriter();
+	uint64_t GetWrittenSpans() const;
+private:
+	void Run();
+	void Drain();
+	void WriteThreadNames();
+private:
+	static constexpr int DrainBatch = 4096;
+	std::ofstream out;
+	std::vector<Profiler::Span> batch;
+	int namedThreads = 0;
+	bool firstEvent = true;
+	std::atomic<uint64_t> writtenSpans{ 0u };
+	std::mutex mutex;
+	std::condition_variable wake;
+	bool stopping = false;
+	std::thread worker;
+};
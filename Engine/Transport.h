@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A connection to one peer that carries whole messages, in order and without
+// loss. Neither call waits for the peer, so a game loop can poll every frame.
+// A lost connection is thrown as std::runtime_error.
+class Transport
+{
+public:
+	// messages up to this many bytes
+	static constexpr size_t MaxMessage = 255;
+public:
+	virtual ~Transport() = default;
+	virtual void Send(const uint8_t* data, size_t size) = 0;
+	// the oldest message not yet received, false if none has arrived
+	virtual bool Receive(std::vector<uint8_t>& message) = 0;
+	// payload bytes passed to Send so far
+	uint64_t GetBytesSent() const
+	{
+		return bytesSent;
+	}
+protected:
+	uint64_t bytesSent = 0u;
+};
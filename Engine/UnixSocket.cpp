@@ -0,0 +1,197 @@
+#include "UnixSocket.h"
+#include "ChiliWin.h"
+// Winsock's select takes 64 sockets unless told otherwise
+#define FD_SETSIZE 1024
+#include <winsock2.h>
+#include <afunix.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#pragma comment( lib,"ws2_32.lib" )
+
+namespace
+{
+	// Winsock has to be started once per process before the first socket
+	void StartWinsock()
+	{
+		static const bool started = []()
+		{
+			WSADATA data;
+			if (WSAStartup(MAKEWORD(2, 2), &data) != 0)
+			{
+				throw std::runtime_error("Could not start Winsock");
+			}
+			return true;
+		}();
+		(void)started;
+	}
+
+	sockaddr_un MakeAddress(const std::string& path)
+	{
+		sockaddr_un address = {};
+		address.sun_family = AF_UNIX;
+		if (path.size() >= sizeof(address.sun_path))
+		{
+			throw std::runtime_error("Unix socket path too long: " + path);
+		}
+		std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+		return address;
+	}
+
+	SOCKET OpenSocket()
+	{
+		StartWinsock();
+		const SOCKET s = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (s == INVALID_SOCKET)
+		{
+			throw std::runtime_error("Could not create a Unix socket");
+		}
+		return s;
+	}
+}
+
+UnixSocket UnixSocket::Listen(const std::string& path, int backlog)
+{
+	const sockaddr_un address = MakeAddress(path);
+	DeleteFileA(path.c_str());
+	UnixSocket listener{ uintptr_t(OpenSocket()) };
+	if (bind(SOCKET(listener.handle), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+		listen(SOCKET(listener.handle), backlog) == SOCKET_ERROR)
+	{
+		throw std::runtime_error("Could not listen on Unix socket: " + path);
+	}
+	listener.path = path;
+	return listener;
+}
+
+UnixSocket UnixSocket::Connect(const std::string& path, int timeoutMs)
+{
+	const sockaddr_un address = MakeAddress(path);
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+	for (;;)
+	{
+		const SOCKET s = OpenSocket();
+		if (connect(s, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != SOCKET_ERROR)
+		{
+			return UnixSocket(uintptr_t(s));
+		}
+		closesocket(s);
+		if (std::chrono::steady_clock::now() >= deadline)
+		{
+			throw std::runtime_error("Could not connect to Unix socket: " + path);
+		}
+		// the listener may not be up yet
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+}
+
+void UnixSocket::Wait(const std::vector<const UnixSocket*>& readers, const std::vector<const UnixSocket*>& writers,
+	int timeoutMs)
+{
+	fd_set readSet;
+	fd_set writeSet;
+	FD_ZERO(&readSet);
+	FD_ZERO(&writeSet);
+	// Windows ignores the first argument of select, elsewhere it is the highest handle + 1
+	uintptr_t highest = 0;
+	for (const UnixSocket* socket : readers)
+	{
+		FD_SET(SOCKET(socket->handle), &readSet);
+		highest = std::max(highest, socket->handle);
+	}
+	for (const UnixSocket* socket : writers)
+	{
+		FD_SET(SOCKET(socket->handle), &writeSet);
+		highest = std::max(highest, socket->handle);
+	}
+	timeval timeout;
+	timeout.tv_sec = timeoutMs / 1000;
+	timeout.tv_usec = (timeoutMs % 1000) * 1000;
+	select(int(highest + 1), &readSet, &writeSet, nullptr, &timeout);
+}
+
+UnixSocket::UnixSocket(uintptr_t handle_in)
+	:
+	handle(handle_in)
+{
+	u_long nonBlocking = 1;
+	ioctlsocket(SOCKET(handle), FIONBIO, &nonBlocking);
+}
+
+UnixSocket::UnixSocket(UnixSocket&& other)
+	:
+	handle(other.handle),
+	path(std::move(other.path))
+{
+	other.handle = ~uintptr_t(0);
+	other.path.clear();
+}
+
+UnixSocket& UnixSocket::operator=(UnixSocket&& other)
+{
+	if (this != &other)
+	{
+		Close();
+		handle = other.handle;
+		path = std::move(other.path);
+		other.handle = ~uintptr_t(0);
+		other.path.clear();
+	}
+	return *this;
+}
+
+UnixSocket::~UnixSocket()
+{
+	Close();
+}
+
+bool UnixSocket::IsOpen() const
+{
+	return handle != ~uintptr_t(0);
+}
+
+UnixSocket UnixSocket::Accept()
+{
+	const SOCKET peer = accept(SOCKET(handle), nullptr, nullptr);
+	return peer == INVALID_SOCKET ? UnixSocket() : UnixSocket(uintptr_t(peer));
+}
+
+size_t UnixSocket::Send(const uint8_t* data, size_t size, bool& closed)
+{
+	const int sent = send(SOCKET(handle), reinterpret_cast<const char*>(data), int(size), 0);
+	if (sent == SOCKET_ERROR)
+	{
+		closed = WSAGetLastError() != WSAEWOULDBLOCK;
+		return 0;
+	}
+	return size_t(sent);
+}
+
+size_t UnixSocket::Receive(uint8_t* data, size_t size, bool& closed)
+{
+	const int got = recv(SOCKET(handle), reinterpret_cast<char*>(data), int(size), 0);
+	if (got == SOCKET_ERROR)
+	{
+		closed = WSAGetLastError() != WSAEWOULDBLOCK;
+		return 0;
+	}
+	closed = got == 0 && size > 0;
+	return size_t(got);
+}
+
+void UnixSocket::Close()
+{
+	if (IsOpen())
+	{
+		closesocket(SOCKET(handle));
+		handle = ~uintptr_t(0);
+	}
+	if (!path.empty())
+	{
+		DeleteFileA(path.c_str());
+		path.clear();
+	}
+}
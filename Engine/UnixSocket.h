@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Owner of one non-blocking Unix domain socket (AF_UNIX, Windows 10 1803 or
+// later) named by a file path. Calls never wait for the peer; setup errors
+// are thrown as std::runtime_error.
+class UnixSocket
+{
+public:
+	// listens at path, replacing the socket file of an earlier run
+	static UnixSocket Listen(const std::string& path, int backlog);
+	// retries until a peer listens at path or timeoutMs runs out
+	static UnixSocket Connect(const std::string& path, int timeoutMs);
+	// blocks until one of readers has bytes or a connection waiting, one of
+	// writers can take bytes again, or timeoutMs has passed
+	static void Wait(const std::vector<const UnixSocket*>& readers, const std::vector<const UnixSocket*>& writers,
+		int timeoutMs);
+	UnixSocket() = default;
+	UnixSocket(UnixSocket&& other);
+	UnixSocket& operator=(UnixSocket&& other);
+	UnixSocket(const UnixSocket&) = delete;
+	UnixSocket& operator=(const UnixSocket&) = delete;
+	~UnixSocket();
+	bool IsOpen() const;
+	// the next waiting connection, or a socket that is not open if none is waiting
+	UnixSocket Accept();
+	// the bytes the OS took, 0 when it takes no more right now; closed is set when the connection is gone
+	size_t Send(const uint8_t* data, size_t size, bool& closed);
+	// the bytes that were waiting, 0 when none were; closed is set when the peer hung up
+	size_t Receive(uint8_t* data, size_t size, bool& closed);
+private:
+	explicit UnixSocket(uintptr_t handle);
+	void Close();
+private:
+	uintptr_t handle = ~uintptr_t(0);
+	// a listener removes its socket file when it closes
+	std::string path;
+};
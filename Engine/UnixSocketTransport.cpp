@@ -0,0 +1,87 @@
+#include "UnixSocketTransport.h"
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+std::unique_ptr<UnixSocketTransport> UnixSocketTransport::Listen(const std::string& path)
+{
+	UnixSocket listener = UnixSocket::Listen(path, 1);
+	for (;;)
+	{
+		UnixSocket peer = listener.Accept();
+		if (peer.IsOpen())
+		{
+			return std::unique_ptr<UnixSocketTransport>(new UnixSocketTransport(std::move(peer)));
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+std::unique_ptr<UnixSocketTransport> UnixSocketTransport::Connect(const std::string& path, int timeoutMs)
+{
+	return std::unique_ptr<UnixSocketTransport>(new UnixSocketTransport(UnixSocket::Connect(path, timeoutMs)));
+}
+
+UnixSocketTransport::UnixSocketTransport(UnixSocket socket_in)
+	:
+	socket(std::move(socket_in))
+{
+}
+
+void UnixSocketTransport::Send(const uint8_t* data, size_t size)
+{
+	if (size > MaxMessage)
+	{
+		throw std::runtime_error("Message too long for the transport");
+	}
+	outBuffer.push_back(uint8_t(size));
+	outBuffer.insert(outBuffer.end(), data, data + size);
+	bytesSent += size;
+	Flush();
+}
+
+bool UnixSocketTransport::Receive(std::vector<uint8_t>& message)
+{
+	Flush();
+	uint8_t chunk[4096];
+	while (!closed)
+	{
+		const size_t got = socket.Receive(chunk, sizeof(chunk), closed);
+		if (got == 0)
+		{
+			break;
+		}
+		inBuffer.insert(inBuffer.end(), chunk, chunk + got);
+	}
+	if (!inBuffer.empty() && inBuffer.size() > inBuffer[0])
+	{
+		const size_t size = inBuffer[0];
+		message.assign(inBuffer.begin() + 1, inBuffer.begin() + 1 + size);
+		inBuffer.erase(inBuffer.begin(), inBuffer.begin() + 1 + size);
+		return true;
+	}
+	if (closed)
+	{
+		throw std::runtime_error("Unix socket peer disconnected");
+	}
+	return false;
+}
+
+void UnixSocketTransport::Flush()
+{
+	bool lost = false;
+	while (!outBuffer.empty())
+	{
+		const size_t sent = socket.Send(outBuffer.data(), outBuffer.size(), lost);
+		if (lost)
+		{
+			throw std::runtime_error("Unix socket connection lost");
+		}
+		if (sent == 0)
+		{
+			return;
+		}
+		outBuffer.erase(outBuffer.begin(), outBuffer.begin() + sent);
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include "Transport.h"
+#include "UnixSocket.h"
+#include <memory>
+#include <string>
+
+// A Transport over a UnixSocket. Every message goes out as a length byte and
+// its payload; bytes the OS will not take yet wait in a buffer for the next call.
+class UnixSocketTransport : public Transport
+{
+public:
+	// waits for one peer to connect at path
+	static std::unique_ptr<UnixSocketTransport> Listen(const std::string& path);
+	// retries until a peer listens at path or timeoutMs runs out
+	static std::unique_ptr<UnixSocketTransport> Connect(const std::string& path, int timeoutMs = 5000);
+	void Send(const uint8_t* data, size_t size) override;
+	bool Receive(std::vector<uint8_t>& message) override;
+private:
+	explicit UnixSocketTransport(UnixSocket socket);
+	void Flush();
+private:
+	UnixSocket socket;
+	std::vector<uint8_t> outBuffer;
+	std::vector<uint8_t> inBuffer;
+	// the peer hung up; messages already buffered are still handed out
+	bool closed = false;
+};
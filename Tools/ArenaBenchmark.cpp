@@ -0,0 +1,180 @@
+#include "Commands.h"
+#include "Arena.h"
+#include "BotMatch.h"
+#include "Level.h"
+#include "Stopwatch.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Runs arenas of growing snake counts with a cheap wandering policy and times
+// Arena::Step per snake move, which should stay flat as the count grows. Each
+// run is played twice from the same seed to check the outcome repeats. First,
+// two scripted positions check the collision rules for snakes trading cells.
+namespace
+{
+	// snakes at the level's spawn points, each steered by its own list of moves
+	struct Script
+	{
+		std::vector<Level::Spawn> spawns;
+		std::vector<std::vector<Direction>> moves;
+	};
+
+	// whether each snake is alive once the script has played out on an open 8x8 level
+	// whose only food cell is (2,1)
+	std::vector<bool> PlayScript(const Script& script)
+	{
+		const std::string file = "arena-rules.level";
+		const int size = 8;
+		Level::Write(file, size, size, std::vector<uint8_t>(size * size, 0u), script.spawns, { { 2,1,1,1 } });
+		const Level level(file);
+		ArenaSettings settings;
+		settings.level = &level;
+		settings.snakes = int(script.spawns.size());
+		settings.food = 1;
+		Arena arena(settings);
+		std::vector<Direction> inputs(script.spawns.size());
+		for (size_t t = 0; t < script.moves[0].size(); ++t)
+		{
+			for (size_t s = 0; s < inputs.size(); ++s)
+			{
+				inputs[s] = script.moves[s][t];
+			}
+			arena.Step(inputs.data());
+		}
+		std::vector<bool> alive;
+		for (int s = 0; s < arena.GetSnakeCount(); ++s)
+		{
+			alive.push_back(arena.IsAlive(s));
+		}
+		return alive;
+	}
+
+	// returns the number of positions judged wrongly
+	int CheckTradingCells()
+	{
+		using D = Direction;
+		int errors = 0;
+		// snake 0 eats twice round a 2x2 square and ends up filling three of its
+		// cells, head at (2,1); snake 1, one cell long, comes up into the fourth,
+		// (2,2). Then 0 moves into 1's cell as 1 moves into 0's tail: the four
+		// cells just rotate and both live on
+		Script rotation;
+		rotation.spawns = { { 1,1,uint32_t(D::Right) },{ 4,5,uint32_t(D::Up) } };
+		rotation.moves = {
+			{ D::Right,D::Down,D::Left,D::Up,D::Right,D::Down },
+			{ D::Up,D::Up,D::Left,D::Left,D::Up,D::Left } };
+		const std::vector<bool> rotated = PlayScript(rotation);
+		errors += !rotated[0] || !rotated[1];
+		// two one-cell snakes side by side swap cells, passing through each other: both die
+		Script swap;
+		swap.spawns = { { 4,5,uint32_t(D::Right) },{ 5,5,uint32_t(D::Left) } };
+		swap.moves = { { D::Right },{ D::Left } };
+		const std::vector<bool> swapped = PlayScript(swap);
+		errors += swapped[0] || swapped[1];
+		return errors;
+	}
+
+	struct RunResult
+	{
+		double stepSeconds = 0.0;
+		long long moves = 0;
+		int games = 1;
+		int longest = 0;
+		// sum of lengths and alive flags over the run, compared between the two plays
+		long long checksum = 0;
+		bool gridMatches = true;
+	};
+
+	bool GridMatches(const Arena& arena)
+	{
+		long long occupied = 0;
+		for (int y = 0; y < arena.GetHeight(); ++y)
+		{
+			for (int x = 0; x < arena.GetWidth(); ++x)
+			{
+				occupied += arena.GetOccupant({ x,y }) >= 0;
+			}
+		}
+		long long lengths = 0;
+		for (int s = 0; s < arena.GetSnakeCount(); ++s)
+		{
+			if (arena.IsAlive(s))
+			{
+				lengths += arena.GetLength(s);
+				for (int i = 0; i < arena.GetLength(s); ++i)
+				{
+					if (arena.GetOccupant(arena.GetSegment(s, i)) != s)
+					{
+						return false;
+					}
+				}
+			}
+		}
+		return occupied == lengths;
+	}
+
+	RunResult Play(Arena& arena, int ticks, uint64_t seed)
+	{
+		RunResult result;
+		Rng rng(seed);
+		std::vector<Direction> inputs(arena.GetSnakeCount());
+		arena.Reset(seed);
+		Stopwatch time;
+		for (int t = 0; t < ticks; ++t)
+		{
+			if (arena.GetAliveCount() < 2)
+			{
+				result.gridMatches = result.gridMatches && GridMatches(arena);
+				arena.Reset(seed + result.games++);
+			}
+			for (int s = 0; s < arena.GetSnakeCount(); ++s)
+			{
+				inputs[s] = arena.IsAlive(s) ? Wander(arena, s, rng) : Direction::Up;
+			}
+			result.moves += arena.GetAliveCount();
+			time.Restart();
+			arena.Step(inputs.data());
+			result.stepSeconds += time.GetSeconds();
+			for (int s = 0; s < arena.GetSnakeCount(); ++s)
+			{
+				result.checksum += arena.IsAlive(s) ? arena.GetLength(s) : 0;
+				result.longest = arena.GetLength(s) > result.longest ? arena.GetLength(s) : result.longest;
+			}
+		}
+		result.gridMatches = result.gridMatches && GridMatches(arena);
+		return result;
+	}
+}
+
+int RunArenaBenchmark(int argc, char* argv[])
+{
+	const int ticks = argc > 0 ? std::atoi(argv[0]) : 2000;
+	const int size = argc > 1 ? std::atoi(argv[1]) : 512;
+	const uint64_t seed = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1u;
+
+	const int ruleErrors = CheckTradingCells();
+	std::printf("collision positions judged wrongly: %d\n", ruleErrors);
+	std::printf("%dx%d board, %d steps per run\n", size, size, ticks);
+	std::printf("%8s %12s %14s %8s %8s %9s %6s\n", "snakes", "step us", "ns/snake move", "games", "longest",
+		"repeats", "grid");
+	bool ok = ruleErrors == 0;
+	for (int snakes = 50; snakes <= 1600; snakes *= 2)
+	{
+		ArenaSettings settings;
+		settings.width = size;
+		settings.height = size;
+		settings.snakes = snakes;
+		settings.food = 2 * snakes;
+		Arena arena(settings);
+		const RunResult first = Play(arena, ticks, seed);
+		const RunResult second = Play(arena, ticks, seed);
+		const bool repeats = first.checksum == second.checksum;
+		ok = ok && repeats && first.gridMatches;
+		std::printf("%8d %12.2f %14.1f %8d %8d %9s %6s\n", snakes, 1e6 * first.stepSeconds / ticks,
+			1e9 * first.stepSeconds / double(first.moves), first.games, first.longest, repeats ? "yes" : "NO",
+			first.gridMatches ? "ok" : "BAD");
+	}
+	return ok ? 0 : 1;
+}
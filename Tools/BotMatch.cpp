@@ -0,0 +1,91 @@
+#include "BotMatch.h"
+#include "BfsBot.h"
+#include "HamiltonianBot.h"
+#include "HeuristicBot.h"
+#include "MctsBot.h"
+#include "Simulation.h"
+#include "Stopwatch.h"
+#include <stdexcept>
+
+MatchResult PlayMatch(Bot& bot, const Board& brd, uint64_t seed, int maxTicks)
+{
+	MatchResult result;
+	result.seed = seed;
+	GameState state;
+	Simulation::Reset(state, brd, seed);
+	Stopwatch time;
+	while (!state.GameOver && state.tick < maxTicks)
+	{
+		if (state.counter + 1 >= Simulation::Timer)
+		{
+			time.Restart();
+			const Direction dir = bot.Decide(state, brd);
+			result.decideSeconds += time.GetSeconds();
+			++result.decisions;
+			state.snake.Steer(ToDelta(dir));
+		}
+		Simulation::Tick(state, brd);
+	}
+	result.length = state.snake.GetLength();
+	result.ticks = state.tick;
+	if (state.GameOver)
+	{
+		// the same checks, in the same order, as Simulation::CheckForGameOver
+		if (state.snake.EatsItself(brd))
+		{
+			result.end = MatchEnd::Self;
+		}
+		else if (brd.isOutsideBoard(state.snake.GetNextHeadLocation(brd)) || brd.IsWall(state.snake.GetNextHeadLocation(brd)))
+		{
+			result.end = MatchEnd::Wall;
+		}
+		else
+		{
+			result.end = MatchEnd::BoardFull;
+		}
+	}
+	result.died = result.end == MatchEnd::Wall || result.end == MatchEnd::Self;
+	return result;
+}
+
+std::unique_ptr<Bot> CreateBot(const std::string& name, const Board& brd)
+{
+	if (name == "bfs")
+	{
+		return std::make_unique<BfsBot>(brd);
+	}
+	if (name == "hamiltonian")
+	{
+		return std::make_unique<HamiltonianBot>(brd);
+	}
+	if (name == "heuristic")
+	{
+		return std::make_unique<HeuristicBot>(brd);
+	}
+	if (name == "mcts")
+	{
+		// one thread each: matches already run in parallel
+		MctsSettings settings;
+		settings.iterations = 400;
+		settings.threads = 1;
+		return std::make_unique<MctsBot>(brd, settings);
+	}
+	throw std::runtime_error("Unknown bot: " + name);
+}
+
+Direction Wander(const Arena& arena, int snake, Rng& rng)
+{
+	const Direction dir = arena.GetDirection(snake);
+	const Location head = arena.GetSegment(snake, 0);
+	const int first = rng.Range(0, DirectionCount - 1);
+	for (int k = 0; k < DirectionCount; ++k)
+	{
+		const Direction option = Direction((first + k) % DirectionCount);
+		const Location to = head.Add(ToDelta(option));
+		if (option != Opposite(dir) && arena.IsInside(to) && !arena.IsWall(to) && arena.GetOccupant(to) < 0)
+		{
+			return option;
+		}
+	}
+	return dir;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include "Arena.h"
+#include "Bot.h"
+#include "Rng.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+enum class MatchEnd
+{
+	// still alive when maxTicks ran out
+	Timeout,
+	// the next head position is off the board or on a wall of its level
+	Wall,
+	// the next head position is on the body (Snake::EatsItself)
+	Self,
+	BoardFull
+};
+
+struct MatchResult
+{
+	uint64_t seed = 0u;
+	int length = 0;
+	int ticks = 0;
+	int decisions = 0;
+	bool died = false;
+	MatchEnd end = MatchEnd::Timeout;
+	// time spent inside Bot::Decide
+	double decideSeconds = 0.0;
+};
+
+// Plays one headless game with the bot steering at every decision point, the
+// way the windowed game does, until the game ends or maxTicks have passed.
+MatchResult PlayMatch(Bot& bot, const Board& brd, uint64_t seed, int maxTicks);
+
+// the bots the tools can play by name: bfs, hamiltonian, heuristic, mcts;
+// throws for any other name
+std::unique_ptr<Bot> CreateBot(const std::string& name, const Board& brd);
+
+// a random free neighbour for an arena snake, straight on if none is free;
+// cheap enough to drive hundreds of snakes per step
+Direction Wander(const Arena& arena, int snake, Rng& rng);
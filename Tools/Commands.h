@@ -0,0 +1,23 @@
+#pragma once
+
+// Every tool command takes the arguments after its name and returns the
+// process exit code. Bad arguments and file errors are thrown as std::exception.
+int RunArenaBenchmark(int argc, char* argv[]);
+int RunDistanceFieldBenchmark(int argc, char* argv[]);
+int RunEncodeBenchmark(int argc, char* argv[]);
+int RunEndlessTest(int argc, char* argv[]);
+int RunExperienceBenchmark(int argc, char* argv[]);
+int RunFloodFillBenchmark(int argc, char* argv[]);
+int RunLayoutBenchmark(int argc, char* argv[]);
+int RunLevelTool(int argc, char* argv[]);
+int RunLockstepTest(int argc, char* argv[]);
+int RunMctsBenchmark(int argc, char* argv[]);
+int RunPolicyBenchmark(int argc, char* argv[]);
+int RunRollbackBenchmark(int argc, char* argv[]);
+int RunSimulationRpcBenchmark(int argc, char* argv[]);
+int RunSizedBoardBenchmark(int argc, char* argv[]);
+int RunSoakTest(int argc, char* argv[]);
+int RunSpectatorTest(int argc, char* argv[]);
+int RunTorusTest(int argc, char* argv[]);
+int RunTournament(int argc, char* argv[]);
+int RunTrainGenetic(int argc, char* argv[]);
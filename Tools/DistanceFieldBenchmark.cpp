@@ -0,0 +1,138 @@
+#include "Commands.h"
+#include "DistanceField.h"
+#include "Rng.h"
+#include "Stopwatch.h"
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+
+// Walks a snake towards the food on boards of growing size and keeps two
+// distance fields up to date along the way: one recomputed from scratch every
+// move, one updated incrementally. Both must agree after every move.
+namespace
+{
+	struct Result
+	{
+		double fullSeconds = 0.0;
+		double incrementalSeconds = 0.0;
+		int moves = 0;
+		int foodEaten = 0;
+		long long mismatches = 0;
+	};
+
+	Location RandomFreeCell(Rng& rng, const DistanceField& field)
+	{
+		Location loc;
+		do
+		{
+			loc = { rng.Range(0, field.GetWidth() - 1),rng.Range(0, field.GetHeight() - 1) };
+		} while (field.IsBlocked(loc));
+		return loc;
+	}
+
+	Result Run(int width, int height, int snakeLength, int moves)
+	{
+		static const Location deltas[4] = { { 0,-1 },{ 0,1 },{ -1,0 },{ 1,0 } };
+		Result result;
+		Rng rng(uint64_t(width) * 7919u + height);
+		DistanceField incremental(width, height);
+		DistanceField full(width, height);
+		std::deque<Location> body;
+		body.push_back({ width / 2,height / 2 });
+		incremental.Block(body.front());
+		incremental.Rebuild(RandomFreeCell(rng, incremental));
+
+		for (int m = 0; m < moves; ++m)
+		{
+			// greedy step along the field, any free cell if the food is cut off
+			const Location head = body.front();
+			Location next = head;
+			int best = DistanceField::Unreachable;
+			bool found = false;
+			for (const Location& d : deltas)
+			{
+				const Location n = head.Add(d);
+				if (!incremental.IsBlocked(n) && (!found || incremental.GetDistance(n) < best))
+				{
+					next = n;
+					best = incremental.GetDistance(n);
+					found = true;
+				}
+			}
+			if (!found)
+			{
+				// boxed in: start over with a fresh snake somewhere else
+				incremental.Clear();
+				body.assign(1, RandomFreeCell(rng, incremental));
+				incremental.Block(body.front());
+				incremental.Rebuild(RandomFreeCell(rng, incremental));
+				continue;
+			}
+
+			// the snake grows until it reaches its full length, so the tail only moves after that
+			const bool freesTail = int(body.size()) >= snakeLength;
+			const Location tail = body.back();
+			body.push_front(next);
+			if (freesTail)
+			{
+				body.pop_back();
+			}
+
+			Stopwatch incrementalTime;
+			incremental.Block(next);
+			if (freesTail)
+			{
+				incremental.Unblock(tail);
+			}
+			result.incrementalSeconds += incrementalTime.GetSeconds();
+
+			Stopwatch fullTime;
+			full.Clear();
+			for (const Location& seg : body)
+			{
+				full.Block(seg);
+			}
+			full.Rebuild(incremental.GetTarget());
+			result.fullSeconds += fullTime.GetSeconds();
+			++result.moves;
+
+			for (int y = 0; y < height; ++y)
+			{
+				for (int x = 0; x < width; ++x)
+				{
+					result.mismatches += incremental.GetDistance({ x,y }) != full.GetDistance({ x,y });
+				}
+			}
+
+			if (next == incremental.GetTarget())
+			{
+				++result.foodEaten;
+				incremental.Rebuild(RandomFreeCell(rng, incremental));
+			}
+		}
+		return result;
+	}
+}
+
+int RunDistanceFieldBenchmark(int argc, char* argv[])
+{
+	const int moves = argc > 0 ? std::atoi(argv[0]) : 2000;
+	const int sizes[][2] = { { 30,25 },{ 64,64 },{ 128,128 },{ 256,256 },{ 512,512 },{ 1024,1024 } };
+
+	std::printf("%-11s %6s %9s %9s %9s %8s %6s\n", "board", "snake", "full us", "incr us", "speed-up", "food", "diff");
+	long long mismatches = 0;
+	for (const auto& size : sizes)
+	{
+		const int snakeLength = size[0] + size[1];
+		const Result r = Run(size[0], size[1], snakeLength, moves);
+		const double fullUs = r.fullSeconds * 1e6 / r.moves;
+		const double incrementalUs = r.incrementalSeconds * 1e6 / r.moves;
+		char board[16];
+		std::snprintf(board, sizeof(board), "%dx%d", size[0], size[1]);
+		std::printf("%-11s %6d %9.2f %9.2f %8.1fx %8d %6lld\n", board, snakeLength, fullUs, incrementalUs,
+			fullUs / incrementalUs, r.foodEaten, r.mismatches);
+		mismatches += r.mismatches;
+	}
+	// a difference between the two fields is a bug in the incremental update
+	return mismatches == 0 ? 0 : 1;
+}
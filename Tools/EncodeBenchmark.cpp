@@ -0,0 +1,158 @@
+#include "Commands.h"
+#include "Board.h"
+#include "Direction.h"
+#include "GameState.h"
+#include "ObservationEncoder.h"
+#include "Rng.h"
+#include "Simulation.h"
+#include "Stopwatch.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Encodes a batch of games on the game board into uint8 and float tensors,
+// reports the time per call against the 1 ms budget for 4096 games, and
+// checks every plane against a plain per-cell encoding. The games are played
+// for a while first, mostly towards the food and never into certain death,
+// so the snakes have bodies of all lengths.
+namespace
+{
+	void PlayGames(std::vector<GameState>& games, const Board& brd, int moves)
+	{
+		Rng rng(5u);
+		for (size_t g = 0; g < games.size(); ++g)
+		{
+			GameState& state = games[g];
+			Simulation::Reset(state, brd, g + 1u);
+			const int n = rng.Range(0, moves);
+			for (int m = 0; m < n && !state.GameOver; ++m)
+			{
+				// the safe move closest to the food, now and then any safe move
+				const Location current = state.snake.GetDirection();
+				const Location head = state.snake.GetSegment(0);
+				const Location food = state.food.GetLocation();
+				const bool wander = rng.Range(0, 3) == 0;
+				Location best = current;
+				int bestDist = -1;
+				for (int k = 0; k < DirectionCount; ++k)
+				{
+					const Location delta = ToDelta(Direction(k));
+					state.snake.SetDirection(delta);
+					if (Simulation::CheckForGameOver(state.snake, brd))
+					{
+						continue;
+					}
+					const Location next = head.Add(delta);
+					const int dist = wander ? rng.Range(0, 99) : std::abs(next.x - food.x) + std::abs(next.y - food.y);
+					if (bestDist < 0 || dist < bestDist)
+					{
+						best = delta;
+						bestDist = dist;
+					}
+				}
+				state.snake.SetDirection(current);
+				state.snake.Steer(best);
+				Simulation::Step(state, brd);
+			}
+		}
+	}
+
+	// the level ObservationEncoder gives segment i of a snake of the given length
+	int AgeLevel(int i, int length)
+	{
+		const int scale = (ObservationEncoder::AgeLevels << 16) / (length - 1);
+		return ((length - i) * scale + 0xFFFF) >> 16;
+	}
+
+	int CountMismatches(const std::vector<GameState>& games, const Board& brd, const uint8_t* bytes, const float* floats)
+	{
+		const int cells = brd.GetWidth() * brd.GetHeight();
+		std::vector<int> expected(size_t(ObservationEncoder::PlaneCount) * cells);
+		int mismatches = 0;
+		for (size_t g = 0; g < games.size(); ++g)
+		{
+			std::fill(expected.begin(), expected.end(), 0);
+			const Snake& snake = games[g].snake;
+			const int length = snake.GetLength();
+			// tail first, so the youngest segment on a cell wins
+			for (int i = length - 1; i > 0; --i)
+			{
+				const Location seg = snake.GetSegment(i);
+				expected[ObservationEncoder::BodyPlane * cells + seg.y * brd.GetWidth() + seg.x] = AgeLevel(i, length);
+			}
+			const Location head = snake.GetSegment(0);
+			expected[ObservationEncoder::HeadPlane * cells + head.y * brd.GetWidth() + head.x] = ObservationEncoder::AgeLevels;
+			const Location food = games[g].food.GetLocation();
+			expected[ObservationEncoder::FoodPlane * cells + food.y * brd.GetWidth() + food.x] = ObservationEncoder::AgeLevels;
+			for (int y = 0; y < brd.GetHeight(); ++y)
+			{
+				for (int x = 0; x < brd.GetWidth(); ++x)
+				{
+					if (brd.IsWall({ x,y }))
+					{
+						expected[ObservationEncoder::WallPlane * cells + y * brd.GetWidth() + x] = ObservationEncoder::AgeLevels;
+					}
+				}
+			}
+			const size_t base = g * expected.size();
+			for (size_t i = 0; i < expected.size(); ++i)
+			{
+				mismatches += bytes[base + i] != expected[i] * 17;
+				mismatches += floats[base + i] != float(expected[i]) / ObservationEncoder::AgeLevels;
+			}
+		}
+		return mismatches;
+	}
+}
+
+int RunEncodeBenchmark(int argc, char* argv[])
+{
+	const int nGames = argc > 0 ? std::atoi(argv[0]) : 4096;
+	const int repeats = argc > 1 ? std::atoi(argv[1]) : 50;
+	const int moves = argc > 2 ? std::atoi(argv[2]) : 300;
+
+	const Board brd;
+	std::vector<GameState> games(nGames);
+	PlayGames(games, brd, moves);
+	long long segments = 0;
+	for (const GameState& state : games)
+	{
+		segments += state.snake.GetLength();
+	}
+	const ObservationEncoder encoder(brd);
+	std::vector<uint8_t> bytes(encoder.GetGameSize() * nGames);
+	std::vector<float> floats(bytes.size());
+	// the first call touches the pages, so it is left out of the timings
+	encoder.Encode(games.data(), nGames, bytes.data());
+	encoder.Encode(games.data(), nGames, floats.data());
+
+	double best8 = 1e9;
+	double bestFloat = 1e9;
+	double total8 = 0.0;
+	double totalFloat = 0.0;
+	for (int r = 0; r < repeats; ++r)
+	{
+		Stopwatch time;
+		encoder.Encode(games.data(), nGames, bytes.data());
+		const double t8 = time.GetSeconds();
+		time.Restart();
+		encoder.Encode(games.data(), nGames, floats.data());
+		const double tFloat = time.GetSeconds();
+		best8 = std::min(best8, t8);
+		bestFloat = std::min(bestFloat, tFloat);
+		total8 += t8;
+		totalFloat += tFloat;
+	}
+
+	std::printf("%d games on %dx%d, mean length %.1f, %d calls each\n", nGames, brd.GetWidth(), brd.GetHeight(),
+		double(segments) / nGames, repeats);
+	std::printf("%-6s %10s %10s %10s\n", "planes", "mean ms", "best ms", "GB/s");
+	std::printf("%-6s %10.3f %10.3f %10.2f\n", "uint8", 1000.0 * total8 / repeats, 1000.0 * best8,
+		bytes.size() / best8 / 1e9);
+	std::printf("%-6s %10.3f %10.3f %10.2f\n", "float", 1000.0 * totalFloat / repeats, 1000.0 * bestFloat,
+		bytes.size() * sizeof(float) / bestFloat / 1e9);
+	const int mismatches = CountMismatches(games, brd, bytes.data(), floats.data());
+	std::printf("cells differing from the per-cell encoding: %d\n", mismatches);
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,101 @@
+#include "Commands.h"
+#include "ChunkedWorld.h"
+#include "Direction.h"
+#include "Rng.h"
+#include "Stopwatch.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Walks a head across an endless world as fast as the game loop would let it:
+// one move per Update, mostly straight on, turning now and then and around
+// walls. A move into a cell whose chunk is not ready waits for the next
+// Update, which counts as a stall. Reports the Update and lookup costs, which
+// must stay small since the game loop never waits on the workers, and checks
+// every cell walked over against the generator.
+int RunEndlessTest(int argc, char* argv[])
+{
+	const int moves = argc > 0 ? std::atoi(argv[0]) : 200000;
+	const int nWorkers = argc > 1 ? std::atoi(argv[1]) : 2;
+
+	ChunkedWorldSettings settings;
+	settings.workers = nWorkers;
+	ChunkedWorld world(settings);
+	Rng rng(3u);
+	Location head = { 10,10 };
+	Direction dir = Direction::Right;
+	int moved = 0;
+	int stalls = 0;
+	int mismatches = 0;
+	int highestResident = 0;
+	std::vector<double> updateTimes;
+	updateTimes.reserve(size_t(moves) + moves / 8);
+	uint32_t rows[ChunkedWorld::ChunkSize];
+	Stopwatch total;
+	while (moved < moves)
+	{
+		Stopwatch time;
+		world.Update(head, ToDelta(dir));
+		updateTimes.push_back(time.GetSeconds());
+		highestResident = std::max(highestResident, world.GetResidentCount() + world.GetPendingCount());
+
+		if (rng.Range(0, 15) == 0)
+		{
+			dir = Direction(rng.Range(0, DirectionCount - 1));
+		}
+		// straight on if possible, otherwise the first open way
+		Direction next = dir;
+		bool ready = true;
+		for (int k = 0; k < DirectionCount; ++k)
+		{
+			next = Direction((int(dir) + k) % DirectionCount);
+			const Location to = head.Add(ToDelta(next));
+			ready = world.IsReady(to);
+			if (!ready || !world.IsWall(to))
+			{
+				break;
+			}
+		}
+		if (!ready)
+		{
+			++stalls;
+			continue;
+		}
+		dir = next;
+		head = head.Add(ToDelta(dir));
+		++moved;
+		ChunkedWorld::Generate(settings.seed, settings.obstacles, head.x >> ChunkedWorld::ChunkBits,
+			head.y >> ChunkedWorld::ChunkBits, rows);
+		const int bit = rows[head.y & (ChunkedWorld::ChunkSize - 1)] >> (head.x & (ChunkedWorld::ChunkSize - 1)) & 1;
+		mismatches += bit != 0;
+	}
+	const double totalSeconds = total.GetSeconds();
+
+	// lookups around the head, the way collision checks and drawing do them
+	const int lookups = 10000000;
+	int walls = 0;
+	Stopwatch time;
+	for (int i = 0; i < lookups; ++i)
+	{
+		walls += world.IsWall({ head.x + (i & 31) - 16,head.y + ((i >> 5) & 31) - 16 });
+	}
+	const double lookupSeconds = time.GetSeconds();
+
+	std::printf("%d moves in %.0f ms, ended at %d,%d, %d stalled updates\n", moved, 1000.0 * totalSeconds, head.x,
+		head.y, stalls);
+	// the slowest ones are mostly the game loop losing its core to a worker
+	double updateSeconds = 0.0;
+	for (const double seconds : updateTimes)
+	{
+		updateSeconds += seconds;
+	}
+	std::sort(updateTimes.begin(), updateTimes.end());
+	std::printf("update: %.2f us mean, %.1f us at 99.9%%, %.1f us slowest\n", 1e6 * updateSeconds / updateTimes.size(),
+		1e6 * updateTimes[updateTimes.size() * 999 / 1000], 1e6 * updateTimes.back());
+	std::printf("lookup: %.2f ns (%d walls seen)\n", 1e9 * lookupSeconds / lookups, walls);
+	std::printf("chunks: %d generated, %d evicted, at most %d of %d in memory\n", world.GetGeneratedCount(),
+		world.GetEvictedCount(), highestResident, settings.maxChunks);
+	std::printf("walked onto walls: %d\n", mismatches);
+	return mismatches == 0 && highestResident <= settings.maxChunks ? 0 : 1;
+}
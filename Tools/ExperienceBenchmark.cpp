@@ -0,0 +1,114 @@
+#include "Commands.h"
+#include "Direction.h"
+#include "ExperienceBuffer.h"
+#include "SnakeEnv.h"
+#include "Stopwatch.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Fills an experience buffer from several threads of random-move games while
+// a trainer thread samples batches from it, and checks every sample decodes
+// to a board with exactly one head.
+namespace
+{
+	constexpr int GamesPerThread = 256;
+	constexpr int BatchSize = 256;
+
+	bool HasOneHead(const uint8_t* cells, int count)
+	{
+		return std::count(cells, cells + count, uint8_t(SnakeEnv::Head)) == 1;
+	}
+}
+
+int RunExperienceBenchmark(int argc, char* argv[])
+{
+	const std::string filename = argc > 0 ? argv[0] : "experience.bin";
+	const uint64_t records = argc > 1 ? uint64_t(std::atof(argv[1]) * 1e6) : 4000000u;
+	ThreadPool pool(argc > 2 ? std::atoi(argv[2]) : 0);
+	const Board brd;
+	// half the records, so the ring wraps round while the test runs
+	ExperienceBuffer buffer(filename, brd.GetWidth(), brd.GetHeight(), std::max<uint64_t>(1u, records / 2u));
+	const int cells = buffer.GetCellCount();
+
+	std::atomic<bool> writing{ true };
+	std::atomic<long long> sampled{ 0 };
+	std::atomic<long long> bad{ 0 };
+	std::thread trainer([&]
+	{
+		Rng rng(7u);
+		std::vector<uint8_t> observations(size_t(BatchSize) * cells);
+		std::vector<int> actions(BatchSize);
+		std::vector<float> rewards(BatchSize);
+		std::vector<uint8_t> dones(BatchSize);
+		while (writing)
+		{
+			const int n = buffer.Sample(rng, BatchSize, observations.data(), actions.data(), rewards.data(), dones.data());
+			for (int i = 0; i < n; ++i)
+			{
+				bad += !HasOneHead(observations.data() + size_t(i) * cells, cells);
+			}
+			sampled += n;
+		}
+	});
+
+	std::atomic<long long> remaining{ (long long)records };
+	Stopwatch time;
+	pool.ParallelFor(pool.GetThreadCount(), [&](int thread)
+	{
+		SnakeEnv env(GamesPerThread, brd);
+		std::vector<uint64_t> seeds(GamesPerThread);
+		for (int g = 0; g < GamesPerThread; ++g)
+		{
+			seeds[g] = uint64_t(thread) * GamesPerThread + g + 1u;
+		}
+		env.Reset(seeds.data());
+		Rng rng(thread + 100u);
+		std::vector<uint8_t> before(size_t(GamesPerThread) * cells);
+		std::vector<int> actions(GamesPerThread);
+		while (remaining.fetch_sub(GamesPerThread) > 0)
+		{
+			std::memcpy(before.data(), env.GetObservations(), before.size());
+			for (int& action : actions)
+			{
+				action = rng.Range(0, DirectionCount - 1);
+			}
+			env.Step(actions.data());
+			buffer.Append(before.data(), actions.data(), env.GetRewards(), env.GetDones(), GamesPerThread);
+		}
+	});
+	const double appendSeconds = time.GetSeconds();
+	writing = false;
+	trainer.join();
+	const double sampleSeconds = time.GetSeconds();
+
+	const uint64_t appended = buffer.GetAppended();
+	const double mb = appended * double(buffer.GetRecordSize()) / 1e6;
+	std::printf("%d writer threads, %llu records of %zu bytes (%d bytes as plain cells)\n", pool.GetThreadCount(),
+		(unsigned long long)appended, buffer.GetRecordSize(), cells + 6);
+	std::printf("appended %12.0f records/s %10.1f MB/s\n", appended / appendSeconds, mb / appendSeconds);
+	std::printf("sampled  %12.0f records/s alongside, %lld bad\n", sampled / sampleSeconds, (long long)bad);
+
+	// sampling on its own
+	Rng rng(9u);
+	std::vector<uint8_t> observations(size_t(BatchSize) * cells);
+	std::vector<int> actions(BatchSize);
+	std::vector<float> rewards(BatchSize);
+	std::vector<uint8_t> dones(BatchSize);
+	const int batches = 2000;
+	long long alone = 0;
+	time.Restart();
+	for (int b = 0; b < batches; ++b)
+	{
+		alone += buffer.Sample(rng, BatchSize, observations.data(), actions.data(), rewards.data(), dones.data());
+	}
+	std::printf("sampled  %12.0f records/s alone\n", alone / time.GetSeconds());
+	buffer.Flush();
+	return bad == 0 ? 0 : 1;
+}
@@ -0,0 +1,143 @@
+#include "Commands.h"
+#include "Bitboard.h"
+#include "Rng.h"
+#include "Stopwatch.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Times Bitboard::FloodFill against a plain queue based flood fill over the
+// same cells, on the game board with a snake lying on it and on a large board
+// strewn with obstacles.
+namespace
+{
+	struct Grid
+	{
+		int width;
+		int height;
+		std::vector<uint8_t> open;
+	};
+
+	int QueueFill(const Grid& grid, Location start, std::vector<uint8_t>& seen, std::vector<int>& queue)
+	{
+		std::fill(seen.begin(), seen.end(), uint8_t(0));
+		queue.clear();
+		queue.push_back(start.y * grid.width + start.x);
+		seen[queue[0]] = 1;
+		for (size_t i = 0; i < queue.size(); ++i)
+		{
+			const int x = queue[i] % grid.width;
+			const int y = queue[i] / grid.width;
+			const Location next[4] = { { x,y - 1 },{ x,y + 1 },{ x - 1,y },{ x + 1,y } };
+			for (const Location& n : next)
+			{
+				if (n.x < 0 || n.y < 0 || n.x >= grid.width || n.y >= grid.height)
+				{
+					continue;
+				}
+				const int c = n.y * grid.width + n.x;
+				if (!seen[c] && grid.open[c])
+				{
+					seen[c] = 1;
+					queue.push_back(c);
+				}
+			}
+		}
+		return int(queue.size());
+	}
+
+	// a random self-avoiding walk of up to length cells, like a snake's body
+	Grid SnakeGrid(int width, int height, int length, Rng& rng)
+	{
+		Grid grid{ width,height,std::vector<uint8_t>(size_t(width) * height, 1) };
+		Location at = { width / 2,height / 2 };
+		grid.open[at.y * width + at.x] = 0;
+		for (int i = 1; i < length; ++i)
+		{
+			const int first = rng.Range(0, 3);
+			bool moved = false;
+			for (int k = 0; k < 4 && !moved; ++k)
+			{
+				static const Location deltas[4] = { { 0,-1 },{ 0,1 },{ -1,0 },{ 1,0 } };
+				const Location n = at.Add(deltas[(first + k) % 4]);
+				if (n.x >= 0 && n.y >= 0 && n.x < width && n.y < height && grid.open[n.y * width + n.x])
+				{
+					at = n;
+					grid.open[at.y * width + at.x] = 0;
+					moved = true;
+				}
+			}
+			if (!moved)
+			{
+				break;
+			}
+		}
+		return grid;
+	}
+
+	Grid ScatteredGrid(int width, int height, int blockedPercent, Rng& rng)
+	{
+		Grid grid{ width,height,std::vector<uint8_t>(size_t(width) * height) };
+		for (uint8_t& cell : grid.open)
+		{
+			cell = rng.Range(0, 99) >= blockedPercent;
+		}
+		return grid;
+	}
+
+	// returns false when the two fills disagree
+	bool Compare(const char* name, const Grid& grid, int repeats)
+	{
+		Bitboard open(grid.width, grid.height);
+		Bitboard reached(grid.width, grid.height);
+		for (int y = 0; y < grid.height; ++y)
+		{
+			for (int x = 0; x < grid.width; ++x)
+			{
+				if (grid.open[y * grid.width + x])
+				{
+					open.Set({ x,y });
+				}
+			}
+		}
+		std::vector<uint8_t> seen(grid.open.size());
+		std::vector<int> queue;
+		queue.reserve(grid.open.size());
+		const Location start = { 0,0 };
+
+		int bitboardCount = 0;
+		Stopwatch bitboardTime;
+		for (int i = 0; i < repeats; ++i)
+		{
+			bitboardCount = reached.FloodFill(open, start);
+		}
+		const double bitboardUs = bitboardTime.GetSeconds() * 1e6 / repeats;
+
+		int queueCount = 0;
+		Stopwatch queueTime;
+		for (int i = 0; i < repeats; ++i)
+		{
+			queueCount = QueueFill(grid, start, seen, queue);
+		}
+		const double queueUs = queueTime.GetSeconds() * 1e6 / repeats;
+
+		std::printf("%-28s %9d %11.3f %11.3f %8.1fx\n", name, bitboardCount, bitboardUs, queueUs, queueUs / bitboardUs);
+		return bitboardCount == queueCount;
+	}
+}
+
+int RunFloodFillBenchmark(int argc, char* argv[])
+{
+	const int repeats = argc > 0 ? std::atoi(argv[0]) : 100000;
+	Rng rng(35);
+	bool same = true;
+	std::printf("%-28s %9s %11s %11s %9s\n", "board", "reached", "bitboard us", "queue us", "speed-up");
+	same &= Compare("30x25 empty", SnakeGrid(30, 25, 1, rng), repeats);
+	same &= Compare("30x25 snake 100", SnakeGrid(30, 25, 100, rng), repeats);
+	same &= Compare("30x25 snake 400", SnakeGrid(30, 25, 400, rng), repeats);
+	same &= Compare("30x25 25% scattered", ScatteredGrid(30, 25, 25, rng), repeats);
+	same &= Compare("1000x1000 empty", SnakeGrid(1000, 1000, 1, rng), repeats / 10000 + 1);
+	same &= Compare("1000x1000 snake 100000", SnakeGrid(1000, 1000, 100000, rng), repeats / 10000 + 1);
+	same &= Compare("1000x1000 25% scattered", ScatteredGrid(1000, 1000, 25, rng), repeats / 10000 + 1);
+	return same ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+#include "GeneticTrainer.h"
+#include "BotMatch.h"
+#include <algorithm>
+#include <numeric>
+
+GeneticTrainer::GeneticTrainer(const Board& brd, const GeneticSettings& settings)
+	:
+	brd(brd),
+	settings(settings),
+	pool(settings.threads),
+	rng(settings.seed),
+	population(std::max(1, settings.population)),
+	fitness(population.size()),
+	lengths(population.size() * settings.gamesPerCandidate),
+	deaths(lengths.size()),
+	ticks(lengths.size())
+{
+	// the hand-tuned weights plus random spread around them
+	population[0] = HeuristicBot::GetDefaultWeights();
+	for (size_t c = 1; c < population.size(); ++c)
+	{
+		for (int f = 0; f < HeuristicBot::FeatureCount; ++f)
+		{
+			population[c][f] = population[0][f] + 2.0f * (rng.Next() / 4294967296.0f - 0.5f) * 4.0f;
+		}
+	}
+}
+
+GeneticTrainer::Generation GeneticTrainer::Step()
+{
+	Evaluate(generation);
+
+	Generation result;
+	result.index = generation;
+	const size_t best = std::max_element(fitness.begin(), fitness.end()) - fitness.begin();
+	result.bestFitness = fitness[best];
+	result.meanFitness = std::accumulate(fitness.begin(), fitness.end(), 0.0f) / fitness.size();
+	result.best = population[best];
+	result.deaths = int(std::count(deaths.begin(), deaths.end(), uint8_t(1)));
+	result.ticks = std::accumulate(ticks.begin(), ticks.end(), 0ll);
+
+	Breed();
+	++generation;
+	return result;
+}
+
+int GeneticTrainer::GetThreadCount() const
+{
+	return pool.GetThreadCount();
+}
+
+void GeneticTrainer::Evaluate(int gen)
+{
+	const int games = settings.gamesPerCandidate;
+	// the same seeds for every candidate of a generation, new ones for the next
+	std::vector<uint64_t> seeds(games);
+	Rng seedSequence(settings.seed ^ (uint64_t(gen + 1) << 32));
+	for (uint64_t& seed : seeds)
+	{
+		seed = (uint64_t(seedSequence.Next()) << 32) | seedSequence.Next();
+	}
+
+	pool.ParallelFor(int(lengths.size()), [&](int index)
+	{
+		HeuristicBot bot(brd, population[index / games]);
+		const MatchResult match = PlayMatch(bot, brd, seeds[index % games], settings.maxTicks);
+		lengths[index] = match.length;
+		deaths[index] = match.died ? 1u : 0u;
+		ticks[index] = match.ticks;
+	});
+
+	for (size_t c = 0; c < population.size(); ++c)
+	{
+		const auto first = lengths.begin() + c * games;
+		fitness[c] = float(std::accumulate(first, first + games, 0ll)) / games;
+	}
+}
+
+void GeneticTrainer::Breed()
+{
+	std::vector<int> order(population.size());
+	std::iota(order.begin(), order.end(), 0);
+	// ties go to the lower index, so the order never depends on the sort
+	std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return fitness[a] > fitness[b]; });
+
+	std::vector<HeuristicBot::Weights> next;
+	next.reserve(population.size());
+	for (int e = 0; e < settings.elites && e < int(order.size()); ++e)
+	{
+		next.push_back(population[order[e]]);
+	}
+	while (next.size() < population.size())
+	{
+		const HeuristicBot::Weights& a = population[PickParent()];
+		const HeuristicBot::Weights& b = population[PickParent()];
+		HeuristicBot::Weights child;
+		for (int f = 0; f < HeuristicBot::FeatureCount; ++f)
+		{
+			// uniform crossover, then an occasional nudge
+			child[f] = (rng.Next() & 1u) ? a[f] : b[f];
+			// compared in double, which holds every draw exactly and stays below 1,
+			// so a rate of 1 mutates every weight and 0 none
+			if (rng.Next() / 4294967296.0 < settings.mutationRate)
+			{
+				child[f] += 2.0f * (rng.Next() / 4294967296.0f - 0.5f) * settings.mutationScale * std::max(1.0f, std::abs(child[f]));
+			}
+		}
+		next.push_back(child);
+	}
+	population.swap(next);
+}
+
+int GeneticTrainer::PickParent()
+{
+	int best = rng.Range(0, int(population.size()) - 1);
+	for (int t = 1; t < settings.tournament; ++t)
+	{
+		const int other = rng.Range(0, int(population.size()) - 1);
+		if (fitness[other] > fitness[best])
+		{
+			best = other;
+		}
+	}
+	return best;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "Board.h"
+#include "HeuristicBot.h"
+#include "Rng.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <vector>
+
+struct GeneticSettings
+{
+	int population = 32;
+	int gamesPerCandidate = 100;
+	// games still running after this many ticks are scored as they stand
+	int maxTicks = 100000;
+	// best candidates copied unchanged into the next generation
+	int elites = 2;
+	// candidates drawn for each parent pick, the fittest of them wins
+	int tournament = 3;
+	// chance of each weight being perturbed, and the spread of the perturbation
+	float mutationRate = 0.25f;
+	float mutationScale = 0.5f;
+	uint64_t seed = 1u;
+	// 0 = one per hardware thread
+	int threads = 0;
+};
+
+// Evolves HeuristicBot weights. Every generation plays all candidates on the
+// same freshly drawn seeds, one pool job per game, and scores each candidate
+// by its average final length. Game results are stored by index and summed in
+// a fixed order, and breeding runs on the trainer's own generator, so a given
+// seed produces the same weights whatever the thread count.
+class GeneticTrainer
+{
+public:
+	struct Generation
+	{
+		int index = 0;
+		float bestFitness = 0.0f;
+		float meanFitness = 0.0f;
+		HeuristicBot::Weights best = {};
+		int deaths = 0;
+		long long ticks = 0;
+	};
+public:
+	GeneticTrainer(const Board& brd, const GeneticSettings& settings);
+	// evaluates the current population, then breeds the next one from it
+	Generation Step();
+	int GetThreadCount() const;
+private:
+	void Evaluate(int generation);
+	void Breed();
+	int PickParent();
+private:
+	Board brd;
+	GeneticSettings settings;
+	ThreadPool pool;
+	Rng rng;
+	int generation = 0;
+	std::vector<HeuristicBot::Weights> population;
+	std::vector<float> fitness;
+	// one slot per candidate and game, in candidate-major order
+	std::vector<int> lengths;
+	std::vector<uint8_t> deaths;
+	std::vector<int> ticks;
+};
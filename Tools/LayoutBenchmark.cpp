@@ -0,0 +1,159 @@
+#include "Commands.h"
+#include "Arena.h"
+#include "BotMatch.h"
+#include "CellLayout.h"
+#include "Stopwatch.h"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Compares row major and Morton cell order on a large square board with three
+// access patterns: a breadth-first search over a board with scattered walls,
+// copying random viewports out of the board into a row major frame, and an
+// arena of randomly walking snakes, whose collision tests go through the
+// layout. Both orders have to produce the same distances, frames and games.
+namespace
+{
+	struct LayoutResult
+	{
+		double bfsSeconds = 0.0;
+		double viewportSeconds = 0.0;
+		double walkSeconds = 0.0;
+		long long bfsSum = 0;
+		long long viewportSum = 0;
+		uint32_t arenaHash = 0u;
+	};
+
+	// a wall border, so searches never need to check the edges, and a share of random walls inside
+	std::vector<uint8_t> MakeWalls(const CellLayout& layout)
+	{
+		const int size = layout.GetWidth();
+		std::vector<uint8_t> walls(layout.GetCellCount(), 1u);
+		Rng rng(7u);
+		for (int y = 0; y < size; ++y)
+		{
+			for (int x = 0; x < size; ++x)
+			{
+				const bool border = x == 0 || y == 0 || x == size - 1 || y == size - 1;
+				walls[layout.Index({ x,y })] = border || rng.Range(0, 99) < 25;
+			}
+		}
+		walls[layout.Index({ size / 2,size / 2 })] = 0u;
+		return walls;
+	}
+
+	long long Bfs(const CellLayout& layout, const std::vector<uint8_t>& walls)
+	{
+		std::vector<int> dist(walls.size(), -1);
+		std::vector<int> queue;
+		queue.reserve(walls.size());
+		const int start = layout.Index({ layout.GetWidth() / 2,layout.GetHeight() / 2 });
+		dist[start] = 0;
+		queue.push_back(start);
+		long long sum = 0;
+		for (size_t head = 0; head < queue.size(); ++head)
+		{
+			const int cell = queue[head];
+			sum += dist[cell];
+			for (int d = 0; d < DirectionCount; ++d)
+			{
+				const int next = layout.Neighbour(cell, Direction(d));
+				if (!walls[next] && dist[next] < 0)
+				{
+					dist[next] = dist[cell] + 1;
+					queue.push_back(next);
+				}
+			}
+		}
+		return sum;
+	}
+
+	long long CopyViewports(const CellLayout& layout, const std::vector<uint8_t>& walls, int count)
+	{
+		const int viewWidth = 320;
+		const int viewHeight = 180;
+		std::vector<uint8_t> frame(size_t(viewWidth) * viewHeight);
+		Rng rng(9u);
+		long long sum = 0;
+		for (int v = 0; v < count; ++v)
+		{
+			const int left = rng.Range(0, layout.GetWidth() - viewWidth);
+			const int top = rng.Range(0, layout.GetHeight() - viewHeight);
+			for (int y = 0; y < viewHeight; ++y)
+			{
+				// along the row by neighbour steps, as a renderer would
+				int cell = layout.Index({ left,top + y });
+				uint8_t* const out = &frame[size_t(y) * viewWidth];
+				for (int x = 0; x < viewWidth - 1; ++x)
+				{
+					out[x] = walls[cell];
+					cell = layout.Neighbour(cell, Direction::Right);
+				}
+				out[viewWidth - 1] = walls[cell];
+			}
+			sum += frame[size_t(v % viewHeight) * viewWidth + v % viewWidth] + frame[0];
+		}
+		return sum;
+	}
+
+	LayoutResult Run(CellLayout::Order order, int size, int snakes, int steps)
+	{
+		LayoutResult result;
+		{
+			const CellLayout layout(size, size, order);
+			const std::vector<uint8_t> walls = MakeWalls(layout);
+			Stopwatch time;
+			result.bfsSum = Bfs(layout, walls);
+			result.bfsSeconds = time.GetSeconds();
+			time.Restart();
+			result.viewportSum = CopyViewports(layout, walls, 500);
+			result.viewportSeconds = time.GetSeconds();
+		}
+
+		ArenaSettings settings;
+		settings.width = size;
+		settings.height = size;
+		settings.snakes = snakes;
+		settings.food = snakes;
+		settings.order = order;
+		Arena arena(settings);
+		arena.Reset(3u);
+		Rng rng(5u);
+		std::vector<Direction> inputs(snakes);
+		for (int t = 0; t < steps; ++t)
+		{
+			for (int s = 0; s < snakes; ++s)
+			{
+				inputs[s] = arena.IsAlive(s) ? Wander(arena, s, rng) : Direction::Up;
+			}
+			Stopwatch time;
+			arena.Step(inputs.data());
+			result.walkSeconds += time.GetSeconds();
+		}
+		result.arenaHash = arena.GetHash();
+		return result;
+	}
+}
+
+int RunLayoutBenchmark(int argc, char* argv[])
+{
+	const int size = argc > 0 ? std::atoi(argv[0]) : 4096;
+	const int snakes = argc > 1 ? std::atoi(argv[1]) : 20000;
+	const int steps = argc > 2 ? std::atoi(argv[2]) : 200;
+
+	std::printf("%dx%d board; bfs with 25%% walls, 500 320x180 viewports, %d snakes walking %d steps\n", size, size,
+		snakes, steps);
+	std::printf("%-10s %10s %14s %16s\n", "layout", "bfs ms", "viewports ms", "arena us/step");
+	const LayoutResult rowMajor = Run(CellLayout::Order::RowMajor, size, snakes, steps);
+	const LayoutResult morton = Run(CellLayout::Order::Morton, size, snakes, steps);
+	for (int i = 0; i < 2; ++i)
+	{
+		const LayoutResult& r = i == 0 ? rowMajor : morton;
+		std::printf("%-10s %10.1f %14.1f %16.1f\n", i == 0 ? "row major" : "morton", 1000.0 * r.bfsSeconds,
+			1000.0 * r.viewportSeconds, 1e6 * r.walkSeconds / steps);
+	}
+	const bool same = rowMajor.bfsSum == morton.bfsSum && rowMajor.viewportSum == morton.viewportSum &&
+		rowMajor.arenaHash == morton.arenaHash;
+	std::printf("results %s\n", same ? "match" : "DIFFER");
+	return same ? 0 : 1;
+}
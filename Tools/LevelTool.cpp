@@ -0,0 +1,148 @@
+#include "Commands.h"
+#include "Arena.h"
+#include "BfsBot.h"
+#include "BotMatch.h"
+#include "Level.h"
+#include "Simulation.h"
+#include "Stopwatch.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Writes two maze levels: a small one for the windowed game (pass it on the
+// command line) and a large one for the arena. The large one is reopened to
+// time the memory-mapped load, then an arena plays on it and a BFS bot plays
+// games on the small one, checking that no head or food ever lands on a wall.
+namespace
+{
+	// rooms of room x room cells, each wall between two rooms with a door in it
+	std::vector<uint8_t> MakeMaze(int width, int height, int room, Rng& rng)
+	{
+		std::vector<uint8_t> walls(size_t(width) * height, 0u);
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+			{
+				walls[size_t(y) * width + x] = x % room == 0 || y % room == 0 || x == width - 1 || y == height - 1;
+			}
+		}
+		const int door = std::max(1, room / 4);
+		for (int y = 0; y + room < height; y += room)
+		{
+			for (int x = 0; x + room < width; x += room)
+			{
+				// one door in the room's right wall and one in its bottom wall
+				const int right = y + 1 + rng.Range(0, room - 1 - door);
+				const int below = x + 1 + rng.Range(0, room - 1 - door);
+				for (int d = 0; d < door; ++d)
+				{
+					walls[size_t(right + d) * width + x + room] = 0u;
+					walls[size_t(y + room) * width + below + d] = 0u;
+				}
+			}
+		}
+		return walls;
+	}
+
+	std::vector<Level::Spawn> MakeSpawns(const std::vector<uint8_t>& walls, int width, int height, int count, Rng& rng)
+	{
+		std::vector<Level::Spawn> spawns;
+		while (int(spawns.size()) < count)
+		{
+			const int x = rng.Range(0, width - 1);
+			const int y = rng.Range(0, height - 1);
+			if (!walls[size_t(y) * width + x])
+			{
+				spawns.push_back({ x,y,uint32_t(rng.Range(0, DirectionCount - 1)) });
+			}
+		}
+		return spawns;
+	}
+}
+
+int RunLevelTool(int argc, char* argv[])
+{
+	const int size = argc > 0 ? std::atoi(argv[0]) : 4096;
+	const int snakes = argc > 1 ? std::atoi(argv[1]) : 1000;
+	const int steps = argc > 2 ? std::atoi(argv[2]) : 2000;
+	const std::string smallFile = "maze.level";
+	const std::string largeFile = "arena.level";
+	Rng rng(1u);
+	int failures = 0;
+
+	// the game's board is fixed at 30x25, so the small level is too
+	const Board plain;
+	const int w = plain.GetWidth();
+	const int h = plain.GetHeight();
+	const std::vector<uint8_t> smallWalls = MakeMaze(w, h, 8, rng);
+	Level::Write(smallFile, w, h, smallWalls, { { 4,4,uint32_t(Direction::Right) } }, { { 1,1,w - 2,h - 2 } });
+
+	Stopwatch time;
+	const std::vector<uint8_t> largeWalls = MakeMaze(size, size, 16, rng);
+	const int half = size / 2;
+	Level::Write(largeFile, size, size, largeWalls, MakeSpawns(largeWalls, size, size, snakes, rng),
+		{ { 0,0,half,half },{ half,half,size - half,size - half } });
+	const double writeSeconds = time.GetSeconds();
+	time.Restart();
+	const Level level(largeFile);
+	const double openSeconds = time.GetSeconds();
+	std::printf("%dx%d level with %d spawns: written in %.1f ms, opened in %.3f ms\n", level.GetWidth(),
+		level.GetHeight(), level.GetSpawnCount(), 1000.0 * writeSeconds, 1000.0 * openSeconds);
+
+	ArenaSettings settings;
+	settings.snakes = snakes;
+	settings.food = 2 * snakes;
+	settings.level = &level;
+	Arena arena(settings);
+	arena.Reset(1u);
+	std::vector<Direction> inputs(snakes);
+	double arenaSeconds = 0.0;
+	for (int t = 0; t < steps && arena.GetAliveCount() > 0; ++t)
+	{
+		for (int s = 0; s < snakes; ++s)
+		{
+			inputs[s] = arena.IsAlive(s) ? Wander(arena, s, rng) : Direction::Up;
+		}
+		time.Restart();
+		arena.Step(inputs.data());
+		arenaSeconds += time.GetSeconds();
+		for (int s = 0; s < snakes; ++s)
+		{
+			failures += arena.IsAlive(s) && arena.IsWall(arena.GetSegment(s, 0));
+		}
+		for (int slot = 0; slot < arena.GetFoodCount(); ++slot)
+		{
+			Location food;
+			failures += arena.GetFood(slot, food) && arena.IsWall(food);
+		}
+	}
+	std::printf("arena: %d snakes, %d alive after %d steps, %.2f us per step\n", snakes, arena.GetAliveCount(),
+		arena.GetTick(), 1e6 * arenaSeconds / std::max(1, arena.GetTick()));
+
+	const Level smallLevel(smallFile);
+	Board brd;
+	brd.SetLevel(&smallLevel);
+	int longest = 0;
+	const int games = 20;
+	for (int g = 0; g < games; ++g)
+	{
+		GameState state;
+		Simulation::Reset(state, brd, uint64_t(g) + 1u);
+		BfsBot bot(brd);
+		for (int move = 0; move < 5000 && !state.GameOver; ++move)
+		{
+			state.snake.Steer(ToDelta(bot.Decide(state, brd)));
+			Simulation::Step(state, brd);
+			failures += brd.IsWall(state.food.GetLocation());
+			for (int i = 0; i < state.snake.GetLength(); ++i)
+			{
+				failures += brd.IsWall(state.snake.GetSegment(i));
+			}
+		}
+		longest = std::max(longest, state.snake.GetLength());
+	}
+	std::printf("%s: %d bfs games, longest snake %d\n", smallFile.c_str(), games, longest);
+	std::printf("heads or food on walls: %d\n", failures);
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+#include "Commands.h"
+#include "Arena.h"
+#include "BotMatch.h"
+#include "LockstepSession.h"
+#include "LoopbackTransport.h"
+#include "Stopwatch.h"
+#include "UnixSocketTransport.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Plays one lockstep match with every player on its own thread, each with its
+// own arena and its own wandering inputs, connected pairwise by loopback or
+// Unix socket transports. Checks that all arenas end up equal and reports
+// stalls and bytes per player per tick. With "desync" the last player starts
+// from a different seed, which the state hashes have to catch.
+int RunLockstepTest(int argc, char* argv[])
+{
+	const int players = argc > 0 ? std::atoi(argv[0]) : 4;
+	const int ticks = argc > 1 ? std::atoi(argv[1]) : 10000;
+	const int delay = argc > 2 ? std::atoi(argv[2]) : 3;
+	const std::string kind = argc > 3 ? argv[3] : "loopback";
+	const bool desync = argc > 4 && std::strcmp(argv[4], "desync") == 0;
+	if (players < 2 || (kind != "loopback" && kind != "unix"))
+	{
+		throw std::runtime_error("Need two or more players and a transport of loopback or unix");
+	}
+
+	// links[i][j] is player i's end of the connection to player j
+	std::vector<std::vector<std::unique_ptr<Transport>>> links(players);
+	for (auto& row : links)
+	{
+		row.resize(players);
+	}
+	if (kind == "loopback")
+	{
+		for (int i = 0; i < players; ++i)
+		{
+			for (int j = i + 1; j < players; ++j)
+			{
+				auto pair = LoopbackTransport::CreatePair();
+				links[i][j] = std::move(pair.first);
+				links[j][i] = std::move(pair.second);
+			}
+		}
+	}
+
+	std::vector<uint32_t> finalHashes(players);
+	std::vector<int> stalls(players);
+	std::vector<uint64_t> bytes(players);
+	std::vector<std::exception_ptr> errors(players);
+	std::atomic<bool> failed{ false };
+	const auto play = [&](int me)
+	{
+		try
+		{
+			if (kind == "unix")
+			{
+				// the lower numbered player of each pair listens, connecting in order keeps everyone moving
+				for (int other = 0; other < players; ++other)
+				{
+					const std::string path = "lockstep-" + std::to_string(std::min(me, other)) + "-" +
+						std::to_string(std::max(me, other)) + ".sock";
+					if (other < me)
+					{
+						links[me][other] = UnixSocketTransport::Connect(path);
+					}
+					else if (other > me)
+					{
+						links[me][other] = UnixSocketTransport::Listen(path);
+					}
+				}
+			}
+			ArenaSettings settings;
+			settings.width = 64;
+			settings.height = 64;
+			settings.snakes = players;
+			settings.food = 32;
+			Arena arena(settings);
+			arena.Reset(desync && me == players - 1 ? 2u : 1u);
+			std::vector<Transport*> peers(players);
+			for (int p = 0; p < players; ++p)
+			{
+				peers[p] = links[me][p].get();
+			}
+			LockstepSession session(arena, me, peers, delay);
+			Rng rng(100u + me);
+			Direction input = arena.GetDirection(me);
+			bool stepped = true;
+			while (session.GetTick() < ticks && !failed)
+			{
+				if (stepped)
+				{
+					input = arena.IsAlive(me) ? Wander(arena, me, rng) : Direction::Up;
+				}
+				stepped = session.Update(input);
+				if (!stepped)
+				{
+					std::this_thread::yield();
+				}
+			}
+			finalHashes[me] = arena.GetHash();
+			stalls[me] = session.GetStallCount();
+			bytes[me] = session.GetBytesSent();
+		}
+		catch (...)
+		{
+			errors[me] = std::current_exception();
+			failed = true;
+		}
+	};
+
+	Stopwatch time;
+	std::vector<std::thread> threads;
+	for (int p = 0; p < players; ++p)
+	{
+		threads.emplace_back(play, p);
+	}
+	// the transports outlive every thread, so nobody's peer hangs up while inputs are still on the way
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	const double seconds = time.GetSeconds();
+	for (const std::exception_ptr& error : errors)
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+
+	bool same = true;
+	std::printf("%d players over %s, input delay %d, %d ticks in %.2f s (%.0f ticks/s)\n", players, kind.c_str(),
+		delay, ticks, seconds, ticks / seconds);
+	std::printf("%8s %10s %10s %16s\n", "player", "final hash", "stalls", "bytes/peer/tick");
+	for (int p = 0; p < players; ++p)
+	{
+		same = same && finalHashes[p] == finalHashes[0];
+		std::printf("%8d   %08x %10d %16.2f\n", p, finalHashes[p], stalls[p],
+			double(bytes[p]) / (double(ticks + delay) * (players - 1)));
+	}
+	std::printf("%s\n", same ? "all arenas equal" : "ARENAS DIFFER");
+	return same ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#include "Commands.h"
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+// Console front end for everything that runs the game without a window:
+// benchmarks, bot matches and training.
+namespace
+{
+	struct Command
+	{
+		const char* name;
+		int(*run)(int argc, char* argv[]);
+		const char* usage;
+	};
+
+	const Command commands[] =
+	{
+		{ "bench-arena", RunArenaBenchmark, "[steps] [size] [seed]  many-snake arena step cost as the snake count grows" },
+		{ "bench-distance", RunDistanceFieldBenchmark, "[moves]  full vs incremental distance field updates" },
+		{ "bench-encode", RunEncodeBenchmark, "[games] [repeats] [moves]  observation planes for a batch of games, uint8 and float" },
+		{ "bench-experience", RunExperienceBenchmark, "[file] [million records] [threads]  memory-mapped experience buffer appends and samples" },
+		{ "bench-floodfill", RunFloodFillBenchmark, "[repeats]  bitboard vs queue flood fill" },
+		{ "bench-layout", RunLayoutBenchmark, "[size] [snakes] [steps]  row major vs Morton cell order on a large board" },
+		{ "bench-mcts", RunMctsBenchmark, "[games] [iterations] [threads]  MCTS thread scaling and games against the BFS bot" },
+		{ "bench-policy", RunPolicyBenchmark, "[games] [hidden] [steps]  batched policy network act loop, plain vs AVX2" },
+		{ "bench-rollback", RunRollbackBenchmark, "[players] [latency frames] [frames] [frame us]  rollback resimulation cost under injected latency" },
+		{ "bench-sim-rpc", RunSimulationRpcBenchmark, "[games] [steps] [requests per step] [threads]  batched simulation requests over a Unix socket, pipelined" },
+		{ "bench-sized", RunSizedBoardBenchmark, "[games] [steps]  games on boards sized at compile time vs run time" },
+		{ "endless", RunEndlessTest, "[moves] [workers]  walk an endless chunked world, chunks generated in the background" },
+		{ "level", RunLevelTool, "[size] [snakes] [steps]  write maze levels and play an arena on the large one" },
+		{ "lockstep", RunLockstepTest, "[players] [ticks] [delay] [loopback|unix] [desync]  lockstep match, one thread per player" },
+		{ "soak", RunSoakTest, "[games] [seed]  Hamiltonian bot games played until the board is full" },
+		{ "spectate", RunSpectatorTest, "[subscribers] [ticks] [snakes]  delta-compressed arena stream to local subscribers" },
+		{ "torus", RunTorusTest, "[games] [max ticks]  wrapping board: distance field and flood fill checks, bots on both topologies" },
+		{ "tournament", RunTournament, "[bot,bot,...] [games] [threads] [file]  all bots on the same seeds, one summary line each" },
+		{ "train-ga", RunTrainGenetic, "[generations] [population] [games] [threads] [seed]  evolve heuristic bot weights" },
+	};
+
+	void PrintUsage()
+	{
+		std::printf("usage: Tools <command> [args]\n");
+		for (const Command& c : commands)
+		{
+			std::printf("  %s %s\n", c.name, c.usage);
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		PrintUsage();
+		return 1;
+	}
+	for (const Command& c : commands)
+	{
+		if (std::strcmp(argv[1], c.name) == 0)
+		{
+			try
+			{
+				return c.run(argc - 2, argv + 2);
+			}
+			catch (const std::exception& e)
+			{
+				std::fprintf(stderr, "%s: %s\n", c.name, e.what());
+				return 1;
+			}
+		}
+	}
+	PrintUsage();
+	return 1;
+}
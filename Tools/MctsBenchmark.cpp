@@ -0,0 +1,88 @@
+#include "Commands.h"
+#include "BfsBot.h"
+#include "BotMatch.h"
+#include "MctsBot.h"
+#include "Simulation.h"
+#include "Stopwatch.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+// Measures how many decisions per second the MCTS bot makes with more and more
+// threads, then plays it against the BFS autopilot on the same seeds.
+namespace
+{
+	struct Totals
+	{
+		long long length = 0;
+		int deaths = 0;
+		int decisions = 0;
+		double seconds = 0.0;
+	};
+
+	void Add(Totals& totals, const MatchResult& result)
+	{
+		totals.length += result.length;
+		totals.deaths += result.died;
+		totals.decisions += result.decisions;
+		totals.seconds += result.decideSeconds;
+	}
+
+	void PrintTotals(const char* name, const Totals& totals, int games)
+	{
+		std::printf("%-6s %10.1f %8d %12.0f\n", name, double(totals.length) / games, totals.deaths,
+			totals.decisions / totals.seconds);
+	}
+}
+
+int RunMctsBenchmark(int argc, char* argv[])
+{
+	const int games = argc > 0 ? std::atoi(argv[0]) : 10;
+	MctsSettings settings;
+	settings.iterations = argc > 1 ? std::atoi(argv[1]) : settings.iterations;
+	settings.threads = argc > 2 ? std::atoi(argv[2]) : int(std::thread::hardware_concurrency());
+	settings.threads = std::max(1, settings.threads);
+	const int maxTicks = 40000;
+	const Board brd;
+
+	// thread scaling on one position a few moves into a game
+	GameState state;
+	Simulation::Reset(state, brd, 1u);
+	for (int i = 0; i < 5; ++i)
+	{
+		Simulation::Step(state, brd);
+	}
+	std::printf("%d iterations per decision\n", settings.iterations);
+	std::printf("%-8s %12s %10s\n", "threads", "decisions/s", "nodes");
+	for (int threads = 1; threads <= settings.threads; threads *= 2)
+	{
+		MctsSettings scaled = settings;
+		scaled.threads = threads;
+		MctsBot bot(brd, scaled);
+		const int decisions = 50;
+		Stopwatch time;
+		for (int i = 0; i < decisions; ++i)
+		{
+			bot.Decide(state, brd);
+		}
+		std::printf("%-8d %12.0f %10d\n", threads, decisions / time.GetSeconds(), bot.GetLastNodeCount());
+	}
+
+	// paired seeds, so both bots face the same food sequence at the start
+	Totals bfsTotals;
+	Totals mctsTotals;
+	for (int g = 0; g < games; ++g)
+	{
+		const uint64_t seed = 1000u + g;
+		BfsBot bfs(brd);
+		MctsBot mcts(brd, settings);
+		Add(bfsTotals, PlayMatch(bfs, brd, seed, maxTicks));
+		Add(mctsTotals, PlayMatch(mcts, brd, seed, maxTicks));
+	}
+	std::printf("\n%d games\n", games);
+	std::printf("%-6s %10s %8s %12s\n", "bot", "length", "deaths", "decisions/s");
+	PrintTotals("bfs", bfsTotals, games);
+	PrintTotals("mcts", mctsTotals, games);
+	return 0;
+}
@@ -0,0 +1,97 @@
+#include "Commands.h"
+#include "Direction.h"
+#include "ObservationEncoder.h"
+#include "PolicyNetwork.h"
+#include "SnakeEnv.h"
+#include "Stopwatch.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Runs the whole act loop a trainer would: encode the observations of a batch
+// of games, pick their moves with a policy network and step them, first with
+// the plain kernels and then with AVX2, and reports agent-steps per second.
+namespace
+{
+	struct LoopTimes
+	{
+		double encode = 0.0;
+		double evaluate = 0.0;
+		double step = 0.0;
+	};
+
+	LoopTimes RunLoop(SnakeEnv& env, const ObservationEncoder& encoder, PolicyNetwork& net,
+		std::vector<uint8_t>& observations, std::vector<int>& actions, int steps)
+	{
+		LoopTimes times;
+		Stopwatch time;
+		for (int s = 0; s < steps; ++s)
+		{
+			time.Restart();
+			encoder.Encode(env.GetStates(), env.GetGameCount(), observations.data());
+			times.encode += time.GetSeconds();
+			time.Restart();
+			net.Act(observations.data(), env.GetGameCount(), actions.data());
+			times.evaluate += time.GetSeconds();
+			time.Restart();
+			env.Step(actions.data());
+			times.step += time.GetSeconds();
+		}
+		return times;
+	}
+}
+
+int RunPolicyBenchmark(int argc, char* argv[])
+{
+	const int games = argc > 0 ? std::atoi(argv[0]) : 1024;
+	const int hidden = argc > 1 ? std::atoi(argv[1]) : 64;
+	const int steps = argc > 2 ? std::atoi(argv[2]) : 100;
+
+	SnakeEnv env(games);
+	const ObservationEncoder encoder(env.GetBoard());
+	PolicyNetwork net({ int(encoder.GetGameSize()), hidden, hidden, DirectionCount }, 1u);
+	std::vector<uint8_t> observations(encoder.GetGameSize() * games);
+	std::vector<int> actions(games);
+	std::vector<uint64_t> seeds(games);
+	for (int g = 0; g < games; ++g)
+	{
+		seeds[g] = g + 1u;
+	}
+
+	// both kernels have to pick from the same scores
+	env.Reset(seeds.data());
+	encoder.Encode(env.GetStates(), games, observations.data());
+	std::vector<float> plainScores(size_t(games) * DirectionCount);
+	std::vector<float> simdScores(plainScores.size());
+	net.SetUseAvx2(false);
+	net.Evaluate(observations.data(), games, plainScores.data());
+	net.SetUseAvx2(true);
+	net.Evaluate(observations.data(), games, simdScores.data());
+	float maxError = 0.0f;
+	for (size_t i = 0; i < plainScores.size(); ++i)
+	{
+		maxError = std::max(maxError, std::abs(plainScores[i] - simdScores[i]));
+	}
+
+	std::printf("%d games, %d-%d-%d-%d network, %d steps\n", games, net.GetInputSize(), hidden, hidden,
+		DirectionCount, steps);
+	std::printf("%-8s %12s %12s %12s %14s\n", "kernel", "encode ms", "network ms", "step ms", "agent-steps/s");
+	for (int avx2 = 0; avx2 < 2; ++avx2)
+	{
+		net.SetUseAvx2(avx2 != 0);
+		if (avx2 && !net.IsUsingAvx2())
+		{
+			std::printf("%-8s no CPU support\n", "avx2");
+			break;
+		}
+		env.Reset(seeds.data());
+		const LoopTimes times = RunLoop(env, encoder, net, observations, actions, steps);
+		const double total = times.encode + times.evaluate + times.step;
+		std::printf("%-8s %12.3f %12.3f %12.3f %14.0f\n", avx2 ? "avx2" : "plain", 1000.0 * times.encode / steps,
+			1000.0 * times.evaluate / steps, 1000.0 * times.step / steps, double(games) * steps / total);
+	}
+	std::printf("largest score difference between kernels: %g\n", maxError);
+	return maxError < 1e-3f ? 0 : 1;
+}
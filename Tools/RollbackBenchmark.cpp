@@ -0,0 +1,163 @@
+#include "Commands.h"
+#include "Arena.h"
+#include "BotMatch.h"
+#include "LoopbackTransport.h"
+#include "RollbackSession.h"
+#include "Stopwatch.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Measures what a rollback costs. First the bare resimulation: load a snapshot
+// and step the arena forward again, saving a snapshot per tick as the session
+// does. Then a paced match of players connected by loopback transports that
+// hold every input back by the given number of frames, so nearly every frame
+// rolls back that far, with all sessions updated from one thread.
+namespace
+{
+	ArenaSettings MakeSettings(int players, int size)
+	{
+		ArenaSettings settings;
+		settings.width = size;
+		settings.height = size;
+		settings.snakes = players;
+		settings.food = 16;
+		return settings;
+	}
+
+	// microseconds to load a snapshot and step ticks ticks with snapshots
+	double TimeResimulation(int players, int size, int ticks)
+	{
+		Arena arena(MakeSettings(players, size));
+		arena.Reset(1u);
+		std::vector<Arena::Snapshot> snapshots(ticks + 1);
+		std::vector<Direction> inputs(players);
+		Rng rng(7u);
+		// something to roll back over
+		for (int t = 0; t < ticks; ++t)
+		{
+			arena.Save(snapshots[t]);
+			for (int p = 0; p < players; ++p)
+			{
+				inputs[p] = Wander(arena, p, rng);
+			}
+			arena.Step(inputs.data());
+		}
+		const int repeats = 20000;
+		Stopwatch time;
+		for (int r = 0; r < repeats; ++r)
+		{
+			arena.Load(snapshots[0]);
+			for (int t = 0; t < ticks; ++t)
+			{
+				arena.Save(snapshots[t]);
+				arena.Step(inputs.data());
+			}
+		}
+		return 1e6 * time.GetSeconds() / repeats;
+	}
+}
+
+int RunRollbackBenchmark(int argc, char* argv[])
+{
+	const int players = argc > 0 ? std::atoi(argv[0]) : 4;
+	const int latency = argc > 1 ? std::atoi(argv[1]) : 8;
+	const int frames = argc > 2 ? std::atoi(argv[2]) : 2000;
+	const int frameMicroseconds = argc > 3 ? std::atoi(argv[3]) : 1000;
+	const int size = 64;
+	const int maxRollback = latency + 4;
+
+	std::printf("%d players on %dx%d, %d frames of latency, frames of %d us\n", players, size, size, latency,
+		frameMicroseconds);
+	std::printf("bare resimulation of %d ticks: %.2f us\n", latency, TimeResimulation(players, size, latency));
+
+	std::vector<std::vector<std::unique_ptr<Transport>>> links(players);
+	for (auto& row : links)
+	{
+		row.resize(players);
+	}
+	for (int i = 0; i < players; ++i)
+	{
+		for (int j = i + 1; j < players; ++j)
+		{
+			auto pair = LoopbackTransport::CreatePair(latency * frameMicroseconds);
+			links[i][j] = std::move(pair.first);
+			links[j][i] = std::move(pair.second);
+		}
+	}
+	std::vector<std::unique_ptr<Arena>> arenas;
+	std::vector<std::unique_ptr<RollbackSession>> sessions;
+	std::vector<Rng> rngs;
+	std::vector<Direction> inputs;
+	for (int p = 0; p < players; ++p)
+	{
+		arenas.emplace_back(new Arena(MakeSettings(players, size)));
+		arenas[p]->Reset(1u);
+		std::vector<Transport*> peers(players);
+		for (int q = 0; q < players; ++q)
+		{
+			peers[q] = links[p][q].get();
+		}
+		sessions.emplace_back(new RollbackSession(*arenas[p], p, peers, maxRollback));
+		rngs.emplace_back(100u + p);
+		inputs.push_back(arenas[p]->GetDirection(p));
+	}
+
+	// after the measured frames the inputs stay put, so the predictions come true and the arenas settle
+	const int settleFrames = 2 * maxRollback + latency;
+	std::vector<double> updateMicroseconds;
+	long long resimulated = 0;
+	int maxResimulated = 0;
+	const auto frameLength = std::chrono::microseconds(frameMicroseconds);
+	auto nextFrame = std::chrono::steady_clock::now();
+	for (int f = 0; f < frames + settleFrames; ++f)
+	{
+		for (int p = 0; p < players; ++p)
+		{
+			Arena& arena = *arenas[p];
+			if (f < frames && arena.IsAlive(p))
+			{
+				inputs[p] = Wander(arena, p, rngs[p]);
+			}
+			Stopwatch time;
+			sessions[p]->Update(inputs[p]);
+			if (f < frames)
+			{
+				updateMicroseconds.push_back(1e6 * time.GetSeconds());
+				resimulated += sessions[p]->GetLastResimulated();
+				maxResimulated = std::max(maxResimulated, sessions[p]->GetLastResimulated());
+			}
+		}
+		// busy waiting keeps the frames even where sleeps are coarse
+		nextFrame += frameLength;
+		while (std::chrono::steady_clock::now() < nextFrame)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	std::sort(updateMicroseconds.begin(), updateMicroseconds.end());
+	double total = 0.0;
+	for (const double us : updateMicroseconds)
+	{
+		total += us;
+	}
+	int stalls = 0;
+	bool same = true;
+	for (int p = 0; p < players; ++p)
+	{
+		stalls += sessions[p]->GetStallCount();
+		same = same && sessions[p]->GetTick() == sessions[0]->GetTick() && arenas[p]->GetHash() == arenas[0]->GetHash();
+	}
+	const size_t n = updateMicroseconds.size();
+	std::printf("updates: mean %.2f us, p99 %.2f us, max %.2f us (%.3f%% of a 60 Hz frame)\n", total / n,
+		updateMicroseconds[n * 99 / 100], updateMicroseconds[n - 1], updateMicroseconds[n - 1] / 166.67);
+	std::printf("resimulated ticks per update: mean %.2f, max %d; stalls %d\n", double(resimulated) / n,
+		maxResimulated, stalls);
+	std::printf("%s at tick %d\n", same ? "all arenas equal" : "ARENAS DIFFER", sessions[0]->GetTick());
+	return same ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+#include "Commands.h"
+#include "Direction.h"
+#include "ObservationEncoder.h"
+#include "SimulationClient.h"
+#include "SimulationServer.h"
+#include "SnakeEnv.h"
+#include "Stopwatch.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Drives a SimulationServer on its own thread through a SimulationClient, the
+// way an out-of-process trainer would. Every step the games are split into
+// several Step requests; with pipeline depth 1 each waits for the previous
+// response, deeper pipelines keep that many requests in flight. The first
+// steps are checked against a SnakeEnv with the same seeds and actions, and the
+// throughput is compared with stepping that SnakeEnv in-process.
+namespace
+{
+	void FillActions(Rng& rng, std::vector<uint8_t>& actions)
+	{
+		for (uint8_t& action : actions)
+		{
+			action = uint8_t(rng.Range(0, DirectionCount - 1));
+		}
+	}
+
+	// steps every game steps times, at most depth requests in flight
+	double TimeRpc(SimulationClient& client, const std::vector<uint32_t>& ids, int requests, int depth, int steps)
+	{
+		const uint32_t games = uint32_t(ids.size());
+		const uint32_t perRequest = (games + requests - 1) / requests;
+		std::vector<uint8_t> actions(games);
+		std::vector<uint32_t> inFlight;
+		std::vector<uint8_t> body;
+		Rng rng(11u);
+		Stopwatch time;
+		for (int s = 0; s < steps; ++s)
+		{
+			FillActions(rng, actions);
+			for (uint32_t first = 0; first < games; first += perRequest)
+			{
+				if (int(inFlight.size()) == depth)
+				{
+					client.ReceiveResponse(inFlight.front(), body);
+					inFlight.erase(inFlight.begin());
+				}
+				const uint32_t count = std::min(perRequest, games - first);
+				inFlight.push_back(client.SendStep(&ids[first], &actions[first], count));
+			}
+		}
+		for (uint32_t requestId : inFlight)
+		{
+			client.ReceiveResponse(requestId, body);
+		}
+		return time.GetSeconds();
+	}
+}
+
+int RunSimulationRpcBenchmark(int argc, char* argv[])
+{
+	const int games = argc > 0 ? std::atoi(argv[0]) : 4096;
+	const int steps = argc > 1 ? std::atoi(argv[1]) : 200;
+	const int requests = argc > 2 ? std::atoi(argv[2]) : 8;
+	const int threads = argc > 3 ? std::atoi(argv[3]) : 0;
+	const int checkSteps = 100;
+	const uint64_t seed = 1u;
+	const char* const path = "simulation.sock";
+
+	SimulationServer server(path, threads);
+	std::atomic<bool> stop{ false };
+	std::thread serving([&]()
+	{
+		server.Serve(stop);
+	});
+
+	int result = 0;
+	try
+	{
+		SimulationClient client(path);
+		int width, height, planes;
+		client.GetInfo(width, height, planes);
+		const std::vector<uint32_t> ids = client.Create(uint32_t(games), seed);
+
+		// the same games in-process
+		SnakeEnv env(games);
+		std::vector<uint64_t> seeds(games);
+		for (int g = 0; g < games; ++g)
+		{
+			seeds[g] = seed + g;
+		}
+		env.Reset(seeds.data());
+		std::vector<uint8_t> actions(games);
+		std::vector<int> envActions(games);
+		std::vector<uint8_t> body;
+		Rng rng(3u);
+		int mismatches = 0;
+		for (int s = 0; s < checkSteps; ++s)
+		{
+			FillActions(rng, actions);
+			std::copy(actions.begin(), actions.end(), envActions.begin());
+			client.ReceiveResponse(client.SendStep(ids.data(), actions.data(), uint32_t(games)), body);
+			env.Step(envActions.data());
+			for (int g = 0; g < games; ++g)
+			{
+				if (SimulationClient::GetReward(body, g) != env.GetRewards()[g] ||
+					SimulationClient::GetDone(body, g) != (env.GetDones()[g] != 0u))
+				{
+					++mismatches;
+				}
+			}
+		}
+		const ObservationEncoder encoder(env.GetBoard());
+		std::vector<uint8_t> expected(encoder.GetGameSize() * games);
+		encoder.Encode(env.GetStates(), games, expected.data());
+		client.ReceiveResponse(client.SendObserve(ids.data(), uint32_t(games)), body);
+		if (body != expected)
+		{
+			++mismatches;
+		}
+
+		// a bad request is answered with an error and changes nothing
+		int rejected = 0;
+		const uint32_t duplicate[2] = { ids[0], ids[0] };
+		try
+		{
+			client.ReceiveResponse(client.SendObserve(duplicate, 2u), body);
+		}
+		catch (const std::runtime_error&)
+		{
+			++rejected;
+		}
+		try
+		{
+			client.Create(0xFFFFFFFFu, seed);
+		}
+		catch (const std::runtime_error&)
+		{
+			rejected += server.GetGameCount() == games;
+		}
+
+		std::printf("%d games on a %dx%d board, %d planes, %d steps, %d step requests per step\n", games, width,
+			height, planes, steps, requests);
+		std::printf("checked %d steps against SnakeEnv: %d mismatches, bad requests rejected: %d of 2\n", checkSteps,
+			mismatches, rejected);
+		if (mismatches > 0 || rejected != 2)
+		{
+			result = 1;
+		}
+
+		std::printf("%-20s %12s %14s\n", "", "ms/step", "agent-steps/s");
+		Stopwatch time;
+		for (int s = 0; s < steps; ++s)
+		{
+			FillActions(rng, actions);
+			std::copy(actions.begin(), actions.end(), envActions.begin());
+			env.Step(envActions.data());
+		}
+		const double local = time.GetSeconds();
+		std::printf("%-20s %12.3f %14.0f\n", "in-process SnakeEnv", 1000.0 * local / steps,
+			double(games) * steps / local);
+		for (int depth = 1; depth <= requests; depth *= 2)
+		{
+			const double seconds = TimeRpc(client, ids, requests, depth, steps);
+			char label[32];
+			std::snprintf(label, sizeof(label), "rpc, depth %d", depth);
+			std::printf("%-20s %12.3f %14.0f\n", label, 1000.0 * seconds / steps, double(games) * steps / seconds);
+		}
+
+		client.Destroy(ids);
+		if (server.GetGameCount() != 0)
+		{
+			result = 1;
+		}
+		client.Shutdown();
+	}
+	catch (...)
+	{
+		stop = true;
+		serving.join();
+		throw;
+	}
+	serving.join();
+	return result;
+}
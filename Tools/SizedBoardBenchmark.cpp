@@ -0,0 +1,205 @@
+#include "Commands.h"
+#include "Board.h"
+#include "Direction.h"
+#include "GameState.h"
+#include "Rng.h"
+#include "Simulation.h"
+#include "SizedGame.h"
+#include "Stopwatch.h"
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Plays the same batch of games three ways: GameState with Simulation::Step
+// (on the 30x25 game board only), SizedGame<> with the size given at run
+// time, and SizedGame<W, H> with it fixed at compile time. Every path steers
+// with the same playout policy, mostly towards the food and never into
+// certain death. Reports the time per step and checks that all paths play
+// the very same games.
+namespace
+{
+	// GameState and Simulation behind the SizedGame interface
+	class SimulationGame
+	{
+	public:
+		SimulationGame(const Board& brd)
+			:
+			brd(&brd)
+		{}
+		void Reset(uint64_t seed)
+		{
+			Simulation::Reset(state, *brd, seed);
+		}
+		void Step(Direction dir)
+		{
+			state.snake.Steer(ToDelta(dir));
+			Simulation::Step(state, *brd);
+		}
+		// the way MctsBot tries out moves
+		bool IsSafe(Direction dir)
+		{
+			const Location current = state.snake.GetDirection();
+			state.snake.SetDirection(ToDelta(dir));
+			const bool safe = !Simulation::CheckForGameOver(state.snake, *brd);
+			state.snake.SetDirection(current);
+			return safe;
+		}
+		bool IsOver() const
+		{
+			return state.GameOver;
+		}
+		int GetLength() const
+		{
+			return state.snake.GetLength();
+		}
+		Location GetHead() const
+		{
+			return state.snake.GetSegment(0);
+		}
+		Location GetFood() const
+		{
+			return state.food.GetLocation();
+		}
+		Direction GetDirection() const
+		{
+			return ToDirection(state.snake.GetDirection());
+		}
+	private:
+		const Board* brd;
+		GameState state;
+	};
+
+	template<typename Game>
+	Direction Decide(Game& game, Rng& rng)
+	{
+		const Direction current = game.GetDirection();
+		Direction safe[DirectionCount];
+		int safeCount = 0;
+		for (int i = 0; i < DirectionCount; ++i)
+		{
+			const Direction dir = Direction(i);
+			if (dir != Opposite(current) && game.IsSafe(dir))
+			{
+				safe[safeCount++] = dir;
+			}
+		}
+		if (safeCount == 0)
+		{
+			return current;
+		}
+		if (rng.Range(0, 3) == 0)
+		{
+			return safe[rng.Range(0, safeCount - 1)];
+		}
+		const Location head = game.GetHead();
+		const Location food = game.GetFood();
+		Direction best = safe[0];
+		int bestDist = INT_MAX;
+		for (int i = 0; i < safeCount; ++i)
+		{
+			const Location next = head.Add(ToDelta(safe[i]));
+			const int dist = std::abs(next.x - food.x) + std::abs(next.y - food.y);
+			if (dist < bestDist)
+			{
+				best = safe[i];
+				bestDist = dist;
+			}
+		}
+		return best;
+	}
+
+	struct RunResult
+	{
+		double seconds = 0.0;
+		// FNV-1a over every game after every step
+		uint32_t hash = 2166136261u;
+		long long games = 0;
+	};
+
+	void Mix(uint32_t& hash, int v)
+	{
+		hash = (hash ^ uint32_t(v)) * 16777619u;
+	}
+
+	// steps every game in turn; a game that ends starts over with its next seed
+	template<typename Game>
+	RunResult Run(std::vector<Game>& games, int steps)
+	{
+		RunResult result;
+		std::vector<Rng> policies(games.size());
+		std::vector<uint32_t> resets(games.size());
+		for (size_t g = 0; g < games.size(); ++g)
+		{
+			games[g].Reset(uint64_t(g) << 32);
+			policies[g].Seed(g + 1u);
+		}
+		Stopwatch time;
+		for (int s = 0; s < steps; ++s)
+		{
+			for (size_t g = 0; g < games.size(); ++g)
+			{
+				Game& game = games[g];
+				game.Step(Decide(game, policies[g]));
+				if (game.IsOver())
+				{
+					game.Reset((uint64_t(g) << 32) | ++resets[g]);
+					++result.games;
+				}
+				Mix(result.hash, game.GetHead().x);
+				Mix(result.hash, game.GetHead().y);
+				Mix(result.hash, game.GetFood().x);
+				Mix(result.hash, game.GetFood().y);
+				Mix(result.hash, game.GetLength());
+			}
+		}
+		result.seconds = time.GetSeconds();
+		return result;
+	}
+
+	void PrintRow(int width, int height, const char* path, const RunResult& result, const RunResult& runtime,
+		long long totalSteps)
+	{
+		std::printf("%3dx%-3d  %-12s %10.1f %10.2fx %10lld %10x\n", width, height, path,
+			1e9 * result.seconds / totalSteps, runtime.seconds / result.seconds, result.games, result.hash);
+	}
+
+	// returns the number of paths whose games differ from the runtime sized one
+	template<int W, int H>
+	int BenchSize(int nGames, int steps)
+	{
+		const long long totalSteps = (long long)nGames * steps;
+		std::vector<SizedGame<>> runtimeGames(nGames, SizedGame<>(W, H));
+		const RunResult runtime = Run(runtimeGames, steps);
+		std::vector<SizedGame<W, H>> fixedGames(nGames, SizedGame<W, H>());
+		const RunResult fixed = Run(fixedGames, steps);
+		int mismatches = fixed.hash != runtime.hash;
+
+		const Board brd;
+		if (brd.GetWidth() == W && brd.GetHeight() == H)
+		{
+			std::vector<SimulationGame> simulationGames(nGames, SimulationGame(brd));
+			const RunResult simulation = Run(simulationGames, steps);
+			mismatches += simulation.hash != runtime.hash;
+			PrintRow(W, H, "simulation", simulation, runtime, totalSteps);
+		}
+		PrintRow(W, H, "runtime", runtime, runtime, totalSteps);
+		PrintRow(W, H, "fixed", fixed, runtime, totalSteps);
+		return mismatches;
+	}
+}
+
+int RunSizedBoardBenchmark(int argc, char* argv[])
+{
+	const int games = argc > 0 ? std::atoi(argv[0]) : 256;
+	const int steps = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+	std::printf("%d games, %d steps each\n", games, steps);
+	std::printf("%-8s %-12s %10s %11s %10s %10s\n", "board", "path", "ns/step", "vs runtime", "games", "hash");
+	int mismatches = 0;
+	mismatches += BenchSize<30, 25>(games, steps);
+	mismatches += BenchSize<32, 32>(games, steps);
+	mismatches += BenchSize<64, 64>(games, steps);
+	std::printf("paths playing different games: %d\n", mismatches);
+	return mismatches == 0 ? 0 : 1;
+}
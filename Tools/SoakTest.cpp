@@ -0,0 +1,32 @@
+#include "Commands.h"
+#include "BotMatch.h"
+#include "HamiltonianBot.h"
+#include "Stopwatch.h"
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+
+// Plays whole games with the Hamiltonian bot until the snake fills the board:
+// the longest snake and the longest game the rules allow.
+int RunSoakTest(int argc, char* argv[])
+{
+	const int games = argc > 0 ? std::atoi(argv[0]) : 4;
+	const uint64_t firstSeed = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1u;
+	const Board brd;
+	HamiltonianBot bot(brd);
+	const int cells = brd.GetWidth() * brd.GetHeight();
+
+	int failures = 0;
+	std::printf("%-6s %8s %10s %8s %10s\n", "seed", "length", "ticks", "seconds", "ticks/s");
+	for (int g = 0; g < games; ++g)
+	{
+		Stopwatch time;
+		const MatchResult result = PlayMatch(bot, brd, firstSeed + g, INT_MAX);
+		const double seconds = time.GetSeconds();
+		std::printf("%-6llu %8d %10d %8.2f %10.0f\n", (unsigned long long)result.seed, result.length, result.ticks,
+			seconds, result.ticks / seconds);
+		failures += result.length < cells;
+	}
+	// every game has to end with the board full
+	return failures == 0 ? 0 : 1;
+}
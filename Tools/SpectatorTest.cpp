@@ -0,0 +1,145 @@
+#include "Commands.h"
+#include "Arena.h"
+#include "BotMatch.h"
+#include "SpectatorClient.h"
+#include "SpectatorServer.h"
+#include "Stopwatch.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Streams an arena of wandering snakes to several subscribers on their own
+// threads, one of which reads only now and then, so it falls behind and has
+// to be resynced with keyframes. Once the game is over every subscriber's
+// copy has to match the arena. Reports the publish cost and message sizes.
+int RunSpectatorTest(int argc, char* argv[])
+{
+	const int nSubscribers = argc > 0 ? std::atoi(argv[0]) : 8;
+	const int ticks = argc > 1 ? std::atoi(argv[1]) : 5000;
+	const int snakes = argc > 2 ? std::atoi(argv[2]) : 100;
+	const char* const path = "spectate.sock";
+
+	ArenaSettings settings;
+	settings.width = 256;
+	settings.height = 256;
+	settings.snakes = snakes;
+	settings.food = 2 * snakes;
+	Arena arena(settings);
+	arena.Reset(1u);
+	// small enough that the slow subscriber overflows it
+	SpectatorServer server(path, size_t(64) << 10);
+
+	std::vector<std::unique_ptr<SpectatorClient>> clients(nSubscribers);
+	std::vector<std::exception_ptr> errors(nSubscribers);
+	std::atomic<int> finalTick{ -1 };
+	std::atomic<int> finished{ 0 };
+	const auto watch = [&](int index)
+	{
+		try
+		{
+			clients[index].reset(new SpectatorClient(path));
+			SpectatorClient& client = *clients[index];
+			// subscriber 0 reads ten times a second only
+			const bool slow = index == 0;
+			while (!(client.IsSynced() && client.GetTick() == finalTick))
+			{
+				client.Poll();
+				if (slow)
+				{
+					std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+		catch (...)
+		{
+			errors[index] = std::current_exception();
+		}
+		++finished;
+	};
+	std::vector<std::thread> threads;
+	for (int i = 0; i < nSubscribers; ++i)
+	{
+		threads.emplace_back(watch, i);
+	}
+	while (server.GetSubscriberCount() < nSubscribers)
+	{
+		server.Flush();
+		std::this_thread::yield();
+	}
+
+	Rng rng(5u);
+	std::vector<Direction> inputs(snakes);
+	double publishSeconds = 0.0;
+	size_t deltaBytes = 0;
+	server.Publish(arena);
+	for (int t = 0; t < ticks; ++t)
+	{
+		for (int s = 0; s < snakes; ++s)
+		{
+			inputs[s] = arena.IsAlive(s) ? Wander(arena, s, rng) : Direction::Up;
+		}
+		arena.Step(inputs.data());
+		Stopwatch time;
+		server.Publish(arena);
+		publishSeconds += time.GetSeconds();
+		deltaBytes += server.GetLastDeltaSize();
+	}
+	finalTick = arena.GetTick();
+	// keeps sending until every subscriber has caught up
+	while (finished < nSubscribers)
+	{
+		server.Flush();
+		std::this_thread::yield();
+	}
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	for (const std::exception_ptr& error : errors)
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+
+	int matching = 0;
+	for (const auto& client : clients)
+	{
+		bool same = client->GetTick() == arena.GetTick() && client->GetSnakeCount() == snakes;
+		for (int s = 0; same && s < snakes; ++s)
+		{
+			const int length = arena.IsAlive(s) ? arena.GetLength(s) : 0;
+			same = client->GetLength(s) == length;
+			for (int i = 0; same && i < length; ++i)
+			{
+				same = client->GetSegment(s, i) == arena.GetSegment(s, i);
+			}
+		}
+		for (int slot = 0; same && slot < arena.GetFoodCount(); ++slot)
+		{
+			Location expected;
+			Location got;
+			const bool placed = arena.GetFood(slot, expected);
+			same = placed == client->GetFood(slot, got) && (!placed || got == expected);
+		}
+		matching += same;
+	}
+	std::printf("%d snakes, %d ticks, %d subscribers (%d alive at the end)\n", snakes, ticks, nSubscribers,
+		arena.GetAliveCount());
+	std::printf("publish: %.2f us per tick, delta %.0f bytes per tick on average, keyframe %zu bytes\n",
+		1e6 * publishSeconds / ticks, double(deltaBytes) / ticks, server.GetLastKeyframeSize());
+	std::printf("resyncs %d; keyframes received: slow subscriber %d, others %d\n", server.GetResyncCount(),
+		clients[0]->GetKeyframeCount(), nSubscribers > 1 ? clients[1]->GetKeyframeCount() : 0);
+	std::printf("%d of %d subscribers match the arena\n", matching, nSubscribers);
+	return matching == nSubscribers ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <chrono>
+
+// Wall clock timing for the benchmarks.
+class Stopwatch
+{
+public:
+	Stopwatch()
+		:
+		start(std::chrono::steady_clock::now())
+	{}
+	void Restart()
+	{
+		start = std::chrono::steady_clock::now();
+	}
+	double GetSeconds() const
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+private:
+	std::chrono::steady_clock::time_point start;
+};
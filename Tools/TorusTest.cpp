@@ -0,0 +1,234 @@
+#include "Commands.h"
+#include "Bitboard.h"
+#include "BotMatch.h"
+#include "Direction.h"
+#include "DistanceField.h"
+#include "Rng.h"
+#include "Simulation.h"
+#include "Stopwatch.h"
+#include "Topology.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Checks the wrapping board topology: the distance field and the flood fill
+// against plain queue searches that wrap round the edges, then every bot on
+// the bounded and the wrapping board from the same seeds, checking each head
+// stays on the board. Also times coordinate wrapping with a branch, without
+// one and as a compile-time mask.
+namespace
+{
+	// queue search over the open cells from start; dist -1 where not reached
+	void QueueSearch(int width, int height, const std::vector<uint8_t>& open, Location start,
+		std::vector<int>& dist)
+	{
+		dist.assign(size_t(width) * height, -1);
+		std::vector<Location> queue(1, start);
+		dist[start.y * width + start.x] = 0;
+		for (size_t i = 0; i < queue.size(); ++i)
+		{
+			const Location at = queue[i];
+			for (int k = 0; k < DirectionCount; ++k)
+			{
+				const Location n = WrapLocation(at.Add(ToDelta(Direction(k))), width, height);
+				const int c = n.y * width + n.x;
+				if (open[c] && dist[c] < 0)
+				{
+					dist[c] = dist[at.y * width + at.x] + 1;
+					queue.push_back(n);
+				}
+			}
+		}
+	}
+
+	// blocks and frees random cells one at a time, comparing every distance after each change
+	int CheckField(int width, int height, int changes, Rng& rng)
+	{
+		DistanceField field(width, height, true);
+		std::vector<uint8_t> open(size_t(width) * height, 1);
+		const Location target = { rng.Range(0, width - 1),rng.Range(0, height - 1) };
+		field.Rebuild(target);
+		std::vector<int> expected;
+		int mismatches = 0;
+		for (int i = 0; i < changes; ++i)
+		{
+			const Location loc = { rng.Range(0, width - 1),rng.Range(0, height - 1) };
+			if (loc == target)
+			{
+				continue;
+			}
+			uint8_t& cell = open[loc.y * width + loc.x];
+			if (cell && rng.Range(0, 99) < 60)
+			{
+				field.Block(loc);
+				cell = 0;
+			}
+			else if (!cell)
+			{
+				field.Unblock(loc);
+				cell = 1;
+			}
+			QueueSearch(width, height, open, target, expected);
+			for (int y = 0; y < height; ++y)
+			{
+				for (int x = 0; x < width; ++x)
+				{
+					const int e = expected[y * width + x];
+					mismatches += field.GetDistance({ x,y }) != (e < 0 ? DistanceField::Unreachable : e);
+				}
+			}
+		}
+		return mismatches;
+	}
+
+	int CheckFill(int width, int height, int fills, Rng& rng)
+	{
+		Bitboard open(width, height);
+		Bitboard reached(width, height);
+		std::vector<uint8_t> cells(size_t(width) * height);
+		std::vector<int> expected;
+		int mismatches = 0;
+		for (int i = 0; i < fills; ++i)
+		{
+			open.Clear();
+			for (int y = 0; y < height; ++y)
+			{
+				for (int x = 0; x < width; ++x)
+				{
+					cells[y * width + x] = rng.Range(0, 99) < 60;
+					if (cells[y * width + x])
+					{
+						open.Set({ x,y });
+					}
+				}
+			}
+			const Location start = { rng.Range(0, width - 1),rng.Range(0, height - 1) };
+			cells[start.y * width + start.x] = 1;
+			reached.FloodFill(open, start, true);
+			QueueSearch(width, height, cells, start, expected);
+			for (int y = 0; y < height; ++y)
+			{
+				for (int x = 0; x < width; ++x)
+				{
+					mismatches += reached.Test({ x,y }) != (expected[y * width + x] >= 0);
+				}
+			}
+		}
+		return mismatches;
+	}
+
+	struct Totals
+	{
+		int games = 0;
+		int deaths = 0;
+		long long length = 0;
+		int offBoard = 0;
+	};
+
+	// PlayMatch, checking the head after every tick
+	void PlayChecked(Bot& bot, const Board& brd, uint64_t seed, int maxTicks, Totals& totals)
+	{
+		GameState state;
+		Simulation::Reset(state, brd, seed);
+		while (!state.GameOver && state.tick < maxTicks)
+		{
+			if (state.counter + 1 >= Simulation::Timer)
+			{
+				state.snake.Steer(ToDelta(bot.Decide(state, brd)));
+			}
+			Simulation::Tick(state, brd);
+			const Location head = state.snake.GetSegment(0);
+			totals.offBoard += head.x < 0 || head.y < 0 || head.x >= brd.GetWidth() || head.y >= brd.GetHeight();
+		}
+		++totals.games;
+		totals.length += state.snake.GetLength();
+		totals.deaths += state.GameOver && state.snake.GetLength() < brd.GetWidth() * brd.GetHeight();
+	}
+
+	int WrapWithBranch(int v, int size)
+	{
+		if (v < 0)
+		{
+			return v + size;
+		}
+		if (v >= size)
+		{
+			return v - size;
+		}
+		return v;
+	}
+
+	// a random walk round a size x size torus, the steps picked in advance
+	template<typename Wrap>
+	double TimeWalk(const std::vector<uint8_t>& steps, Wrap wrap, int& checksum)
+	{
+		Stopwatch time;
+		Location at = {};
+		int sum = 0;
+		for (const uint8_t s : steps)
+		{
+			at = wrap(at.Add(ToDelta(Direction(s))));
+			sum += at.x ^ at.y;
+		}
+		checksum = sum;
+		return time.GetSeconds();
+	}
+}
+
+int RunTorusTest(int argc, char* argv[])
+{
+	const int games = argc > 0 ? std::atoi(argv[0]) : 4;
+	const int maxTicks = argc > 1 ? std::atoi(argv[1]) : 40000;
+
+	Rng rng(7u);
+	int fieldErrors = 0;
+	int fillErrors = 0;
+	const Location sizes[] = { { 30,25 },{ 32,32 },{ 7,5 },{ 100,40 } };
+	for (const Location& s : sizes)
+	{
+		fieldErrors += CheckField(s.x, s.y, 300, rng);
+		fillErrors += CheckFill(s.x, s.y, 300, rng);
+	}
+	std::printf("distance field mismatches: %d\nflood fill mismatches: %d\n", fieldErrors, fillErrors);
+
+	Board bounded;
+	Board torus;
+	torus.SetWrap(true);
+	std::printf("%-12s %8s %12s %8s %12s %8s\n", "bot", "games", "bounded len", "deaths", "torus len", "deaths");
+	int offBoard = 0;
+	for (const std::string name : { "bfs","heuristic","hamiltonian","mcts" })
+	{
+		Totals totals[2];
+		for (int t = 0; t < 2; ++t)
+		{
+			const Board& brd = t == 0 ? bounded : torus;
+			for (int g = 0; g < games; ++g)
+			{
+				// a new bot per game, as the tournament does
+				const auto bot = CreateBot(name, brd);
+				PlayChecked(*bot, brd, g + 1u, maxTicks, totals[t]);
+			}
+			offBoard += totals[t].offBoard;
+		}
+		std::printf("%-12s %8d %12.1f %8d %12.1f %8d\n", name.c_str(), games,
+			double(totals[0].length) / games, totals[0].deaths, double(totals[1].length) / games, totals[1].deaths);
+	}
+	std::printf("heads off the board: %d\n", offBoard);
+
+	std::vector<uint8_t> steps(size_t(20) << 20);
+	for (uint8_t& s : steps)
+	{
+		s = uint8_t(rng.Range(0, DirectionCount - 1));
+	}
+	int sums[3];
+	const double branch = TimeWalk(steps, [](Location l) { return Location{ WrapWithBranch(l.x, 32),WrapWithBranch(l.y, 32) }; }, sums[0]);
+	const double branchless = TimeWalk(steps, [](Location l) { return WrapLocation(l, 32, 32); }, sums[1]);
+	const double mask = TimeWalk(steps, [](Location l) { return WrapLocation<32, 32>(l); }, sums[2]);
+	const double n = double(steps.size());
+	std::printf("wrapping a 32x32 walk, ns per step: branch %.2f, branchless %.2f, compile-time mask %.2f\n",
+		1e9 * branch / n, 1e9 * branchless / n, 1e9 * mask / n);
+
+	const bool ok = fieldErrors == 0 && fillErrors == 0 && offBoard == 0 && sums[0] == sums[1] && sums[1] == sums[2];
+	return ok ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+#include "Commands.h"
+#include "BotMatch.h"
+#include "Stopwatch.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Plays every bot on the same seeds, all games in parallel, and prints one
+// line per bot: length distribution, how the games ended, decision speed and
+// a paired win/loss count against the first bot. The table can also be saved.
+namespace
+{
+	constexpr int MaxTicks = 200000;
+
+	std::vector<std::string> SplitNames(const std::string& list)
+	{
+		std::vector<std::string> names;
+		std::stringstream in(list);
+		std::string name;
+		while (std::getline(in, name, ','))
+		{
+			if (!name.empty())
+			{
+				names.push_back(name);
+			}
+		}
+		return names;
+	}
+
+	int Percentile(std::vector<int> sorted, int percent)
+	{
+		return sorted[(sorted.size() - 1) * percent / 100];
+	}
+}
+
+int RunTournament(int argc, char* argv[])
+{
+	const std::vector<std::string> names = SplitNames(argc > 0 ? argv[0] : "bfs,heuristic,mcts");
+	const int games = argc > 1 ? std::atoi(argv[1]) : 100;
+	ThreadPool pool(argc > 2 ? std::atoi(argv[2]) : 0);
+	const char* outFile = argc > 3 ? argv[3] : nullptr;
+	const Board brd;
+	if (names.empty() || games < 1)
+	{
+		throw std::runtime_error("Need at least one bot and one game");
+	}
+	// fail on a bad name before starting anything
+	for (const std::string& name : names)
+	{
+		CreateBot(name, brd);
+	}
+
+	// game g of every bot uses seed g + 1, so results pair up by seed
+	const int bots = int(names.size());
+	std::vector<MatchResult> results(size_t(bots) * games);
+	Stopwatch time;
+	pool.ParallelFor(int(results.size()), [&](int index)
+	{
+		const int bot = index % bots;
+		const int game = index / bots;
+		std::unique_ptr<Bot> player = CreateBot(names[bot], brd);
+		results[size_t(bot) * games + game] = PlayMatch(*player, brd, uint64_t(game) + 1u, MaxTicks);
+	});
+	const double seconds = time.GetSeconds();
+
+	std::ostringstream table;
+	char line[256];
+	std::snprintf(line, sizeof(line), "%-12s %6s %8s %6s %6s %6s %6s %6s %6s %6s %7s %12s  vs %s\n",
+		"bot", "games", "mean", "p10", "p50", "p90", "max", "wall", "self", "full", "timeout", "decisions/s",
+		names[0].c_str());
+	table << line;
+	for (int b = 0; b < bots; ++b)
+	{
+		const MatchResult* first = &results[size_t(b) * games];
+		std::vector<int> lengths(games);
+		int ends[4] = {};
+		long long decisions = 0;
+		double decideSeconds = 0.0;
+		double total = 0.0;
+		int wins = 0;
+		int losses = 0;
+		for (int g = 0; g < games; ++g)
+		{
+			lengths[g] = first[g].length;
+			total += first[g].length;
+			++ends[int(first[g].end)];
+			decisions += first[g].decisions;
+			decideSeconds += first[g].decideSeconds;
+			const int reference = results[g].length;
+			wins += first[g].length > reference;
+			losses += first[g].length < reference;
+		}
+		std::sort(lengths.begin(), lengths.end());
+		std::snprintf(line, sizeof(line), "%-12s %6d %8.1f %6d %6d %6d %6d %6d %6d %6d %7d %12.0f  %d-%d-%d\n",
+			names[b].c_str(), games, total / games, Percentile(lengths, 10), Percentile(lengths, 50),
+			Percentile(lengths, 90), lengths.back(), ends[int(MatchEnd::Wall)], ends[int(MatchEnd::Self)],
+			ends[int(MatchEnd::BoardFull)], ends[int(MatchEnd::Timeout)], decisions / std::max(decideSeconds, 1e-9),
+			wins, losses, games - wins - losses);
+		table << line;
+	}
+
+	std::printf("%d games per bot on %d threads in %.1f s\n%s", games, pool.GetThreadCount(), seconds,
+		table.str().c_str());
+	if (outFile)
+	{
+		FILE* out = std::fopen(outFile, "w");
+		if (!out)
+		{
+			throw std::runtime_error(std::string("Could not open results file for writing: ") + outFile);
+		}
+		std::fputs(table.str().c_str(), out);
+		std::fclose(out);
+	}
+	return 0;
+}
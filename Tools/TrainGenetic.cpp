@@ -0,0 +1,39 @@
+#include "Commands.h"
+#include "GeneticTrainer.h"
+#include "Stopwatch.h"
+#include <cstdio>
+#include <cstdlib>
+
+// Evolves heuristic bot weights and prints the progress of every generation,
+// then the best weights found.
+int RunTrainGenetic(int argc, char* argv[])
+{
+	GeneticSettings settings;
+	const int generations = argc > 0 ? std::atoi(argv[0]) : 10;
+	settings.population = argc > 1 ? std::atoi(argv[1]) : settings.population;
+	settings.gamesPerCandidate = argc > 2 ? std::atoi(argv[2]) : settings.gamesPerCandidate;
+	settings.threads = argc > 3 ? std::atoi(argv[3]) : settings.threads;
+	settings.seed = argc > 4 ? std::strtoull(argv[4], nullptr, 10) : settings.seed;
+	const Board brd;
+	GeneticTrainer trainer(brd, settings);
+
+	std::printf("%d candidates x %d games, %d threads\n", settings.population, settings.gamesPerCandidate,
+		trainer.GetThreadCount());
+	std::printf("%-5s %8s %8s %8s %8s %12s\n", "gen", "best", "mean", "deaths", "seconds", "ticks/s");
+	GeneticTrainer::Generation last;
+	for (int g = 0; g < generations; ++g)
+	{
+		Stopwatch time;
+		last = trainer.Step();
+		const double seconds = time.GetSeconds();
+		std::printf("%-5d %8.2f %8.2f %8d %8.2f %12.0f\n", last.index, last.bestFitness, last.meanFitness, last.deaths,
+			seconds, last.ticks / seconds);
+	}
+
+	std::printf("\nbest weights of the last generation:\n");
+	for (int f = 0; f < HeuristicBot::FeatureCount; ++f)
+	{
+		std::printf("  %-16s %8.3f\n", HeuristicBot::GetFeatureName(f), last.best[f]);
+	}
+	return 0;
+}